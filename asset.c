@@ -0,0 +1,359 @@
+#include "asset.h"
+#include "log.h"
+#include <SDL2/SDL_image.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Le paquet de ressources est lu tel quel : machine petit-boutiste requise"
+#endif
+
+_Static_assert(sizeof(AssetPackHeader) == 16, "AssetPackHeader doit rester de taille fixe");
+_Static_assert(sizeof(AssetPackEntry) == 96, "AssetPackEntry doit rester de taille fixe");
+
+#define MAX_IMAGE_SIDE 16384
+
+typedef enum {
+    KIND_SPRITE,                // pixels pour l'atlas
+    KIND_TEXTURE,               // pixels puis texture propre
+    KIND_FILE,                  // fichier projeté tel quel
+} AssetKind;
+
+typedef struct {
+    const char* path;
+    AssetKind kind;
+} AssetDef;
+
+static const AssetDef assetDefs[ASSET_COUNT] = {
+    [ASSET_WALL]            = { "assets/wall.png",                  KIND_SPRITE },
+    [ASSET_GROUND]          = { "assets/ground.png",                KIND_SPRITE },
+    [ASSET_DOOR]            = { "assets/door.png",                  KIND_SPRITE },
+    [ASSET_BOX]             = { "assets/box.png",                   KIND_SPRITE },
+    [ASSET_SWITCH_OFF]      = { "assets/switchOff.png",             KIND_SPRITE },
+    [ASSET_SWITCH_ON]       = { "assets/switchOn.png",              KIND_SPRITE },
+    [ASSET_PLAYER]          = { "assets/player_without_sword.png",  KIND_SPRITE },
+    [ASSET_MENU_BACKGROUND] = { "assets/menu_background.png",       KIND_TEXTURE },
+    [ASSET_CURSOR]          = { "assets/cursor.png",                KIND_TEXTURE },
+    [ASSET_FONT]            = { "assets/font.ttf",                  KIND_FILE },
+};
+
+typedef struct {
+    AssetImage image;
+    uint8_t* decoded;           // pixels décodés cette fois-ci (sinon dans le paquet)
+    const void* fileData;       // KIND_FILE : projection du fichier
+    size_t fileSize;
+    bool sourceFound;
+    int64_t sourceTime;
+    uint64_t sourceSize;
+    SDL_Texture* texture;
+} AssetSlot;
+
+static AssetSlot slots[ASSET_COUNT];
+
+static const uint8_t* pack = NULL;
+static size_t packSize = 0;
+
+// Ressources à lire, partagées entre les threads par un compteur
+static int work[ASSET_COUNT];
+static int workCount = 0;
+static atomic_int nextWork = 0;
+static pthread_t threads[ASSET_MAX_THREADS];
+static int threadCount = 0;
+
+
+static const uint8_t* mapFile(const char* path, size_t* size, bool populate) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // MAP_POPULATE : la lecture se fait ici, sur le thread de chargement
+    const uint8_t* data = mmap(NULL, (size_t)info.st_size, PROT_READ,
+                               MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    *size = (size_t)info.st_size;
+    return data;
+}
+
+static void mapPack(void) {
+    pack = mapFile(ASSET_PACK_PATH, &packSize, false);
+    if (!pack) return;
+
+    const AssetPackHeader* header = (const AssetPackHeader*)pack;
+    bool valid = packSize >= sizeof(AssetPackHeader) &&
+                 memcmp(header->magic, ASSET_PACK_MAGIC, 4) == 0 &&
+                 header->version == ASSET_PACK_VERSION &&
+                 header->headerSize == sizeof(AssetPackHeader) &&
+                 header->fileSize == packSize &&
+                 (uint64_t)header->entryCount * sizeof(AssetPackEntry) <= packSize - sizeof(AssetPackHeader);
+
+    const AssetPackEntry* entries = (const AssetPackEntry*)(header + 1);
+    for (uint32_t i = 0; valid && i < header->entryCount; i++) {
+        const AssetPackEntry* e = &entries[i];
+        valid = memchr(e->path, 0, sizeof(e->path)) != NULL &&
+                e->width > 0 && e->width <= MAX_IMAGE_SIDE &&
+                e->height > 0 && e->height <= MAX_IMAGE_SIDE &&
+                e->offset <= packSize &&
+                (uint64_t)e->width * e->height * 4 <= packSize - e->offset;
+    }
+
+    if (!valid) {
+        LOG_WARN(LOG_ASSET, "Paquet de ressources invalide, il sera reconstruit : %s", ASSET_PACK_PATH);
+        munmap((void*)pack, packSize);
+        pack = NULL;
+        packSize = 0;
+    }
+}
+
+static const AssetPackEntry* findPackEntry(const char* path) {
+    if (!pack) return NULL;
+
+    const AssetPackHeader* header = (const AssetPackHeader*)pack;
+    const AssetPackEntry* entries = (const AssetPackEntry*)(header + 1);
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        if (strcmp(entries[i].path, path) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+static void decodeImage(AssetId id) {
+    AssetSlot* slot = &slots[id];
+    const char* path = assetDefs[id].path;
+
+    SDL_Surface* loaded = IMG_Load(path);
+    if (!loaded) {
+        LOG_WARN(LOG_ASSET, "Erreur chargement %s : %s", path, IMG_GetError());
+        return;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!rgba) {
+        LOG_WARN(LOG_ASSET, "Erreur conversion %s : %s", path, SDL_GetError());
+        return;
+    }
+
+    // Lignes jointives, comme dans le paquet
+    size_t rowBytes = (size_t)rgba->w * 4;
+    uint8_t* pixels = malloc(rowBytes * rgba->h);
+    if (pixels) {
+        for (int y = 0; y < rgba->h; y++) {
+            memcpy(pixels + y * rowBytes, (const uint8_t*)rgba->pixels + y * rgba->pitch, rowBytes);
+        }
+        slot->decoded = pixels;
+        slot->image = (AssetImage){ rgba->w, rgba->h, pixels };
+    } else {
+        LOG_ERROR(LOG_SYSTEM, "Mémoire insuffisante pour %s", path);
+    }
+    SDL_FreeSurface(rgba);
+}
+
+static void loadAsset(AssetId id) {
+    if (assetDefs[id].kind == KIND_FILE) {
+        slots[id].fileData = mapFile(assetDefs[id].path, &slots[id].fileSize, true);
+        if (!slots[id].fileData) LOG_WARN(LOG_ASSET, "Erreur chargement %s", assetDefs[id].path);
+    } else {
+        decodeImage(id);
+    }
+}
+
+static void runWork(void) {
+    for (;;) {
+        int index = atomic_fetch_add(&nextWork, 1);
+        if (index >= workCount) return;
+        loadAsset((AssetId)work[index]);
+    }
+}
+
+static void* assetWorker(void* arg) {
+    (void)arg;
+    runWork();
+    return NULL;
+}
+
+bool assetLoadStart(void) {
+    // Les bibliothèques de décodage sont chargées ici, avant les threads
+    IMG_Init(IMG_INIT_PNG);
+    mapPack();
+
+    workCount = 0;
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        AssetSlot* slot = &slots[id];
+        const char* path = assetDefs[id].path;
+
+        struct stat info;
+        slot->sourceFound = stat(path, &info) == 0;
+        slot->sourceTime = slot->sourceFound ? (int64_t)info.st_mtime : 0;
+        slot->sourceSize = slot->sourceFound ? (uint64_t)info.st_size : 0;
+
+        // Image à jour dans le paquet (ou seule livrée) : aucun décodage
+        const AssetPackEntry* entry = assetDefs[id].kind == KIND_FILE ? NULL : findPackEntry(path);
+        if (entry && (!slot->sourceFound ||
+                      (entry->sourceTime == slot->sourceTime && entry->sourceSize == slot->sourceSize))) {
+            slot->image = (AssetImage){ (int)entry->width, (int)entry->height, pack + entry->offset };
+            continue;
+        }
+
+        if (!slot->sourceFound) {
+            LOG_WARN(LOG_ASSET, "Ressource introuvable : %s", path);
+            continue;
+        }
+        work[workCount++] = id;
+    }
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int wanted = workCount < ASSET_MAX_THREADS ? workCount : ASSET_MAX_THREADS;
+    if (cores > 0 && wanted > cores) wanted = (int)cores;
+
+    atomic_store(&nextWork, 0);
+    threadCount = 0;
+    while (threadCount < wanted) {
+        if (pthread_create(&threads[threadCount], NULL, assetWorker, NULL) != 0) break;
+        threadCount++;
+    }
+    return threadCount > 0 || workCount == 0;
+}
+
+static uint32_t align16(uint32_t offset) {
+    return (offset + 15u) & ~15u;
+}
+
+// Paquet complet réécrit à côté puis renommé : la projection en cours reste valide
+static bool writePack(void) {
+    AssetPackHeader header;
+    AssetPackEntry entries[ASSET_COUNT];
+    memset(&header, 0, sizeof(header));
+    memset(entries, 0, sizeof(entries));
+
+    uint32_t count = 0;
+    uint32_t end = sizeof(header) + sizeof(entries);     // fin du dernier bloc écrit
+    uint32_t offset = align16(end);
+    int ids[ASSET_COUNT];
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        const AssetSlot* slot = &slots[id];
+        if (!slot->image.pixels || strlen(assetDefs[id].path) >= sizeof(entries[0].path)) continue;
+
+        AssetPackEntry* e = &entries[count];
+        strcpy(e->path, assetDefs[id].path);
+        e->sourceTime = slot->sourceTime;
+        e->sourceSize = slot->sourceSize;
+        e->width = (uint32_t)slot->image.width;
+        e->height = (uint32_t)slot->image.height;
+        e->offset = offset;
+        end = offset + e->width * e->height * 4;
+        offset = align16(end);
+        ids[count++] = id;
+    }
+
+    memcpy(header.magic, ASSET_PACK_MAGIC, 4);
+    header.version = ASSET_PACK_VERSION;
+    header.headerSize = sizeof(header);
+    header.entryCount = count;
+    header.fileSize = end;
+
+    char tmpPath[sizeof(ASSET_PACK_PATH) + 4];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", ASSET_PACK_PATH);
+    FILE* file = fopen(tmpPath, "wb");
+    if (!file) {
+        LOG_WARN(LOG_ASSET, "Impossible d'écrire %s", tmpPath);
+        return false;
+    }
+
+    // Les fseek laissent des zéros : entrées inutilisées et alignements
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(entries, sizeof(entries), 1, file) == 1;
+    for (uint32_t i = 0; i < count && ok; i++) {
+        const AssetImage* image = &slots[ids[i]].image;
+        ok = fseek(file, entries[i].offset, SEEK_SET) == 0 &&
+             fwrite(image->pixels, (size_t)image->width * image->height * 4, 1, file) == 1;
+    }
+    if (fclose(file) != 0) ok = false;
+
+    if (!ok || rename(tmpPath, ASSET_PACK_PATH) != 0) {
+        LOG_WARN(LOG_ASSET, "Erreur d'écriture %s", ASSET_PACK_PATH);
+        remove(tmpPath);
+        return false;
+    }
+    LOG_INFO(LOG_ASSET, "Paquet de ressources reconstruit : %u images, %u octets", count, header.fileSize);
+    return true;
+}
+
+void assetLoadWait(void) {
+    // L'appelant aide, puis attend les lectures en cours
+    runWork();
+    for (int i = 0; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    threadCount = 0;
+
+    bool decoded = false;
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        if (slots[id].decoded) decoded = true;
+    }
+    if (decoded) writePack();
+}
+
+const AssetImage* assetImage(AssetId id) {
+    return &slots[id].image;
+}
+
+const void* assetFileData(AssetId id, size_t* size) {
+    *size = slots[id].fileSize;
+    return slots[id].fileData;
+}
+
+void assetCreateTextures(SDL_Renderer* renderer) {
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        const AssetImage* image = &slots[id].image;
+        if (assetDefs[id].kind != KIND_TEXTURE || !image->pixels) continue;
+
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)image->pixels, image->width, image->height,
+                                                                  32, image->width * 4, SDL_PIXELFORMAT_RGBA32);
+        if (surface) {
+            slots[id].texture = SDL_CreateTextureFromSurface(renderer, surface);
+            SDL_FreeSurface(surface);
+        }
+        if (!slots[id].texture) {
+            LOG_WARN(LOG_ASSET, "Erreur création texture %s : %s", assetDefs[id].path, SDL_GetError());
+        }
+    }
+}
+
+SDL_Texture* assetTexture(AssetId id) {
+    return slots[id].texture;
+}
+
+void assetReleasePixels(void) {
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        free(slots[id].decoded);
+        slots[id].decoded = NULL;
+        slots[id].image = (AssetImage){ 0, 0, NULL };
+    }
+    if (pack) munmap((void*)pack, packSize);
+    pack = NULL;
+    packSize = 0;
+}
+
+void assetShutdown(void) {
+    assetReleasePixels();
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        if (slots[id].texture) SDL_DestroyTexture(slots[id].texture);
+        if (slots[id].fileData) munmap((void*)slots[id].fileData, slots[id].fileSize);
+        slots[id].texture = NULL;
+        slots[id].fileData = NULL;
+        slots[id].fileSize = 0;
+    }
+    IMG_Quit();
+}
@@ -0,0 +1,86 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Ressources du jeu, décrites par une table (asset.c) plutôt que chargées
+// une à une dans main.
+//
+// assetLoadStart lance le décodage sur plusieurs threads et rend la main
+// tout de suite : la fenêtre et le rendu se créent pendant ce temps. Les
+// pixels RGBA décodés sont rangés dans un paquet (ASSET_PACK_PATH) projeté
+// en mémoire au lancement suivant ; une image n'est redécodée que si son
+// fichier source a changé (date ou taille), et le paquet est alors réécrit.
+// Les envois au GPU se font ensuite en un seul lot (assetCreateTextures,
+// spriteAtlasBuild), sur le thread du rendu.
+//
+//   AssetPackHeader
+//   AssetPackEntry × entryCount
+//   pixels RGBA32 de chaque image (lignes de width * 4 octets), alignés sur 16
+
+#define ASSET_PACK_PATH "assets/assets.czp"
+#define ASSET_PACK_MAGIC "CZAP"
+#define ASSET_PACK_VERSION 1
+#define ASSET_MAX_THREADS 8
+
+typedef enum {
+    // Sprites regroupés dans l'atlas (sprite.h)
+    ASSET_WALL,
+    ASSET_GROUND,
+    ASSET_DOOR,
+    ASSET_BOX,
+    ASSET_SWITCH_OFF,
+    ASSET_SWITCH_ON,
+    ASSET_PLAYER,
+    // Images affichées seules, avec leur propre texture
+    ASSET_MENU_BACKGROUND,
+    ASSET_CURSOR,
+    // Fichiers gardés tels quels en mémoire
+    ASSET_FONT,
+    ASSET_COUNT
+} AssetId;
+
+typedef struct {
+    int width, height;
+    const uint8_t* pixels;      // RGBA32, lignes de width * 4 octets ; NULL si absente
+} AssetImage;
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t entryCount;
+    uint32_t fileSize;
+} AssetPackHeader;
+
+typedef struct {
+    char path[64];              // fichier source
+    int64_t sourceTime;         // date de modification de la source
+    uint64_t sourceSize;
+    uint32_t width, height;
+    uint32_t offset;            // pixels, depuis le début du paquet
+    uint32_t reserved;
+} AssetPackEntry;
+
+// Lance le chargement en arrière-plan ; false si aucun thread n'a pu être créé
+// (tout est alors chargé par assetLoadWait)
+bool assetLoadStart(void);
+// Attend la fin du chargement et réécrit le paquet si des images ont été décodées
+void assetLoadWait(void);
+
+// Valides entre assetLoadWait et assetReleasePixels
+const AssetImage* assetImage(AssetId id);
+// Fichier brut (police) ; valide jusqu'à assetShutdown. NULL si absent.
+const void* assetFileData(AssetId id, size_t* size);
+
+// Crée d'un coup les textures des images affichées seules
+void assetCreateTextures(SDL_Renderer* renderer);
+SDL_Texture* assetTexture(AssetId id);
+// Libère les pixels décodés et la projection du paquet, une fois envoyés au GPU
+void assetReleasePixels(void);
+void assetShutdown(void);
+
+#endif
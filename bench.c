@@ -0,0 +1,787 @@
+// Benchmarks de la logique du jeu, sans fenêtre ni SDL.
+// Usage : ./SDLCommandoZombiBench [--filter=texte] [--repeat=N] [--min-time=ms] [--csv] [--threads=N]
+//         ./SDLCommandoZombiBench --replay=partie.czi [--repeat=N] [--threads=N]
+// À lancer depuis la racine du dépôt (chemins world/...).
+
+#include "game.h"
+#include "collide.h"
+#include "flow.h"
+#include "fov.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include "prefetch.h"
+#include "puzzle.h"
+#include "roomcache.h"
+#include "world.h"
+#include "replay.h"
+#include "savestate.h"
+#include "roomfile.h"
+#include "roomgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define POSITION_COUNT 4096
+#define TICK_SCRIPT_LENGTH 30    // ticks par direction dans le scénario de simulation
+#define LARGE_WORLD_SIDE 100      // monde généré de 100 × 100 salles
+#define DENSE_WIDTH 25            // salle dense : un écran
+#define DENSE_HEIGHT 18
+#define LARGE_MAP_SIDE 4096       // grande salle extérieure, en tuiles
+#define HORDE_SIZE 4096           // zombies lancés sur le joueur
+#define LARGE_HORDE_SIZE 65536
+#define ENTITY_CHURN 1024         // entités vivantes pendant entity/add-remove
+#define GENERATED_SIDE 1024       // salle générée (roomgen.h), en tuiles
+#define GENERATED_ENEMIES 65536
+#define PUZZLE_SEED 82u            // salle ouverte de 15 × 11, 14 poussées, ~46000 états
+
+static const char* filter = NULL;
+static int repeatCount = 7;
+static double minTime = 0.05;    // durée minimale d'une mesure, en secondes
+static bool csvOutput = false;
+static int threadCount = 0;      // threads de calcul (0 : un par cœur)
+static const char* replayPath = NULL;
+
+static volatile uint64_t sink;   // empêche le compilateur d'éliminer le travail mesuré
+
+static int positions[POSITION_COUNT][2];
+static int positionXs[POSITION_COUNT];     // mêmes positions en colonnes (collide.h)
+static int positionYs[POSITION_COUNT];
+static char denseRoomPath[64];
+static char denseBinaryPath[64];
+static char mapBinaryPath[64];
+static char largeWorldPath[sizeof(denseRoomPath) + sizeof(".manifest")];
+static char largeMapPath[sizeof(denseRoomPath) + sizeof(".large.czr")];
+static Player benchPlayer;
+static Room benchRoom;
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Générateur déterministe : mêmes cartes et mêmes requêtes à chaque exécution
+static uint32_t rngState = 12345u;
+static uint32_t nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// Mesure op(n) : calibrage, échauffement, puis repeatCount mesures
+static void runBench(const char* name, void (*setup)(void), void (*op)(uint64_t)) {
+    if (filter && !strstr(name, filter)) return;
+
+    if (setup) setup();
+
+    uint64_t n = 1;
+    for (;;) {
+        double start = now();
+        op(n);
+        double elapsed = now() - start;
+        if (elapsed >= minTime || n >= (1ull << 40)) break;
+        n *= 2;
+    }
+
+    // Échauffement : caches et prédicteurs dans l'état du régime établi
+    op(n);
+
+    double samples[64];
+    int count = repeatCount < 64 ? repeatCount : 64;
+    for (int r = 0; r < count; r++) {
+        if (setup) setup();
+        double start = now();
+        op(n);
+        samples[r] = (now() - start) * 1e9 / (double)n;
+    }
+    qsort(samples, count, sizeof(double), compareDouble);
+
+    double median = samples[count / 2];
+    if (csvOutput) {
+        printf("%s,%.2f,%.2f,%.2f,%.0f\n", name, median, samples[0], samples[count - 1], 1e9 / median);
+    } else {
+        printf("%-34s %12.1f ns/op %14.0f op/s   (min %.1f, max %.1f, %llu x %d)\n",
+               name, median, 1e9 / median, samples[0], samples[count - 1],
+               (unsigned long long)n, count);
+    }
+}
+
+
+static void resetRoomState(void) {
+    entityClear(&enemies);
+    entityClear(&keys);
+    entityClear(&doors);
+    entityClear(&boxes);
+    entityClear(&switches);
+    keysCollected = 0;
+}
+
+static void loadRoom(const char* filename) {
+    resetRoomState();
+    if (!readRoomText(filename, &benchRoom)) {
+        fprintf(stderr, "Impossible de charger %s\n", filename);
+        exit(1);
+    }
+    applyRoom(&benchRoom);
+}
+
+// Salle générée : murs aléatoires, entités au maximum des capacités
+static bool writeDenseRoom(const char* path, uint32_t seed) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    char grid[DENSE_HEIGHT][DENSE_WIDTH];
+    rngState = seed;
+    for (int y = 0; y < DENSE_HEIGHT; y++) {
+        for (int x = 0; x < DENSE_WIDTH; x++) {
+            bool border = x == 0 || y == 0 || x == DENSE_WIDTH - 1 || y == DENSE_HEIGHT - 1;
+            grid[y][x] = border || nextRandom() % 100 < 15 ? '#' : '.';
+        }
+    }
+
+    const char glyphs[] = { 'C', 'S', 'K', 'E', 'D' };
+    const int counts[] = { 10, 10, 16, 16, 4 };
+    for (int g = 0; g < 5; g++) {
+        for (int i = 0; i < counts[g]; i++) {
+            int x = 1 + nextRandom() % (DENSE_WIDTH - 2);
+            int y = 1 + nextRandom() % (DENSE_HEIGHT - 2);
+            if (grid[y][x] == '.') grid[y][x] = glyphs[g];
+        }
+    }
+    grid[DENSE_HEIGHT / 2][DENSE_WIDTH / 2] = 'P';
+
+    for (int y = 0; y < DENSE_HEIGHT; y++) {
+        fwrite(grid[y], 1, DENSE_WIDTH, file);
+        fputc('\n', file);
+    }
+    // Mécanismes : une porte ET, une porte OU
+    fputs("@link and 0 1 > 0 1\n@link or 2 3 4 > 2\n", file);
+    fclose(file);
+    return true;
+}
+
+
+static void setupCollisionPositions(void) {
+    rngState = 777u;
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        positions[i][0] = nextRandom() % ((tileMap.width - 1) * TILE_SIZE);
+        positions[i][1] = nextRandom() % ((tileMap.height - 1) * TILE_SIZE);
+        positionXs[i] = positions[i][0];
+        positionYs[i] = positions[i][1];
+    }
+}
+
+static void setupCollision(void) {
+    loadRoom("world/map_1_1.txt");
+    setupCollisionPositions();
+}
+
+static void opIsCollision(uint64_t n) {
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        const int* p = positions[i & (POSITION_COUNT - 1)];
+        hits += isCollision(p[0], p[1], TILE_SIZE);
+    }
+    sink = hits;
+}
+
+// Les mêmes requêtes par lots de 256 (collideTiles), coût ramené à une requête
+static void opCollideTiles(uint64_t n) {
+    uint32_t mask[COLLIDE_MASK_WORDS(256)];
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < n; i += 256) {
+        int begin = (int)(i & (POSITION_COUNT - 1));
+        hits += collideTiles(positionXs + begin, positionYs + begin, 256, TILE_SIZE, mask);
+    }
+    sink = hits;
+}
+
+// Même requête dans une salle de LARGE_MAP_SIDE² tuiles : le coût ne dépend
+// pas de la taille de la grille
+static void setupCollisionLarge(void) {
+    if (!readRoomBinary(largeMapPath, &benchRoom)) exit(1);
+    applyRoom(&benchRoom);
+    setupCollisionPositions();
+}
+
+static void opCheckCollisionBoxes(uint64_t n) {
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        const int* p = positions[i & (POSITION_COUNT - 1)];
+        for (int b = 0; b < boxes.count; b++) {
+            hits += checkCollision(p[0], p[1], TILE_SIZE, TILE_SIZE, boxes.x[b], boxes.y[b], TILE_SIZE, TILE_SIZE);
+        }
+    }
+    sink = hits;
+}
+
+// Caisse seule au milieu de la salle dense, poussée vers la droite
+static void setupPush(void) {
+    loadRoom(denseRoomPath);
+    int y = DENSE_HEIGHT / 2;
+    for (int x = 1; x < DENSE_WIDTH - 1; x++) setTile(x, y, 0);
+    for (int i = 0; i < boxes.count; i++) {
+        if (boxes.y[i] / TILE_SIZE == y) boxes.flags[i] &= ~ENTITY_ACTIVE;
+    }
+    for (int i = 0; i < doors.count; i++) {
+        if (doors.y[i] / TILE_SIZE == y) doors.flags[i] |= ENTITY_OPEN;
+    }
+    boxes.x[0] = boxes.prevX[0] = 3 * TILE_SIZE;
+    boxes.y[0] = boxes.prevY[0] = y * TILE_SIZE;
+    boxes.flags[0] |= ENTITY_ACTIVE;
+    occupancyRebuild();
+    benchPlayer = (Player){ .x = 2 * TILE_SIZE, .y = y * TILE_SIZE, .dir = DIR_RIGHT };
+}
+
+static void opPush(uint64_t n) {
+    int y = DENSE_HEIGHT / 2 * TILE_SIZE;
+    for (uint64_t i = 0; i < n; i++) {
+        // Remise en place avant le mur du fond
+        if (boxes.x[0] >= (DENSE_WIDTH - 3) * TILE_SIZE) {
+            occupancyMove(OCC_BOX, 0, boxes.x[0], y, 3 * TILE_SIZE, y);
+            boxes.x[0] = 3 * TILE_SIZE;
+            benchPlayer.x = 2 * TILE_SIZE;
+            benchPlayer.y = y;
+        }
+        movePlayer(&benchPlayer, PLAYER_SPEED, 0);
+    }
+    sink = (uint64_t)boxes.x[0];
+}
+
+static void opLoadMap11(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) loadRoom("world/map_1_1.txt");
+    sink = boxes.count;
+}
+
+static void opLoadMap12(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) loadRoom("world/map_1_2.txt");
+    sink = boxes.count;
+}
+
+static void opLoadDense(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) loadRoom(denseRoomPath);
+    sink = boxes.count;
+}
+
+static void opLoadBinaryMap11(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        resetRoomState();
+        if (readRoomBinary(mapBinaryPath, &benchRoom)) applyRoom(&benchRoom);
+    }
+    sink = boxes.count;
+}
+
+static void opLoadBinaryDense(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        resetRoomState();
+        if (readRoomBinary(denseBinaryPath, &benchRoom)) applyRoom(&benchRoom);
+    }
+    sink = boxes.count;
+}
+
+static void opLoadBinaryLarge(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        resetRoomState();
+        if (readRoomBinary(largeMapPath, &benchRoom)) applyRoom(&benchRoom);
+    }
+    sink = tileMapBytes(&tileMap);
+}
+
+// Grande salle extérieure : bordure de murs et quelques bâtiments, le
+// reste au sol (la plupart des tronçons sont partagés)
+static bool writeLargeMap(const char* path) {
+    roomFree(&benchRoom);
+    if (!tileMapInit(&benchRoom.tiles, LARGE_MAP_SIDE, LARGE_MAP_SIDE)) return false;
+    benchRoom.playerStartX = benchRoom.playerStartY = LARGE_MAP_SIDE / 2;
+
+    TileMap* tiles = &benchRoom.tiles;
+    for (int i = 0; i < LARGE_MAP_SIDE; i++) {
+        tileMapSet(tiles, i, 0, TILE_WALL);
+        tileMapSet(tiles, i, LARGE_MAP_SIDE - 1, TILE_WALL);
+        tileMapSet(tiles, 0, i, TILE_WALL);
+        tileMapSet(tiles, LARGE_MAP_SIDE - 1, i, TILE_WALL);
+    }
+
+    rngState = 99u;
+    for (int b = 0; b < 256; b++) {
+        int x0 = nextRandom() % (LARGE_MAP_SIDE - 64), y0 = nextRandom() % (LARGE_MAP_SIDE - 64);
+        int w = 8 + nextRandom() % 32, h = 8 + nextRandom() % 32;
+        for (int x = x0; x < x0 + w; x++) {
+            tileMapSet(tiles, x, y0, TILE_WALL);
+            tileMapSet(tiles, x, y0 + h - 1, TILE_WALL);
+        }
+        for (int y = y0; y < y0 + h; y++) {
+            tileMapSet(tiles, x0, y, TILE_WALL);
+            tileMapSet(tiles, x0 + w - 1, y, TILE_WALL);
+        }
+    }
+    return writeRoomBinary(path, &benchRoom);
+}
+
+// Version compilée d'une salle texte, dans un fichier temporaire
+static bool compileTemporary(const char* textPath, char* binaryPath) {
+    snprintf(binaryPath, 64, "/tmp/czbench_room_XXXXXX");
+    int fd = mkstemp(binaryPath);
+    if (fd < 0) return false;
+    close(fd);
+
+    return readRoomText(textPath, &benchRoom) && writeRoomBinary(binaryPath, &benchRoom);
+}
+
+// Aller-retour entre deux salles voisines, avec ou sans préchargement
+static void setupTransitionSync(void) {
+    prefetchStop();
+    roomCacheSetBudget(0);
+    loadMapFromWorld(1, 1);
+}
+
+static void setupTransitionPrefetched(void) {
+    prefetchStart();
+    roomCacheSetBudget(0);
+    loadMapFromWorld(1, 1);
+    // Attend que la salle voisine soit prête avant de mesurer
+    prefetchRelease(prefetchAcquire(2, 1));
+}
+
+// Salles déjà visitées : état restauré depuis le cache
+static void setupTransitionCached(void) {
+    prefetchStop();
+    roomCacheSetBudget(ROOM_CACHE_DEFAULT_BUDGET);
+    loadMapFromWorld(1, 1);
+    loadMapFromWorld(2, 1);
+}
+
+static void opTransition(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        loadMapFromWorld(currentMapX == 1 ? 2 : 1, 1);
+    }
+    sink = boxes.count;
+}
+
+// Scénario fixe : le joueur parcourt la salle dans les quatre directions
+static void runTicks(uint64_t n) {
+    static const unsigned script[] = { INPUT_RIGHT, INPUT_DOWN, INPUT_LEFT, INPUT_UP, INPUT_RIGHT | INPUT_ACTIVATE };
+    for (uint64_t i = 0; i < n; i++) {
+        unsigned input = script[(i / TICK_SCRIPT_LENGTH) % 5];
+        if (i % TICK_SCRIPT_LENGTH != 0) input &= ~INPUT_ACTIVATE;
+        gameTick(&benchPlayer, input);
+    }
+    sink = (uint64_t)benchPlayer.x;
+}
+
+static void setupTickWorld(void) {
+    resetRoomState();
+    if (!gameStart(&benchPlayer)) exit(1);
+}
+
+// Manifeste de LARGE_WORLD_SIDE² salles, toutes vers la salle dense
+static bool writeLargeWorld(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    const char* room = strrchr(denseRoomPath, '/') + 1;
+    for (int y = 0; y < LARGE_WORLD_SIDE; y++) {
+        for (int x = 0; x < LARGE_WORLD_SIDE; x++) {
+            fprintf(file, "%d %d %s\n", x, y, room);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+static void opLoadLargeWorld(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) worldLoad(largeWorldPath);
+    sink = worldRoomCount();
+}
+
+static void setupFindLargeWorld(void) {
+    worldLoad(largeWorldPath);
+    rngState = 4242u;
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        // Un quart des requêtes tombe hors du monde
+        positions[i][0] = nextRandom() % (LARGE_WORLD_SIDE * 2) - LARGE_WORLD_SIDE / 2;
+        positions[i][1] = nextRandom() % LARGE_WORLD_SIDE;
+    }
+}
+
+static void opFindLargeWorld(uint64_t n) {
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        const int* p = positions[i & (POSITION_COUNT - 1)];
+        hits += worldFind(p[0], p[1]) != NULL;
+    }
+    sink = hits;
+}
+
+// Champ de flux complet depuis le joueur, à chaque appel
+static void setupFlowDense(void) {
+    loadRoom(denseRoomPath);
+    benchPlayer = (Player){ .x = playerStartX * TILE_SIZE, .y = playerStartY * TILE_SIZE, .dir = DIR_DOWN };
+}
+
+static void setupFlowLarge(void) {
+    resetRoomState();
+    if (!readRoomBinary(largeMapPath, &benchRoom)) exit(1);
+    applyRoom(&benchRoom);
+    benchPlayer = (Player){ .x = LARGE_MAP_SIDE / 2 * TILE_SIZE, .y = LARGE_MAP_SIDE / 2 * TILE_SIZE, .dir = DIR_DOWN };
+}
+
+static void opFlowRecompute(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) flowRecompute(&benchPlayer);
+    sink = flowDistance(1, 1);
+}
+
+// Le joueur fait des allers-retours entre deux tuiles voisines : la grille
+// de passage est gardée, seul le parcours est refait
+static int stepX = 0;
+
+static void setupFlowStep(void) {
+    setupFlowDense();
+    stepX = tileMapGet(&tileMap, playerStartX + 1, playerStartY) == TILE_GROUND ? TILE_SIZE : -TILE_SIZE;
+    flowRecompute(&benchPlayer);
+}
+
+static void setupFlowLargeStep(void) {
+    setupFlowLarge();
+    stepX = TILE_SIZE;
+    flowRecompute(&benchPlayer);
+}
+
+static void opFlowStep(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        benchPlayer.x += (i & 1) ? -stepX : stepX;
+        flowUpdate(&benchPlayer);
+    }
+    sink = flowDistance(1, 1);
+}
+
+// Horde de zombies répartis dans la salle dense, lancés vers le joueur
+static void spawnHorde(int size) {
+    setupFlowDense();
+    rngState = 99u;
+    entityClear(&enemies);
+    while (enemies.count < size) {
+        int x = nextRandom() % tileMap.width, y = nextRandom() % tileMap.height;
+        // Déjà lancés à la poursuite du joueur (fov.h)
+        if (tileMapGet(&tileMap, x, y) != TILE_WALL)
+            entityAdd(&enemies, x * TILE_SIZE, y * TILE_SIZE, ENTITY_ALERTED);
+    }
+    flowRecompute(&benchPlayer);
+}
+
+// Vue complète depuis le joueur, à chaque appel : le coût ne dépend que de
+// FOV_RADIUS, pas de la taille de la salle
+static void opFovRecompute(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) fovRecompute(&benchPlayer);
+    sink = fovVisible(playerStartX, playerStartY);
+}
+
+// Traversée de la grande salle, une tuile par appel : recalcul et
+// exploration de nouvelles tuiles à chaque pas
+static void opFovWalk(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        benchPlayer.x += TILE_SIZE;
+        if (benchPlayer.x >= (LARGE_MAP_SIDE - 2) * TILE_SIZE) benchPlayer.x = TILE_SIZE;
+        fovUpdate(&benchPlayer);
+    }
+    sink = fovExplored(benchPlayer.x / TILE_SIZE, benchPlayer.y / TILE_SIZE);
+}
+
+static void setupHorde(void) {
+    spawnHorde(HORDE_SIZE);
+}
+
+static void setupLargeHorde(void) {
+    spawnHorde(LARGE_HORDE_SIZE);
+}
+
+static void opMoveEnemies(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) moveEnemies();
+    sink = (uint64_t)enemies.x[0];
+}
+
+// Contacts joueur-zombies sur toute la horde : en C pur pour comparaison,
+// puis avec le noyau choisi au démarrage (rétabli pour la suite)
+static const char* bestKernel = "scalar";
+
+static void setupContacts(void) {
+    setupLargeHorde();
+    collideUseKernel(bestKernel);
+}
+
+static void setupContactsScalar(void) {
+    setupLargeHorde();
+    collideUseKernel("scalar");
+}
+
+static void opContacts(uint64_t n) {
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        checkEnemyContacts(&benchPlayer);
+        hits += benchPlayer.contacts;
+    }
+    sink = hits;
+}
+
+// Ajouts et suppressions au hasard, retrouvées par poignée
+static EntityPool churnPool;
+static EntityHandle churnHandles[ENTITY_CHURN];
+
+static void setupEntityChurn(void) {
+    entityClear(&churnPool);
+    for (int i = 0; i < ENTITY_CHURN; i++) {
+        entityAdd(&churnPool, i, i, 0);
+        churnHandles[i] = entityHandle(&churnPool, i);
+    }
+    rngState = 31u;
+}
+
+static void opEntityChurn(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        int slot = nextRandom() % ENTITY_CHURN;
+        entityRemove(&churnPool, entityIndex(&churnPool, churnHandles[slot]));
+        int index = entityAdd(&churnPool, (int)i, (int)i, 0);
+        churnHandles[slot] = entityHandle(&churnPool, index);
+    }
+    sink = (uint64_t)churnPool.count;
+}
+
+static void setupTickDense(void) {
+    loadRoom(denseRoomPath);
+    benchPlayer = (Player){ .x = playerStartX * TILE_SIZE, .y = playerStartY * TILE_SIZE, .dir = DIR_DOWN };
+}
+
+// Labyrinthe de 1024 × 1024 peuplé de 65536 zombies (roomgen.h)
+static void generateLargeRoom(uint32_t seed) {
+    RoomGenParams params;
+    roomGenDefaults(&params);
+    params.seed = seed;
+    params.width = params.height = GENERATED_SIDE;
+    params.enemies = GENERATED_ENEMIES;
+    params.keys = params.doors = params.boxes = params.switches = 1024;
+    params.links = MAX_LINKS;
+    roomGenerate(&params, &benchRoom);
+}
+
+static void opGenerateRoom(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) generateLargeRoom((uint32_t)i);
+    sink = (uint64_t)benchRoom.enemies.count;
+}
+
+static void setupTickGenerated(void) {
+    resetRoomState();
+    generateLargeRoom(2024u);
+    applyRoom(&benchRoom);
+    benchPlayer = (Player){ .x = playerStartX * TILE_SIZE, .y = playerStartY * TILE_SIZE, .dir = DIR_DOWN };
+}
+
+static Room puzzleRoom;
+
+static void setupPuzzleMap11(void) {
+    if (!readRoom("world/map_1_1.txt", &puzzleRoom)) exit(1);
+}
+
+// Salle générée aux murs percés : les caisses y circulent, l'espace d'états grandit
+static void setupPuzzleGenerated(void) {
+    RoomGenParams params;
+    roomGenDefaults(&params);
+    params.seed = PUZZLE_SEED;
+    params.width = 15;
+    params.height = 11;
+    params.loopPercent = 50;
+    if (!roomGenerate(&params, &puzzleRoom)) exit(1);
+}
+
+static void opPuzzleSolve(uint64_t n) {
+    PuzzleResult result;
+    for (uint64_t i = 0; i < n; i++) puzzleSolve(&puzzleRoom, 0, &result);
+    sink = (uint64_t)result.pushes;
+}
+
+static void setupPuzzleCheck(void) {
+    loadRoom("world/map_1_1.txt");
+}
+
+static void opPuzzleCheck(uint64_t n) {
+    int stuck = 0;
+    for (uint64_t i = 0; i < n; i++) stuck += puzzleBoxPushed(0);
+    sink = (uint64_t)stuck;
+}
+
+// Sauvegarde de la salle de départ après quelques déplacements : la salle
+// diffère peu de sa référence (savestate.h)
+static SaveBuffer saveBuffer;
+
+static void setupSaveWorld(void) {
+    setupTickWorld();
+    runTicks(4 * TICK_SCRIPT_LENGTH);
+    if (!saveStateEncode(&benchPlayer, &saveBuffer)) exit(1);
+}
+
+// Même salle envahie par LARGE_HORDE_SIZE zombies : ensemble gardé en entier
+static void setupSaveHorde(void) {
+    setupTickWorld();
+    rngState = 77u;
+    while (enemies.count < LARGE_HORDE_SIZE) {
+        int x = nextRandom() % tileMap.width, y = nextRandom() % tileMap.height;
+        if (tileMapGet(&tileMap, x, y) != TILE_WALL)
+            entityAdd(&enemies, x * TILE_SIZE, y * TILE_SIZE, 0);
+    }
+    if (!saveStateEncode(&benchPlayer, &saveBuffer)) exit(1);
+}
+
+static void opSaveEncode(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) saveStateEncode(&benchPlayer, &saveBuffer);
+    sink = saveBuffer.size;
+}
+
+static void opSaveDecode(uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) saveStateDecode(saveBuffer.data, saveBuffer.size, &benchPlayer);
+    sink = (uint64_t)enemies.count;
+}
+
+// Partie enregistrée (replay.h) rejouée repeatCount fois : débit médian en
+// ticks par seconde. Code de sortie 1 si la partie diverge.
+static int runReplay(const char* path) {
+    double samples[64];
+    int count = repeatCount < 64 ? repeatCount : 64;
+    ReplayResult result;
+    for (int r = 0; r < count; r++) {
+        resetRoomState();
+        if (!replayRun(path, false, &result)) {
+            fprintf(stderr, "Rejeu %s : échec au tick %lld\n", path,
+                    (long long)(result.firstMismatch >= 0 ? result.firstMismatch : result.ticks));
+            return 1;
+        }
+        samples[r] = result.seconds * 1e9 / (result.ticks ? result.ticks : 1);
+    }
+    qsort(samples, count, sizeof(double), compareDouble);
+
+    double median = samples[count / 2];
+    printf("%-34s %12.1f ns/tick %11.0f ticks/s   (min %.1f, max %.1f, %u ticks x %d)\n",
+           path, median, 1e9 / median, samples[0], samples[count - 1], result.ticks, count);
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--filter=", 9) == 0) filter = argv[i] + 9;
+        else if (strncmp(argv[i], "--repeat=", 9) == 0) repeatCount = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--min-time=", 11) == 0) minTime = atoi(argv[i] + 11) / 1000.0;
+        else if (strcmp(argv[i], "--csv") == 0) csvOutput = true;
+        else if (strncmp(argv[i], "--threads=", 10) == 0) threadCount = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--replay=", 9) == 0) replayPath = argv[i] + 9;
+        else {
+            fprintf(stderr, "Option inconnue : %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (repeatCount < 1) repeatCount = 1;
+
+    logSetLevel(LOG_LEVEL_OFF);
+    jobsStart(threadCount);
+    saveStateStart(NULL);
+    bestKernel = collideKernelName();
+    if (!initWorld()) {
+        fprintf(stderr, "Impossible de charger %s\n", WORLD_MANIFEST);
+        return 1;
+    }
+
+    if (replayPath) {
+        int status = runReplay(replayPath);
+        worldClear();
+        jobsStop();
+        return status;
+    }
+
+    snprintf(denseRoomPath, sizeof(denseRoomPath), "/tmp/czbench_dense_XXXXXX");
+    int fd = mkstemp(denseRoomPath);
+    if (fd < 0 || !writeDenseRoom(denseRoomPath, 2024u)) {
+        fprintf(stderr, "Impossible de générer la salle de test\n");
+        return 1;
+    }
+    close(fd);
+
+    if (!compileTemporary("world/map_1_1.txt", mapBinaryPath) ||
+        !compileTemporary(denseRoomPath, denseBinaryPath)) {
+        fprintf(stderr, "Impossible de compiler les salles de test\n");
+        return 1;
+    }
+
+    snprintf(largeMapPath, sizeof(largeMapPath), "%s.large.czr", denseRoomPath);
+    if (!writeLargeMap(largeMapPath)) {
+        fprintf(stderr, "Impossible de générer la grande salle de test\n");
+        return 1;
+    }
+
+    snprintf(largeWorldPath, sizeof(largeWorldPath), "%s.manifest", denseRoomPath);
+    if (!writeLargeWorld(largeWorldPath)) {
+        fprintf(stderr, "Impossible de générer le monde de test\n");
+        return 1;
+    }
+
+    if (csvOutput) printf("name,median_ns,min_ns,max_ns,ops_per_sec\n");
+
+    runBench("collision/isCollision", setupCollision, opIsCollision);
+    runBench("collision/isCollision-4096", setupCollisionLarge, opIsCollision);
+    runBench("collision/collideTiles", setupCollision, opCollideTiles);
+    runBench("collision/checkCollision-boxes", setupCollision, opCheckCollisionBoxes);
+    runBench("push/box-dense", setupPush, opPush);
+    runBench("room/load-map_1_1", NULL, opLoadMap11);
+    runBench("room/load-map_1_2", NULL, opLoadMap12);
+    runBench("room/load-dense", NULL, opLoadDense);
+    runBench("room/load-binary-map_1_1", NULL, opLoadBinaryMap11);
+    runBench("room/load-binary-dense", NULL, opLoadBinaryDense);
+    runBench("room/load-binary-4096", NULL, opLoadBinaryLarge);
+    runBench("room/transition-sync", setupTransitionSync, opTransition);
+    runBench("room/transition-prefetched", setupTransitionPrefetched, opTransition);
+    runBench("room/transition-cached", setupTransitionCached, opTransition);
+    prefetchStop();
+    runBench("tick/world", setupTickWorld, runTicks);
+    runBench("tick/dense", setupTickDense, runTicks);
+    runBench("flow/recompute-dense", setupFlowDense, opFlowRecompute);
+    runBench("flow/recompute-4096", setupFlowLarge, opFlowRecompute);
+    runBench("flow/step-dense", setupFlowStep, opFlowStep);
+    runBench("flow/step-4096", setupFlowLargeStep, opFlowStep);
+    runBench("flow/move-horde-4096", setupHorde, opMoveEnemies);
+    runBench("flow/move-horde-65536", setupLargeHorde, opMoveEnemies);
+    runBench("fov/recompute-dense", setupFlowDense, opFovRecompute);
+    runBench("fov/recompute-4096", setupFlowLarge, opFovRecompute);
+    runBench("fov/walk-4096", setupFlowLarge, opFovWalk);
+    runBench("collision/contacts-65536-scalar", setupContactsScalar, opContacts);
+    runBench("collision/contacts-65536", setupContacts, opContacts);
+    runBench("entity/add-remove", setupEntityChurn, opEntityChurn);
+    runBench("savestate/encode-world", setupSaveWorld, opSaveEncode);
+    runBench("savestate/decode-world", setupSaveWorld, opSaveDecode);
+    runBench("savestate/encode-horde-65536", setupSaveHorde, opSaveEncode);
+    runBench("savestate/decode-horde-65536", setupSaveHorde, opSaveDecode);
+    runBench("puzzle/solve-map_1_1", setupPuzzleMap11, opPuzzleSolve);
+    runBench("puzzle/solve-generated", setupPuzzleGenerated, opPuzzleSolve);
+    runBench("puzzle/deadlock-check", setupPuzzleCheck, opPuzzleCheck);
+    runBench("gen/room-1024", NULL, opGenerateRoom);
+    runBench("tick/generated-1024", setupTickGenerated, runTicks);
+    runBench("world/load-manifest-10k", NULL, opLoadLargeWorld);
+    runBench("world/find-10k", setupFindLargeWorld, opFindLargeWorld);
+
+    unlink(denseRoomPath);
+    unlink(denseBinaryPath);
+    unlink(mapBinaryPath);
+    unlink(largeWorldPath);
+    unlink(largeMapPath);
+    worldClear();
+    entityFree(&churnPool);
+    roomFree(&puzzleRoom);
+    saveBufferFree(&saveBuffer);
+    saveStateShutdown();
+    jobsStop();
+    return 0;
+}
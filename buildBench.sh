@@ -0,0 +1,3 @@
+#!/bin/sh
+
+gcc -O2 bench.c game.c roomfile.c prefetch.c roomcache.c occupancy.c trigger.c puzzle.c flow.c fov.c entity.c jobs.c world.c tilemap.c collide.c log.c replay.c savestate.c roomgen.c -o SDLCommandoZombiBench -pthread
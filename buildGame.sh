@@ -1,3 +1,7 @@
 #!/bin/sh
 
-gcc main.c -o SDLCommandoZombi `sdl2-config --cflags --libs` -lSDL2 -lSDL2_image -lSDL2_ttf
+# Profileur d'images (profile.h) compilé par défaut ; PROFILE=0 ./buildGame.sh pour le retirer
+PROFILE_FLAGS=-DPROFILE
+[ "${PROFILE:-1}" = 0 ] && PROFILE_FLAGS=
+
+gcc main.c game.c roomfile.c prefetch.c roomcache.c occupancy.c trigger.c puzzle.c flow.c fov.c entity.c jobs.c world.c tilemap.c collide.c log.c replay.c savestate.c profile.c asset.c text.c sprite.c -o SDLCommandoZombi $PROFILE_FLAGS `sdl2-config --cflags --libs` -lSDL2 -lSDL2_image -lSDL2_ttf -pthread
@@ -0,0 +1,3 @@
+#!/bin/sh
+
+gcc -O2 mapc.c game.c roomfile.c prefetch.c roomcache.c occupancy.c trigger.c puzzle.c flow.c fov.c entity.c jobs.c world.c tilemap.c collide.c log.c -o mapc -pthread && ./mapc world/*.txt
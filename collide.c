@@ -0,0 +1,184 @@
+#include "collide.h"
+#include "game.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define COLLIDE_X86 1
+#include <immintrin.h>
+#endif
+
+#define LIST_BLOCK 1024             // rectangles testés par passe de collideList
+
+// Un noyau remplit le masque (déjà à zéro) pour [0, count). Le test
+// xs < right && xs > left && ys < bottom && ys > top est checkCollision
+// réécrit avec des comparaisons strictes, que SSE2 et AVX2 savent faire.
+typedef void (*MaskKernel)(int left, int right, int top, int bottom,
+                           const int* xs, const int* ys, int count, uint32_t* mask);
+
+typedef struct {
+    const char* name;
+    MaskKernel fn;
+    bool (*available)(void);
+} Kernel;
+
+
+// Rectangles [begin, end) un par un ; aussi la fin des lots vectoriels
+static inline void maskRange(int left, int right, int top, int bottom,
+                             const int* xs, const int* ys, int begin, int end, uint32_t* mask) {
+    // Sans branchement : le résultat de chaque test est imprévisible
+    for (int i = begin; i < end; i++) {
+        uint32_t hit = (xs[i] < right) & (xs[i] > left) & (ys[i] < bottom) & (ys[i] > top);
+        mask[i >> 5] |= hit << (i & 31);
+    }
+}
+
+static void maskScalar(int left, int right, int top, int bottom,
+                       const int* xs, const int* ys, int count, uint32_t* mask) {
+    maskRange(left, right, top, bottom, xs, ys, 0, count, mask);
+}
+
+static bool alwaysAvailable(void) {
+    return true;
+}
+
+#ifdef COLLIDE_X86
+__attribute__((target("sse2")))
+static void maskSse2(int left, int right, int top, int bottom,
+                     const int* xs, const int* ys, int count, uint32_t* mask) {
+    const __m128i vLeft = _mm_set1_epi32(left), vRight = _mm_set1_epi32(right);
+    const __m128i vTop = _mm_set1_epi32(top), vBottom = _mm_set1_epi32(bottom);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(xs + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(ys + i));
+        __m128i hit = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(vRight, x), _mm_cmpgt_epi32(x, vLeft)),
+                                    _mm_and_si128(_mm_cmpgt_epi32(vBottom, y), _mm_cmpgt_epi32(y, vTop)));
+        // i multiple de 4 : les 4 bits ne débordent jamais du mot
+        mask[i >> 5] |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(hit)) << (i & 31);
+    }
+    maskRange(left, right, top, bottom, xs, ys, i, count, mask);
+}
+
+__attribute__((target("avx2")))
+static void maskAvx2(int left, int right, int top, int bottom,
+                     const int* xs, const int* ys, int count, uint32_t* mask) {
+    const __m256i vLeft = _mm256_set1_epi32(left), vRight = _mm256_set1_epi32(right);
+    const __m256i vTop = _mm256_set1_epi32(top), vBottom = _mm256_set1_epi32(bottom);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(xs + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(ys + i));
+        __m256i hit = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(vRight, x), _mm256_cmpgt_epi32(x, vLeft)),
+                                       _mm256_and_si256(_mm256_cmpgt_epi32(vBottom, y), _mm256_cmpgt_epi32(y, vTop)));
+        mask[i >> 5] |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(hit)) << (i & 31);
+    }
+    maskRange(left, right, top, bottom, xs, ys, i, count, mask);
+}
+
+static bool hasSse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static bool hasAvx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+// Du plus rapide au plus lent
+static const Kernel kernels[] = {
+#ifdef COLLIDE_X86
+    { "avx2", maskAvx2, hasAvx2 },
+    { "sse2", maskSse2, hasSse2 },
+#endif
+    { "scalar", maskScalar, alwaysAvailable },
+};
+#define KERNEL_COUNT ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+static const Kernel* selected = NULL;
+static pthread_once_t selectOnce = PTHREAD_ONCE_INIT;
+
+static void selectKernel(void) {
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        if (kernels[k].available()) {
+            selected = &kernels[k];
+            return;
+        }
+    }
+}
+
+static const Kernel* kernel(void) {
+    pthread_once(&selectOnce, selectKernel);
+    return selected;
+}
+
+const char* collideKernelName(void) {
+    return kernel()->name;
+}
+
+bool collideUseKernel(const char* name) {
+    kernel();
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        if (strcmp(kernels[k].name, name) == 0 && kernels[k].available()) {
+            selected = &kernels[k];
+            return true;
+        }
+    }
+    return false;
+}
+
+static int countBits(const uint32_t* mask, int count) {
+    int hits = 0;
+    for (int w = 0; w < COLLIDE_MASK_WORDS(count); w++) {
+        hits += __builtin_popcount(mask[w]);
+    }
+    return hits;
+}
+
+int collideMask(int x, int y, int w, int h,
+                const int* xs, const int* ys, int count, int otherW, int otherH,
+                uint32_t* mask) {
+    if (count <= 0) return 0;
+
+    memset(mask, 0, COLLIDE_MASK_WORDS(count) * sizeof(uint32_t));
+    kernel()->fn(x - otherW, x + w, y - otherH, y + h, xs, ys, count, mask);
+    return countBits(mask, count);
+}
+
+int collideList(int x, int y, int w, int h,
+                const int* xs, const int* ys, int count, int otherW, int otherH,
+                int* out, int capacity) {
+    uint32_t mask[COLLIDE_MASK_WORDS(LIST_BLOCK)];
+    int hits = 0;
+
+    for (int begin = 0; begin < count; begin += LIST_BLOCK) {
+        int n = count - begin < LIST_BLOCK ? count - begin : LIST_BLOCK;
+        if (collideMask(x, y, w, h, xs + begin, ys + begin, n, otherW, otherH, mask) == 0)
+            continue;
+
+        for (int word = 0; word < COLLIDE_MASK_WORDS(n); word++) {
+            for (uint32_t bits = mask[word]; bits; bits &= bits - 1) {
+                if (hits < capacity) out[hits] = begin + word * 32 + __builtin_ctz(bits);
+                hits++;
+            }
+        }
+    }
+    return hits;
+}
+
+// Les tuiles sont lues à travers les pointeurs de tronçons : pas de
+// chargement vectoriel possible, le lot reste en C pur pour tous les noyaux
+int collideTiles(const int* xs, const int* ys, int count, int size, uint32_t* mask) {
+    if (count <= 0) return 0;
+
+    memset(mask, 0, COLLIDE_MASK_WORDS(count) * sizeof(uint32_t));
+    for (int i = 0; i < count; i++) {
+        if (isCollision(xs[i], ys[i], size))
+            mask[i >> 5] |= 1u << (i & 31);
+    }
+    return countBits(mask, count);
+}
@@ -0,0 +1,40 @@
+#ifndef COLLIDE_H
+#define COLLIDE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Tests de chevauchement par lots : un rectangle contre count rectangles de
+// même taille rangés en colonnes (xs, ys, comme EntityPool), ou count
+// rectangles contre la grille de la salle courante.
+//
+// Le noyau est choisi une fois pour toutes au premier appel selon le
+// processeur : AVX2 (8 rectangles par instruction), SSE2 (4), sinon C pur.
+// Tous donnent exactement le même résultat que checkCollision / isCollision.
+//
+// Résultat en masque : bit i % 32 du mot i / 32 pour le rectangle i, les
+// bits au-delà de count à zéro. mask doit contenir COLLIDE_MASK_WORDS(count) mots.
+
+#define COLLIDE_MASK_WORDS(count) (((count) + 31) / 32)
+
+// Rectangle (x, y, w, h) contre les rectangles (xs[i], ys[i], otherW, otherH) ;
+// renvoie le nombre de rectangles touchés
+int collideMask(int x, int y, int w, int h,
+                const int* xs, const int* ys, int count, int otherW, int otherH,
+                uint32_t* mask);
+// Même test, indices touchés dans l'ordre croissant (au plus capacity) ;
+// renvoie le nombre total de rectangles touchés
+int collideList(int x, int y, int w, int h,
+                const int* xs, const int* ys, int count, int otherW, int otherH,
+                int* out, int capacity);
+
+// Carrés (xs[i], ys[i], size) qui touchent un mur de tileMap (isCollision) ;
+// renvoie leur nombre
+int collideTiles(const int* xs, const int* ys, int count, int size, uint32_t* mask);
+
+// Noyau utilisé : "avx2", "sse2" ou "scalar"
+const char* collideKernelName(void);
+// Force un noyau (benchmarks) ; false s'il n'est pas disponible ici
+bool collideUseKernel(const char* name);
+
+#endif
@@ -0,0 +1,151 @@
+#include "entity.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOT_BITS 32
+#define SLOT_MASK 0xFFFFFFFFu
+
+// Toutes les colonnes, pour les agrandir et les copier ensemble
+#define ENTITY_COLUMNS(X) \
+    X(x) X(y) X(prevX) X(prevY) X(flags) \
+    X(dx) X(dy) X(target) X(occupants) X(links) \
+    X(denseSlot) X(slotIndex) X(slotGeneration)
+
+static bool growColumn(void** column, int capacity, size_t size) {
+    void* grown = realloc(*column, (size_t)capacity * size);
+    if (!grown) return false;
+    *column = grown;
+    return true;
+}
+
+bool entityReserve(EntityPool* pool, int capacity) {
+    if (capacity <= pool->capacity) return true;
+    if (capacity > ENTITY_MAX_COUNT) return false;
+
+    int grown = pool->capacity ? pool->capacity : 16;
+    while (grown < capacity) grown *= 2;
+    if (grown > ENTITY_MAX_COUNT) grown = ENTITY_MAX_COUNT;
+
+    // Une colonne agrandie garde son contenu : un échec laisse l'ensemble intact
+#define GROW(column) \
+    if (!growColumn((void**)&pool->column, grown, sizeof(*pool->column))) return false;
+    ENTITY_COLUMNS(GROW)
+#undef GROW
+
+    pool->capacity = grown;
+    return true;
+}
+
+void entityClear(EntityPool* pool) {
+    pool->count = 0;
+    pool->slotCount = 0;
+    pool->freeSlot = -1;
+}
+
+void entityFree(EntityPool* pool) {
+#define FREE(column) free(pool->column);
+    ENTITY_COLUMNS(FREE)
+#undef FREE
+    memset(pool, 0, sizeof(*pool));
+}
+
+bool entityCopy(EntityPool* dst, const EntityPool* src) {
+    if (dst == src) return true;
+
+    int needed = src->count > src->slotCount ? src->count : src->slotCount;
+    if (!entityReserve(dst, needed)) return false;
+    if (needed == 0) {
+        entityClear(dst);
+        return true;
+    }
+
+#define COPY_DENSE(column) memcpy(dst->column, src->column, (size_t)src->count * sizeof(*src->column));
+    COPY_DENSE(x) COPY_DENSE(y) COPY_DENSE(prevX) COPY_DENSE(prevY) COPY_DENSE(flags)
+    COPY_DENSE(dx) COPY_DENSE(dy) COPY_DENSE(target) COPY_DENSE(occupants) COPY_DENSE(links)
+    COPY_DENSE(denseSlot)
+#undef COPY_DENSE
+    memcpy(dst->slotIndex, src->slotIndex, (size_t)src->slotCount * sizeof(*src->slotIndex));
+    memcpy(dst->slotGeneration, src->slotGeneration, (size_t)src->slotCount * sizeof(*src->slotGeneration));
+
+    dst->count = src->count;
+    dst->slotCount = src->slotCount;
+    dst->freeSlot = src->freeSlot;
+    return true;
+}
+
+int entityAdd(EntityPool* pool, int x, int y, uint8_t flags) {
+    if (pool->count == 0 && pool->slotCount == 0) pool->freeSlot = -1;
+    if (!entityReserve(pool, pool->count + 1)) return -1;
+
+    // Créneau libéré par une suppression, sinon un nouveau
+    uint32_t slot;
+    if (pool->freeSlot >= 0) {
+        slot = (uint32_t)pool->freeSlot;
+        pool->freeSlot = pool->slotIndex[slot] == SLOT_MASK ? -1 : (int)pool->slotIndex[slot];
+    } else {
+        slot = (uint32_t)pool->slotCount++;
+        pool->slotGeneration[slot] = 0;
+    }
+
+    int index = pool->count++;
+    pool->slotIndex[slot] = (uint32_t)index;
+    pool->denseSlot[index] = slot;
+
+    pool->x[index] = x;
+    pool->y[index] = y;
+    pool->prevX[index] = x;
+    pool->prevY[index] = y;
+    pool->flags[index] = flags;
+    pool->dx[index] = 0;
+    pool->dy[index] = 0;
+    pool->target[index] = -1;
+    pool->occupants[index] = 0;
+    pool->links[index] = 0;
+    return index;
+}
+
+void entityRemove(EntityPool* pool, int index) {
+    if (index < 0 || index >= pool->count) return;
+
+    // Le créneau passe en tête de la liste libre, sa génération change :
+    // les poignées qui le désignaient ne correspondent plus
+    uint32_t slot = pool->denseSlot[index];
+    pool->slotGeneration[slot]++;
+    pool->slotIndex[slot] = pool->freeSlot >= 0 ? (uint32_t)pool->freeSlot : SLOT_MASK;
+    pool->freeSlot = (int)slot;
+
+    int last = --pool->count;
+    if (index == last) return;
+
+#define MOVE(column) pool->column[index] = pool->column[last];
+    MOVE(x) MOVE(y) MOVE(prevX) MOVE(prevY) MOVE(flags)
+    MOVE(dx) MOVE(dy) MOVE(target) MOVE(occupants) MOVE(links)
+    MOVE(denseSlot)
+#undef MOVE
+    pool->slotIndex[pool->denseSlot[index]] = (uint32_t)index;
+}
+
+size_t entityBytes(const EntityPool* pool) {
+    size_t perEntity = 0;
+#define SIZE(column) perEntity += sizeof(*pool->column);
+    ENTITY_COLUMNS(SIZE)
+#undef SIZE
+    return perEntity * pool->capacity;
+}
+
+EntityHandle entityHandle(const EntityPool* pool, int index) {
+    if (index < 0 || index >= pool->count) return ENTITY_NONE;
+
+    uint32_t slot = pool->denseSlot[index];
+    return (uint64_t)pool->slotGeneration[slot] << SLOT_BITS | slot;
+}
+
+int entityIndex(const EntityPool* pool, EntityHandle handle) {
+    uint32_t slot = (uint32_t)(handle & SLOT_MASK);
+    if (handle == ENTITY_NONE || slot >= (uint32_t)pool->slotCount) return -1;
+    if (pool->slotGeneration[slot] != handle >> SLOT_BITS) return -1;
+
+    uint32_t index = pool->slotIndex[slot];
+    if (index >= (uint32_t)pool->count || pool->denseSlot[index] != slot) return -1;
+    return (int)index;
+}
@@ -0,0 +1,79 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Stockage des entités d'un type par colonnes : chaque champ est un tableau
+// contigu indexé par la position dense 0..count-1. Une boucle de mise à jour
+// ou de rendu ne lit que les colonnes qu'elle utilise.
+//
+// Les colonnes grandissent à la demande (doublement) et ne rétrécissent
+// jamais : d'une salle à l'autre, la mémoire déjà allouée est réutilisée.
+//
+// La suppression déplace la dernière entité dans le trou (swap-remove) :
+// les positions denses changent, pas les poignées, qui restent valides
+// jusqu'à la suppression de leur entité.
+
+// Génération (32 bits hauts) | créneau (32 bits bas) : un créneau devrait
+// être réutilisé 2³² fois avant qu'une ancienne poignée redevienne valide
+typedef uint64_t EntityHandle;
+#define ENTITY_NONE UINT64_MAX
+#define ENTITY_MAX_COUNT ((1 << 24) - 1)
+
+enum {
+    ENTITY_ACTIVE    = 1 << 0,      // caisse, interrupteur : présent dans la salle
+    ENTITY_OPEN      = 1 << 1,      // porte ouverte
+    ENTITY_TRIGGERED = 1 << 2,      // interrupteur recouvert par une caisse
+    ENTITY_ALERTED   = 1 << 3,      // zombie qui a aperçu le joueur (fov.h)
+};
+
+typedef struct {
+    int count;
+    int capacity;
+
+    // Colonnes communes
+    int* x;                         // en pixels
+    int* y;
+    int* prevX;                     // position au tick précédent (interpolation)
+    int* prevY;
+    uint8_t* flags;
+
+    // Colonnes propres à un type (à zéro pour les autres)
+    int16_t* dx;                    // zombies : pas en cours (pixels par tick)
+    int16_t* dy;
+    int16_t* target;                // clés : porte ouverte (-1 : aucune)
+    uint16_t* occupants;            // interrupteurs : caisses qui les recouvrent
+    uint16_t* links;                // interrupteurs : masque des mécanismes
+
+    // Poignées
+    uint32_t* denseSlot;            // position dense → créneau
+    uint32_t* slotIndex;            // créneau → position dense, ou créneau libre suivant
+    uint32_t* slotGeneration;
+    int slotCount;                  // créneaux déjà attribués
+    int freeSlot;                   // -1 : aucun créneau libre
+} EntityPool;
+
+// Un EntityPool mis à zéro est un ensemble vide valide
+bool entityReserve(EntityPool* pool, int capacity);
+// Vide l'ensemble sans libérer la mémoire ; les poignées sont invalidées
+void entityClear(EntityPool* pool);
+void entityFree(EntityPool* pool);
+// Copie profonde, poignées comprises (la mémoire de dst est réutilisée)
+bool entityCopy(EntityPool* dst, const EntityPool* src);
+
+// Ajoute une entité (colonnes propres à zéro, target à -1) ; sa position
+// dense est count - 1. -1 si la mémoire manque.
+int entityAdd(EntityPool* pool, int x, int y, uint8_t flags);
+// Supprime l'entité index ; la dernière prend sa place
+void entityRemove(EntityPool* pool, int index);
+
+// Octets alloués pour les colonnes
+size_t entityBytes(const EntityPool* pool);
+
+EntityHandle entityHandle(const EntityPool* pool, int index);
+// Position dense actuelle, -1 si l'entité a été supprimée
+int entityIndex(const EntityPool* pool, EntityHandle handle);
+
+#endif
@@ -0,0 +1,374 @@
+#include "flow.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FLOW_ROW_GRAIN 64            // lignes recopiées par tâche
+#define FLOW_PENDING 16              // changements de passage réparés en place
+#define FLOW_WINDOW_STEP 32          // pas de déplacement de la fenêtre, en tuiles
+#define FLOW_OFFSET 16384            // pas de la cible suivis avant un parcours complet
+
+// Fenêtre courante dans la salle, en tuiles. Les tableaux ont une bordure
+// d'une case bloquée tout autour : le parcours n'a aucun test de bornes.
+static int originX = 0, originY = 0;
+static int width = 0, height = 0;
+static int stride = 0;              // width + 2
+static int capacity = 0;
+
+// Distance d'une tuile : distance[cell] - offset (FLOW_UNREACHED à part).
+// Un pas de la cible augmente toutes les distances d'un coup en baissant
+// offset ; seules les tuiles qui se rapprochent sont réécrites.
+static uint16_t* distance = NULL;   // (width + 2) * (height + 2), ligne par ligne
+static uint16_t offset = FLOW_OFFSET;
+static uint8_t* blocked = NULL;
+static int* queue = NULL;
+
+// Ce qui a servi au dernier calcul
+static bool dirty = true;
+static unsigned revision = 0;
+static int targetX = -1, targetY = -1;
+
+// Rectangles (en pixels, d'une tuile) dont le passage a pu changer depuis
+// le dernier calcul : leurs tuiles sont réévaluées au prochain flowUpdate
+static int pending[FLOW_PENDING][2];
+static int pendingCount = 0;
+
+
+void flowInvalidate(void) {
+    dirty = true;
+}
+
+static void addPending(int x, int y) {
+    if (pendingCount == FLOW_PENDING) {
+        dirty = true;
+        return;
+    }
+    pending[pendingCount][0] = x;
+    pending[pendingCount][1] = y;
+    pendingCount++;
+}
+
+void flowDoorOpened(int x, int y) {
+    addPending(x, y);
+}
+
+void flowBoxMoved(int oldX, int oldY, int newX, int newY) {
+    // Une caisse bloque toutes les tuiles que son rectangle recouvre
+    if (oldX / TILE_SIZE != newX / TILE_SIZE ||
+        oldY / TILE_SIZE != newY / TILE_SIZE ||
+        (oldX + TILE_SIZE - 1) / TILE_SIZE != (newX + TILE_SIZE - 1) / TILE_SIZE ||
+        (oldY + TILE_SIZE - 1) / TILE_SIZE != (newY + TILE_SIZE - 1) / TILE_SIZE) {
+        addPending(oldX, oldY);
+        addPending(newX, newY);
+    }
+}
+
+static bool reserve(int cells) {
+    if (cells <= capacity) return true;
+
+    uint16_t* grownDistance = realloc(distance, cells * sizeof(uint16_t));
+    if (grownDistance) distance = grownDistance;
+    uint8_t* grownBlocked = realloc(blocked, cells);
+    if (grownBlocked) blocked = grownBlocked;
+    int* grownQueue = realloc(queue, cells * sizeof(int));
+    if (grownQueue) queue = grownQueue;
+
+    if (!grownDistance || !grownBlocked || !grownQueue) return false;
+    capacity = cells;
+    return true;
+}
+
+// Centre la fenêtre sur la cible sans sortir de la salle, par pas de
+// FLOW_WINDOW_STEP tuiles : la fenêtre (et sa grille de passage) reste la
+// même tant que la cible ne s'éloigne pas, et ne dépend que de la cible
+static int windowOrigin(int target, int size) {
+    if (size <= FLOW_WINDOW) return 0;
+
+    int origin = target - FLOW_WINDOW / 2;
+    origin = origin < 0 ? 0 : origin / FLOW_WINDOW_STEP * FLOW_WINDOW_STEP;
+    if (origin > size - FLOW_WINDOW) origin = size - FLOW_WINDOW;
+    return origin;
+}
+
+static void blockRect(int x, int y) {
+    int minX = x / TILE_SIZE - originX, maxX = (x + TILE_SIZE - 1) / TILE_SIZE - originX;
+    int minY = y / TILE_SIZE - originY, maxY = (y + TILE_SIZE - 1) / TILE_SIZE - originY;
+    for (int ty = minY; ty <= maxY; ty++) {
+        for (int tx = minX; tx <= maxX; tx++) {
+            if (tx >= 0 && ty >= 0 && tx < width && ty < height) blocked[(ty + 1) * stride + tx + 1] = 1;
+        }
+    }
+}
+
+// Recopie de la grille, par tranches de lignes indépendantes (jobs.h)
+static void copyRows(void* context, int begin, int end, int chunk) {
+    (void)context;
+    (void)chunk;
+
+    for (int y = begin; y < end; y++) {
+        uint8_t* row = blocked + (y + 1) * stride;
+        row[0] = row[width + 1] = 1;
+
+        // Tronçon par tronçon : une lecture de pointeur par CHUNK_SIZE tuiles
+        int mapY = originY + y;
+        Chunk* const* chunks = &tileMap.chunks[(mapY >> CHUNK_SHIFT) * tileMap.chunksX];
+        for (int x = 0; x < width; ) {
+            int mapX = originX + x;
+            int run = CHUNK_SIZE - (mapX & CHUNK_MASK);
+            if (run > width - x) run = width - x;
+            memcpy(row + 1 + x, &chunks[mapX >> CHUNK_SHIFT]->tiles[mapY & CHUNK_MASK][mapX & CHUNK_MASK], run);
+            x += run;
+        }
+    }
+}
+
+static void buildBlocked(void) {
+    memset(blocked, 1, stride);
+    memset(blocked + (height + 1) * stride, 1, stride);
+    jobsParallelFor(height, FLOW_ROW_GRAIN, copyRows, NULL);
+
+    for (int i = 0; i < doors.count; i++) {
+        if (!(doors.flags[i] & ENTITY_OPEN)) blockRect(doors.x[i], doors.y[i]);
+    }
+    for (int i = 0; i < boxes.count; i++) {
+        if (boxes.flags[i] & ENTITY_ACTIVE) blockRect(boxes.x[i], boxes.y[i]);
+    }
+}
+
+// Parcours en largeur depuis la cible sur la grille de passage courante,
+// 4 voisines ; la bordure arrête l'expansion
+static void search(void) {
+    memset(distance, 0xff, stride * (height + 2) * sizeof(uint16_t));
+
+    int startX = targetX - originX, startY = targetY - originY;
+    if (startX < 0 || startY < 0 || startX >= width || startY >= height) return;
+
+    const int neighbours[4] = { -stride, -1, stride, 1 };
+    int head = 0, tail = 0;
+    int start = (startY + 1) * stride + startX + 1;
+    offset = FLOW_OFFSET;
+    distance[start] = offset;
+    queue[tail++] = start;
+
+    while (head < tail) {
+        int cell = queue[head++];
+        uint16_t next = distance[cell] + 1;
+        if (next == FLOW_UNREACHED) continue;
+
+        for (int n = 0; n < 4; n++) {
+            int neighbour = cell + neighbours[n];
+            if (blocked[neighbour] || distance[neighbour] != FLOW_UNREACHED) continue;
+
+            distance[neighbour] = next;
+            queue[tail++] = neighbour;
+        }
+    }
+}
+
+void flowRecompute(const Player* player) {
+    targetX = (player->x + TILE_SIZE / 2) / TILE_SIZE;
+    targetY = (player->y + TILE_SIZE / 2) / TILE_SIZE;
+    revision = tileRevision;
+    dirty = false;
+    pendingCount = 0;
+
+    int w = tileMap.width < FLOW_WINDOW ? tileMap.width : FLOW_WINDOW;
+    int h = tileMap.height < FLOW_WINDOW ? tileMap.height : FLOW_WINDOW;
+    if (!reserve((w + 2) * (h + 2))) {
+        LOG_ERROR(LOG_SYSTEM, "Mémoire insuffisante pour le champ de flux");
+        width = height = 0;
+        dirty = true;
+        return;
+    }
+    width = w;
+    height = h;
+    stride = w + 2;
+    originX = windowOrigin(targetX, tileMap.width);
+    originY = windowOrigin(targetY, tileMap.height);
+
+    buildBlocked();
+    search();
+}
+
+// Passage d'une tuile de la salle, comme buildBlocked
+static bool tileBlocked(int mapX, int mapY) {
+    if (tileMapGet(&tileMap, mapX, mapY) != TILE_GROUND) return true;
+
+    int hits[OCCUPANCY_MAX_HITS];
+    int count = occupancyQuery(OCC_DOOR, mapX * TILE_SIZE, mapY * TILE_SIZE, hits);
+    for (int h = 0; h < count; h++) {
+        if (!(doors.flags[hits[h]] & ENTITY_OPEN)) return true;
+    }
+    return occupancyQuery(OCC_BOX, mapX * TILE_SIZE, mapY * TILE_SIZE, hits) > 0;
+}
+
+// Réévalue les tuiles des rectangles en attente ; les tuiles libérées vont
+// dans freed. true si une tuile atteinte est devenue bloquante (des
+// distances peuvent alors augmenter)
+static bool applyPending(int* freed, int* freedCount) {
+    bool closed = false;
+    *freedCount = 0;
+    for (int p = 0; p < pendingCount; p++) {
+        int x = pending[p][0], y = pending[p][1];
+        for (int mapY = y / TILE_SIZE; mapY <= (y + TILE_SIZE - 1) / TILE_SIZE; mapY++) {
+            for (int mapX = x / TILE_SIZE; mapX <= (x + TILE_SIZE - 1) / TILE_SIZE; mapX++) {
+                int wx = mapX - originX, wy = mapY - originY;
+                if (wx < 0 || wy < 0 || wx >= width || wy >= height) continue;
+
+                int cell = (wy + 1) * stride + wx + 1;
+                uint8_t now = tileBlocked(mapX, mapY);
+                if (now == blocked[cell]) continue;
+
+                blocked[cell] = now;
+                if (now) {
+                    closed = closed || distance[cell] != FLOW_UNREACHED;
+                    distance[cell] = FLOW_UNREACHED;
+                } else {
+                    freed[(*freedCount)++] = cell;
+                }
+            }
+        }
+    }
+    pendingCount = 0;
+    return closed;
+}
+
+// Tuiles libérées sans autre changement : les distances ne peuvent que
+// baisser. Chaque tuile libérée prend la meilleure de ses voisines, puis
+// les baisses se propagent par distance croissante (les tuiles libérées
+// entrent dans la file à leur tour) : seules les tuiles qui changent sont
+// visitées, chacune une fois.
+static void repair(int* freed, int freedCount) {
+    const int neighbours[4] = { -stride, -1, stride, 1 };
+
+    for (int i = 0; i < freedCount; i++) {
+        int cell = freed[i];
+        for (int n = 0; n < 4; n++) {
+            uint16_t through = distance[cell + neighbours[n]];
+            if (through < FLOW_UNREACHED - 1 && through + 1 < distance[cell]) distance[cell] = through + 1;
+        }
+    }
+    // Tri par insertion : quelques tuiles au plus
+    for (int i = 1; i < freedCount; i++) {
+        int cell = freed[i], j = i;
+        for (; j > 0 && distance[freed[j - 1]] > distance[cell]; j--) freed[j] = freed[j - 1];
+        freed[j] = cell;
+    }
+
+    // Distances des tuiles libérées au départ : une tuile déjà atteinte plus
+    // court par la file n'est pas reprise
+    uint16_t seedDistance[FLOW_PENDING * 4];
+    for (int i = 0; i < freedCount; i++) seedDistance[i] = distance[freed[i]];
+
+    int head = 0, tail = 0, seed = 0;
+    for (;;) {
+        int cell;
+        if (seed < freedCount && (head == tail || seedDistance[seed] <= distance[queue[head]])) {
+            cell = freed[seed];
+            if (distance[cell] != seedDistance[seed++]) continue;
+        } else if (head < tail) {
+            cell = queue[head++];
+        } else {
+            break;
+        }
+
+        uint16_t next = distance[cell] + 1;
+        if (distance[cell] == FLOW_UNREACHED || next == FLOW_UNREACHED) continue;
+        for (int n = 0; n < 4; n++) {
+            int neighbour = cell + neighbours[n];
+            if (blocked[neighbour] || distance[neighbour] <= next) continue;
+
+            distance[neighbour] = next;
+            queue[tail++] = neighbour;
+        }
+    }
+}
+
+// La cible passe sur la tuile voisine cell. La grille est bipartite : une
+// tuile est à une distance de parité différente des deux cibles, et à un
+// pas près, donc chaque distance change d'exactement 1. Baissent celles
+// dont un plus court chemin passe par cell : les tuiles atteintes depuis
+// cell en montant d'une unité à chaque pas. Toutes les autres augmentent
+// (offset). false si le pas ne peut pas être suivi ainsi.
+static bool step(int from, int cell) {
+    // Une cible sur une tuile bloquée (joueur à cheval) n'est pas dans la grille
+    if (offset == 0 || blocked[from] || blocked[cell] || distance[cell] != offset + 1) return false;
+
+    const int neighbours[4] = { -stride, -1, stride, 1 };
+    offset--;
+    distance[cell] -= 2;
+    int head = 0, tail = 0;
+    queue[tail++] = cell;
+
+    // Une tuile déjà baissée ne correspond plus à la distance cherchée
+    while (head < tail) {
+        int current = queue[head++];
+        uint16_t next = distance[current] + 3;
+        if (next >= FLOW_UNREACHED) continue;
+
+        for (int n = 0; n < 4; n++) {
+            int neighbour = current + neighbours[n];
+            if (distance[neighbour] != next) continue;
+
+            distance[neighbour] -= 2;
+            queue[tail++] = neighbour;
+        }
+    }
+    return true;
+}
+
+bool flowUpdate(const Player* player) {
+    int tileX = (player->x + TILE_SIZE / 2) / TILE_SIZE;
+    int tileY = (player->y + TILE_SIZE / 2) / TILE_SIZE;
+    bool moved = tileX != targetX || tileY != targetY;
+    if (!dirty && revision == tileRevision && !moved && pendingCount == 0)
+        return false;
+
+    // Nouvelle salle, fenêtre déplacée ou trop de changements : tout est refait
+    if (dirty || revision != tileRevision ||
+        windowOrigin(tileX, tileMap.width) != originX || windowOrigin(tileY, tileMap.height) != originY) {
+        flowRecompute(player);
+        return true;
+    }
+
+    // Sinon la grille de passage est gardée et corrigée tuile par tuile
+    int freed[FLOW_PENDING * 4];
+    int freedCount;
+    bool closed = applyPending(freed, &freedCount);
+    if (!closed && freedCount > 0) repair(freed, freedCount);
+
+    if (moved || closed) {
+        bool adjacent = abs(tileX - targetX) + abs(tileY - targetY) == 1;
+        int from = (targetY - originY + 1) * stride + targetX - originX + 1;
+        int cell = (tileY - originY + 1) * stride + tileX - originX + 1;
+        targetX = tileX;
+        targetY = tileY;
+        if (closed || !adjacent || !step(from, cell)) search();
+    }
+    return true;
+}
+
+uint16_t flowDistance(int tileX, int tileY) {
+    int x = tileX - originX, y = tileY - originY;
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        return FLOW_UNREACHED;
+    uint16_t raw = distance[(y + 1) * stride + x + 1];
+    return raw == FLOW_UNREACHED ? FLOW_UNREACHED : raw - offset;
+}
+
+bool flowDirection(int tileX, int tileY, int* dx, int* dy) {
+    uint16_t current = flowDistance(tileX, tileY);
+    if (current == 0 || current == FLOW_UNREACHED) return false;
+
+    // Même ordre que Direction : haut, gauche, bas, droite
+    const int steps[4][2] = { { 0, -1 }, { -1, 0 }, { 0, 1 }, { 1, 0 } };
+    for (int s = 0; s < 4; s++) {
+        if (flowDistance(tileX + steps[s][0], tileY + steps[s][1]) < current) {
+            *dx = steps[s][0];
+            *dy = steps[s][1];
+            return true;
+        }
+    }
+    return false;
+}
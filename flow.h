@@ -0,0 +1,48 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+// Champ de flux partagé par tous les zombies : un seul parcours en largeur
+// depuis la tuile du joueur donne, pour chaque tuile, sa distance au joueur.
+// Chaque ennemi suit la pente du champ en lisant ses voisines : O(1) par
+// ennemi, quel que soit leur nombre.
+//
+// Le champ n'est recalculé que si la cible change de tuile ou si le passage
+// change (grille, porte ouverte, caisse qui change de tuile), et la grille
+// de passage de la fenêtre est gardée d'un calcul à l'autre : une porte ou
+// une caisse ne corrige que ses tuiles. Une tuile libérée (porte ouverte)
+// ne fait que baisser des distances, propagées depuis elle seule ; une
+// cible qui passe sur une tuile voisine décale toutes les distances d'un
+// pas et ne réécrit que celles qui baissent. Un saut plus long ou une tuile
+// atteinte qui se bouche relance le parcours, sans relire la salle.
+// Nouvelle salle ou fenêtre déplacée : tout est refait. Il couvre une
+// fenêtre de FLOW_WINDOW tuiles autour du joueur, déplacée par pas de 32
+// tuiles : dans une très grande salle, les zombies plus loin restent
+// immobiles.
+
+#define FLOW_WINDOW 256             // en tuiles
+#define FLOW_UNREACHED 0xFFFF
+#define ENEMY_SPEED 2               // pixels par tick, diviseur de TILE_SIZE
+
+// Le passage a changé : recalcul complet au prochain flowUpdate
+void flowInvalidate(void);
+// La porte en (x, y) (pixels) s'est ouverte : ses tuiles sont réparées au
+// prochain flowUpdate
+void flowDoorOpened(int x, int y);
+// Une caisse s'est déplacée : correction seulement si elle change de tuiles
+void flowBoxMoved(int oldX, int oldY, int newX, int newY);
+// Recalcule le champ si nécessaire ; true s'il a été recalculé
+bool flowUpdate(const Player* player);
+// Force le recalcul complet (benchmarks)
+void flowRecompute(const Player* player);
+
+// Distance en tuiles jusqu'au joueur, FLOW_UNREACHED si inaccessible ou hors fenêtre
+uint16_t flowDistance(int tileX, int tileY);
+// Pas vers le joueur depuis la tuile (-1, 0 ou 1 par axe) ;
+// false si la tuile est la cible, inaccessible ou hors fenêtre
+bool flowDirection(int tileX, int tileY, int* dx, int* dy);
+
+#endif
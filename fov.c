@@ -0,0 +1,264 @@
+#include "fov.h"
+#include "occupancy.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FOV_SIDE (2 * FOV_RADIUS + 1)
+
+// Fenêtre centrée sur le joueur : bit x de la ligne y pour la tuile
+// (originX + x, originY + y). Hors de la salle, tout est opaque. Les
+// colonnes (bit y de la colonne x) servent aux quarts est et ouest ; 64
+// lignes pour la transposition.
+static int originX = 0, originY = 0;
+static uint64_t opaque[64], opaqueColumns[64];
+static uint64_t visible[64], visibleColumns[64];
+
+// Tuiles explorées : une ligne de bits par ligne de la salle, NULL tant
+// qu'aucune de ses tuiles n'a été vue
+static uint64_t** explored = NULL;
+static int exploredHeight = 0;
+static int exploredWords = 0;
+
+// Ce qui a servi au dernier calcul
+static bool dirty = true;
+static unsigned revision = 0;
+static int centerX = -1, centerY = -1;
+
+unsigned fovRevision = 0;
+
+
+void fovInvalidate(void) {
+    dirty = true;
+}
+
+static void freeExplored(void) {
+    for (int y = 0; y < exploredHeight; y++) free(explored[y]);
+    free(explored);
+    explored = NULL;
+    exploredHeight = 0;
+    exploredWords = 0;
+}
+
+void fovReset(void) {
+    freeExplored();
+    memset(visible, 0, sizeof(visible));
+    dirty = true;
+}
+
+// Tableau des lignes à la taille de la salle courante
+static bool allocExplored(void) {
+    if (explored && exploredHeight == tileMap.height && exploredWords == (tileMap.width + 63) / 64)
+        return true;
+
+    freeExplored();
+    explored = calloc(tileMap.height, sizeof(uint64_t*));
+    if (!explored) return false;
+    exploredHeight = tileMap.height;
+    exploredWords = (tileMap.width + 63) / 64;
+    return true;
+}
+
+static void buildOpaque(void) {
+    // Colonnes de la fenêtre dans la salle ; le reste est opaque
+    int minX = originX < 0 ? -originX : 0;
+    int maxX = tileMap.width - originX < FOV_SIDE ? tileMap.width - originX : FOV_SIDE;
+
+    for (int y = 0; y < FOV_SIDE; y++) {
+        uint64_t row = ~0ull;
+        int mapY = originY + y;
+        if (mapY >= 0 && mapY < tileMap.height) {
+            // Tronçon par tronçon : une lecture de pointeur par CHUNK_SIZE tuiles
+            Chunk* const* chunks = &tileMap.chunks[(mapY >> CHUNK_SHIFT) * tileMap.chunksX];
+            for (int x = minX; x < maxX; ) {
+                int mapX = originX + x;
+                int run = CHUNK_SIZE - (mapX & CHUNK_MASK);
+                if (run > maxX - x) run = maxX - x;
+                const uint8_t* tiles = &chunks[mapX >> CHUNK_SHIFT]->tiles[mapY & CHUNK_MASK][mapX & CHUNK_MASK];
+                for (int i = 0; i < run; i++) {
+                    if (tiles[i] != TILE_WALL) row &= ~(1ull << (x + i));
+                }
+                x += run;
+            }
+        }
+        opaque[y] = row;
+    }
+
+    static int hits[FOV_SIDE * FOV_SIDE];
+    int count = occupancyCollect(OCC_DOOR, originX, originY, originX + FOV_SIDE - 1, originY + FOV_SIDE - 1,
+                                 hits, FOV_SIDE * FOV_SIDE);
+    for (int h = 0; h < count; h++) {
+        int i = hits[h];
+        if (doors.flags[i] & ENTITY_OPEN) continue;
+        // Les portes sont posées sur une tuile : seule celle de leur ancre compte
+        int x = doors.x[i] / TILE_SIZE - originX, y = doors.y[i] / TILE_SIZE - originY;
+        if (x >= 0 && y >= 0 && x < FOV_SIDE && y < FOV_SIDE) opaque[y] |= 1ull << x;
+    }
+}
+
+// Transposition d'une matrice de 64 × 64 bits, en place : le bit x de la
+// ligne y devient le bit y de la ligne x
+static void transpose(uint64_t lines[64]) {
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((lines[k] >> j) ^ lines[k | j]) & mask;
+            lines[k] ^= t << j;
+            lines[k | j] ^= t;
+        }
+    }
+}
+
+// Division arrondie vers -∞, diviseur positif
+static int floorDivide(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// Bits des colonnes col de first à last (relatives au joueur)
+static uint64_t columnMask(int first, int last) {
+    if (first > last) return 0;
+    return (2ull << (FOV_RADIUS + last)) - (1ull << (FOV_RADIUS + first));
+}
+
+// Un quart de plan, rangée par rangée à partir de depth : la rangée depth
+// est la ligne FOV_RADIUS + sign * depth de lines (lignes pour nord et sud,
+// colonnes pour est et ouest), la colonne col son bit FOV_RADIUS + col.
+// Secteur vu entre les pentes startNum / startDen et endNum / endDen
+// (colonne / rangée, dénominateurs positifs). Chaque suite de sols bordée
+// d'un mur ouvre un secteur plus étroit pour la rangée suivante ; la
+// récursion est bornée par FOV_RADIUS.
+static void scanQuadrant(const uint64_t* lines, uint64_t* seen, int sign, int depth,
+                         int startNum, int startDen, int endNum, int endDen) {
+    for (; depth <= FOV_RADIUS; depth++) {
+        // Colonnes touchées par le secteur, arrondi des demi-tuiles vers
+        // l'intérieur : floor(depth * start + 1/2) .. ceil(depth * end - 1/2)
+        int minCol = floorDivide(2 * depth * startNum + startDen, 2 * startDen);
+        int maxCol = -floorDivide(endDen - 2 * depth * endNum, 2 * endDen);
+        uint64_t row = columnMask(minCol, maxCol);
+        uint64_t walls = lines[FOV_RADIUS + sign * depth] & row;
+        uint64_t floors = row & ~walls;
+
+        // Symétrie : un sol n'est visible que si son centre est dans le secteur
+        int firstCentre = -floorDivide(-depth * startNum, startDen);
+        int lastCentre = floorDivide(depth * endNum, endDen);
+        seen[FOV_RADIUS + sign * depth] |= walls | (floors & columnMask(firstCentre, lastCentre));
+
+        // Suites de sols : chacune continue le secteur jusqu'au mur suivant
+        int continueNum = 0, continueDen = 0;
+        while (floors) {
+            int first = __builtin_ctzll(floors);
+            int length = __builtin_ctzll(~(floors >> first));
+            int firstCol = first - FOV_RADIUS, lastCol = firstCol + length - 1;
+            floors &= ~columnMask(firstCol, lastCol);
+
+            // Un mur à gauche resserre le début du secteur
+            int runNum = startNum, runDen = startDen;
+            if (firstCol > minCol) {
+                runNum = 2 * firstCol - 1;
+                runDen = 2 * depth;
+            }
+            if (lastCol < maxCol) {
+                scanQuadrant(lines, seen, sign, depth + 1, runNum, runDen, 2 * lastCol + 1, 2 * depth);
+            } else {
+                continueNum = runNum;
+                continueDen = runDen;
+            }
+        }
+
+        // Rangée terminée sur un mur (ou vide) : rien ne passe au-delà
+        if (continueDen == 0) return;
+        startNum = continueNum;
+        startDen = continueDen;
+    }
+}
+
+// Efface les bits hors de la salle, puis recopie la vue dans les lignes
+// explorées
+static void markExplored(void) {
+    uint64_t columns = (1ull << FOV_SIDE) - 1;
+    if (originX < 0) columns &= ~0ull << -originX;
+    if (originX >= tileMap.width) columns = 0;
+    else if (originX + FOV_SIDE > tileMap.width) columns &= (1ull << (tileMap.width - originX)) - 1;
+
+    for (int y = 0; y < FOV_SIDE; y++) {
+        int mapY = originY + y;
+        if (mapY < 0 || mapY >= tileMap.height) visible[y] = 0;
+        else visible[y] &= columns;
+    }
+
+    if (!allocExplored()) {
+        LOG_ERROR(LOG_SYSTEM, "Mémoire insuffisante pour le brouillard de guerre");
+        return;
+    }
+
+    for (int y = 0; y < FOV_SIDE; y++) {
+        uint64_t bits = visible[y];
+        if (!bits) continue;
+
+        int mapY = originY + y;
+        if (!explored[mapY]) {
+            explored[mapY] = calloc(exploredWords, sizeof(uint64_t));
+            if (!explored[mapY]) continue;
+        }
+
+        // Décalage de la fenêtre vers les mots de la ligne
+        uint64_t* row = explored[mapY];
+        int mapX = originX;
+        if (mapX < 0) {
+            bits >>= -mapX;
+            mapX = 0;
+        }
+        int word = mapX >> 6, shift = mapX & 63;
+        row[word] |= bits << shift;
+        if (shift && word + 1 < exploredWords) row[word + 1] |= bits >> (64 - shift);
+    }
+}
+
+void fovRecompute(const Player* player) {
+    centerX = (player->x + TILE_SIZE / 2) / TILE_SIZE;
+    centerY = (player->y + TILE_SIZE / 2) / TILE_SIZE;
+    revision = tileRevision;
+    dirty = false;
+    fovRevision++;
+
+    originX = centerX - FOV_RADIUS;
+    originY = centerY - FOV_RADIUS;
+    buildOpaque();
+    memset(visible, 0, sizeof(visible));
+
+    memset(visibleColumns, 0, sizeof(visibleColumns));
+    memcpy(opaqueColumns, opaque, sizeof(opaque));
+    transpose(opaqueColumns);
+
+    // Nord et sud sur les lignes, est et ouest sur les colonnes
+    visible[FOV_RADIUS] |= 1ull << FOV_RADIUS;
+    scanQuadrant(opaque, visible, -1, 1, -1, 1, 1, 1);
+    scanQuadrant(opaque, visible, 1, 1, -1, 1, 1, 1);
+    scanQuadrant(opaqueColumns, visibleColumns, 1, 1, -1, 1, 1, 1);
+    scanQuadrant(opaqueColumns, visibleColumns, -1, 1, -1, 1, 1, 1);
+    transpose(visibleColumns);
+    for (int y = 0; y < FOV_SIDE; y++) visible[y] |= visibleColumns[y];
+
+    markExplored();
+}
+
+bool fovUpdate(const Player* player) {
+    int tileX = (player->x + TILE_SIZE / 2) / TILE_SIZE;
+    int tileY = (player->y + TILE_SIZE / 2) / TILE_SIZE;
+    if (!dirty && revision == tileRevision && tileX == centerX && tileY == centerY)
+        return false;
+
+    fovRecompute(player);
+    return true;
+}
+
+bool fovVisible(int tileX, int tileY) {
+    int x = tileX - originX, y = tileY - originY;
+    if (x < 0 || y < 0 || x >= FOV_SIDE || y >= FOV_SIDE) return false;
+    return (visible[y] >> x) & 1;
+}
+
+bool fovExplored(int tileX, int tileY) {
+    if (tileX < 0 || tileY < 0 || tileY >= exploredHeight || tileX >= exploredWords * 64) return false;
+    const uint64_t* row = explored[tileY];
+    return row && ((row[tileX >> 6] >> (tileX & 63)) & 1);
+}
@@ -0,0 +1,41 @@
+#ifndef FOV_H
+#define FOV_H
+
+#include <stdbool.h>
+#include "game.h"
+
+// Champ de vision du joueur et brouillard de guerre. Ombres portées
+// symétriques (symmetric shadowcasting) depuis la tuile du joueur, octant
+// par octant, avec des pentes rationnelles exactes : si A voit B, B voit A.
+// Murs et portes fermées arrêtent la vue ; caisses et zombies non.
+//
+// La vue est calculée dans une fenêtre de FOV_RADIUS tuiles autour du
+// joueur, une ligne par mot de 64 bits : le coût ne dépend pas de la taille
+// de la salle. Les tuiles déjà vues (« explorées ») sont gardées dans un
+// bitset par ligne de la salle, chaque ligne allouée à sa première tuile
+// vue. Recalcul seulement si le joueur change de tuile, si une porte
+// s'ouvre ou si la grille change.
+//
+// Le rendu masque ce qui n'est pas en vue et les zombies ne se lancent à la
+// poursuite du joueur qu'après l'avoir aperçu (ENTITY_ALERTED).
+
+#define FOV_RADIUS 24               // en tuiles, au plus 31 : une ligne tient dans un mot
+
+// Incrémenté à chaque recalcul de la vue (rendu de la couche statique)
+extern unsigned fovRevision;
+
+// Une porte s'est ouverte : recalcul au prochain fovUpdate
+void fovInvalidate(void);
+// Nouvelle salle (applyRoom) : plus rien d'exploré
+void fovReset(void);
+// Recalcule la vue si nécessaire ; true si elle a été recalculée
+bool fovUpdate(const Player* player);
+// Force le recalcul (benchmarks)
+void fovRecompute(const Player* player);
+
+// Tuile en vue du joueur ; false hors de la salle
+bool fovVisible(int tileX, int tileY);
+// Tuile déjà vue depuis l'arrivée dans la salle
+bool fovExplored(int tileX, int tileY);
+
+#endif
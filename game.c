@@ -0,0 +1,710 @@
+#include "game.h"
+#include "collide.h"
+#include "flow.h"
+#include "fov.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include "prefetch.h"
+#include "profile.h"
+#include "puzzle.h"
+#include "roomcache.h"
+#include "trigger.h"
+#include "world.h"
+#include "roomfile.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int currentMapX = 1;
+int currentMapY = 1;
+
+EntityPool enemies;
+EntityPool keys;
+EntityPool doors;
+EntityPool boxes;
+EntityPool switches;
+
+int keysCollected = 0;
+
+TileMap tileMap;
+unsigned tileRevision = 0;
+unsigned stateRevision = 0;
+
+int playerStartX = -1;
+int playerStartY = -1;
+
+
+bool initWorld(void) {
+    if (!worldLoad(WORLD_MANIFEST)) {
+        return false;
+    }
+
+    worldStart(&currentMapX, &currentMapY);
+    return true;
+}
+
+void (*roomLoadedHook)(int x, int y, const Room* room) = NULL;
+
+// Vrai quand les globales contiennent la salle (currentMapX, currentMapY)
+static bool roomLoaded = false;
+// Dernière salle lue depuis son fichier (loadMap, loadMapFromWorld)
+static Room fileRoom;
+
+void loadMapFromWorld(int x, int y) {
+    const WorldRoom* room = worldFind(x, y);
+    if (!room)
+        return;
+
+    // L'état de la salle quittée est gardé pour le prochain passage
+    if (roomLoaded) {
+        roomCacheSave(currentMapX, currentMapY);
+    }
+
+    currentMapX = x;
+    currentMapY = y;
+    roomLoaded = true;
+
+    // Salle déjà visitée : son état est restauré tel quel
+    // Sinon, salle déjà préparée par le thread de préchargement : aucune E/S ici
+    const Room* cached = roomCacheFind(x, y);
+    const Room* staged = cached ? NULL : prefetchAcquire(x, y);
+    const Room* fresh = staged;
+    if (!cached && !staged && readRoom(room->filename, &fileRoom)) {
+        fresh = &fileRoom;
+    }
+
+    // Le crochet voit la salle telle que lue, avant que applyRoom n'ouvre
+    // des portes ou ne marque des interrupteurs
+    if (fresh && roomLoadedHook) roomLoadedHook(x, y, fresh);
+    if (cached) {
+        applyRoom(cached);
+    } else if (fresh) {
+        applyRoom(fresh);
+    }
+    if (staged) prefetchRelease(staged);
+    LOG_DEBUG(LOG_ROOM, "filename: %s", room->filename);
+
+    prefetchNeighbours();
+}
+
+void restoreRoom(int x, int y, const Room* room) {
+    currentMapX = x;
+    currentMapY = y;
+    roomLoaded = true;
+    applyRoom(room);
+    prefetchNeighbours();
+}
+
+// Demande le préchargement des (au plus 4) salles adjacentes à la salle courante
+void prefetchNeighbours(void) {
+    static const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, -1 }, { 0, 1 } };
+    PrefetchRequest requests[4];
+    int count = 0;
+
+    for (int i = 0; i < 4; i++) {
+        int nx = currentMapX + offsets[i][0];
+        int ny = currentMapY + offsets[i][1];
+        const WorldRoom* room = worldFind(nx, ny);
+        if (!room || roomCacheContains(nx, ny)) continue;
+
+        requests[count++] = (PrefetchRequest){ nx, ny, room->filename };
+    }
+
+    prefetchWant(requests, count);
+}
+
+bool readRoom(const char* filename, Room* room) {
+    if (readRoomCompiled(filename, room)) {
+        return true;
+    }
+
+    // Un .czr refusé n'est pas relu comme du texte
+    const char* dot = strrchr(filename, '.');
+    if (dot && strcmp(dot, ROOMFILE_EXTENSION) == 0) {
+        return false;
+    }
+    return readRoomText(filename, room);
+}
+
+// La salle remplace entièrement la précédente
+void applyRoom(const Room* room) {
+    if (!tileMapCopy(&tileMap, &room->tiles)) {
+        LOG_ERROR(LOG_SYSTEM, "Mémoire insuffisante pour la grille de la salle");
+        tileMapInit(&tileMap, 1, 1);
+    }
+    tileRevision++;
+
+    if (room->playerStartX >= 0 && room->playerStartY >= 0) {
+        playerStartX = room->playerStartX;
+        playerStartY = room->playerStartY;
+    }
+
+    // Colonnes recopiées dans la mémoire déjà allouée, agrandie au besoin
+    bool copied = entityCopy(&enemies, &room->enemies) &&
+                  entityCopy(&keys, &room->keys) &&
+                  entityCopy(&doors, &room->doors) &&
+                  entityCopy(&boxes, &room->boxes) &&
+                  entityCopy(&switches, &room->switches);
+    if (!copied) {
+        LOG_ERROR(LOG_SYSTEM, "Mémoire insuffisante pour les entités de la salle");
+        entityClear(&enemies);
+        entityClear(&keys);
+        entityClear(&doors);
+        entityClear(&boxes);
+        entityClear(&switches);
+    }
+    linkCount = room->linkCount;
+    memcpy(links, room->links, linkCount * sizeof(Link));
+
+    occupancyRebuild();
+    triggerRebuild();
+    fovReset();
+    stateRevision++;
+}
+
+// Inverse de applyRoom : copie l'état courant de la salle
+void captureRoom(Room* room) {
+    tileMapCopy(&room->tiles, &tileMap);
+    // Le point de départ ne sert qu'au lancement de la partie
+    room->playerStartX = -1;
+    room->playerStartY = -1;
+
+    entityCopy(&room->enemies, &enemies);
+    entityCopy(&room->keys, &keys);
+    entityCopy(&room->doors, &doors);
+    entityCopy(&room->boxes, &boxes);
+    entityCopy(&room->switches, &switches);
+    room->linkCount = linkCount;
+    memcpy(room->links, links, linkCount * sizeof(Link));
+}
+
+void roomClear(Room* room) {
+    room->playerStartX = -1;
+    room->playerStartY = -1;
+    entityClear(&room->enemies);
+    entityClear(&room->keys);
+    entityClear(&room->doors);
+    entityClear(&room->boxes);
+    entityClear(&room->switches);
+    room->linkCount = 0;
+}
+
+void roomFree(Room* room) {
+    tileMapFree(&room->tiles);
+    entityFree(&room->enemies);
+    entityFree(&room->keys);
+    entityFree(&room->doors);
+    entityFree(&room->boxes);
+    entityFree(&room->switches);
+    memset(room, 0, sizeof(*room));
+}
+
+bool loadMap(const char* filename) {
+    if (!readRoom(filename, &fileRoom)) {
+        return false;
+    }
+
+    applyRoom(&fileRoom);
+    return true;
+}
+
+// Une case de la grille texte : la tuile dans row[x], l'entité éventuelle dans room
+static void parseRoomCell(Room* room, char c, int x, int y, uint8_t* row) {
+    switch (c) {
+        case '.':
+            row[x] = TILE_GROUND;
+            break;
+        case '#':
+            row[x] = TILE_WALL;
+            break;
+        case 'P':
+            row[x] = TILE_GROUND;
+            room->playerStartX = x;
+            room->playerStartY = y;
+            break;
+        case 'E':
+            row[x] = TILE_GROUND;
+            entityAdd(&room->enemies, x * TILE_SIZE, y * TILE_SIZE, 0);
+            break;
+        case 'K': {
+            // La n-ième clé ouvre la n-ième porte
+            row[x] = TILE_GROUND;
+            int key = entityAdd(&room->keys, x * TILE_SIZE, y * TILE_SIZE, 0);
+            if (key >= 0 && key <= INT16_MAX) room->keys.target[key] = (int16_t)key;
+            break;
+        }
+        case 'D':
+            row[x] = TILE_GROUND;
+            entityAdd(&room->doors, x * TILE_SIZE, y * TILE_SIZE, 0);
+            break;
+        case 'C':
+            row[x] = TILE_GROUND;
+            entityAdd(&room->boxes, x * TILE_SIZE, y * TILE_SIZE, ENTITY_ACTIVE);
+            break; 
+            
+        case 'S':    
+            row[x] = TILE_GROUND;
+            entityAdd(&room->switches, x * TILE_SIZE, y * TILE_SIZE, ENTITY_ACTIVE);
+            break;
+        default:
+            LOG_WARN(LOG_ROOM, "Caractère inconnu '%c' à (%d, %d)", c, y, x);
+            row[x] = TILE_GROUND;
+            break;
+    }
+}
+
+bool readRoomGlyphs(uint8_t* cells, int width, int height, Room* room) {
+    roomClear(room);
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = cells + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            parseRoomCell(room, (char)row[x], x, y, row);
+        }
+    }
+    return tileMapLoadRows(&room->tiles, cells, width, height);
+}
+
+// Lecture d'une salle texte dans une structure autonome (aucun état global).
+// La grille peut avoir n'importe quelle taille : sa largeur est celle de la
+// première ligne, elle s'arrête à la première ligne vide ou de métadonnées.
+bool readRoomText(const char* filename, Room* room) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        LOG_ERROR(LOG_ROOM, "Impossible d'ouvrir %s", filename);
+        return false;
+    }
+
+    roomClear(room);
+
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    uint8_t* rows = NULL;
+    size_t rowsCapacity = 0;
+    int width = 0, height = 0;
+    bool gridDone = false;
+    bool ok = true;
+
+    ssize_t length;
+    for (int lineNumber = 1; (length = getline(&line, &lineCapacity, file)) >= 0; lineNumber++) {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+
+        // Métadonnées après la grille : mécanismes interrupteurs → portes
+        if (line[0] == '@') {
+            gridDone = true;
+            if (!triggerParseLink(line, room)) {
+                LOG_WARN(LOG_ROOM, "%s:%d : métadonnée ignorée : %s", filename, lineNumber, line);
+            }
+            continue;
+        }
+        if (length == 0 || gridDone) {
+            gridDone = height > 0;
+            continue;
+        }
+
+        if (width == 0) {
+            width = length < MAX_MAP_SIDE ? (int)length : MAX_MAP_SIDE;
+        }
+        if (length < width) {
+            LOG_WARN(LOG_ROOM, "Ligne %d trop courte : %zd caractères (%d attendus)", lineNumber, length, width);
+            ok = false;
+            break;
+        }
+        if (height >= MAX_MAP_SIDE) {
+            LOG_WARN(LOG_ROOM, "%s : plus de %d lignes", filename, MAX_MAP_SIDE);
+            ok = false;
+            break;
+        }
+
+        if ((size_t)(height + 1) * width > rowsCapacity) {
+            size_t capacity = rowsCapacity ? rowsCapacity * 2 : (size_t)width * 32;
+            uint8_t* grown = realloc(rows, capacity);
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            rows = grown;
+            rowsCapacity = capacity;
+        }
+
+        uint8_t* row = rows + (size_t)height * width;
+        for (int x = 0; x < width; x++) {
+            parseRoomCell(room, line[x], x, height, row);
+        }
+        height++;
+    }
+    fclose(file);
+    free(line);
+
+    if (ok && height == 0) {
+        LOG_ERROR(LOG_ROOM, "%s : aucune ligne de grille", filename);
+        ok = false;
+    }
+    if (ok && !tileMapLoadRows(&room->tiles, rows, width, height)) {
+        LOG_ERROR(LOG_ROOM, "%s : grille de %d × %d impossible à allouer", filename, width, height);
+        ok = false;
+    }
+    free(rows);
+
+    return ok;
+}
+
+void setTile(int x, int y, int value) {
+    if (x < 0 || x >= tileMap.width || y < 0 || y >= tileMap.height)
+        return;
+
+    if (tileMapGet(&tileMap, x, y) != value) {
+        tileMapSet(&tileMap, x, y, (uint8_t)value);
+        tileRevision++;
+        stateRevision++;
+    }
+}
+
+bool isBlockedAt(int x, int y) {
+    // Hors de la grille, tileMapGet renvoie un mur
+    return tileMapGet(&tileMap, x / TILE_SIZE, y / TILE_SIZE) == TILE_WALL;
+}
+
+bool isCollision(int x, int y, int size) {
+    return isBlockedAt(x, y) ||
+           isBlockedAt(x + size - 1, y) ||
+           isBlockedAt(x, y + size - 1) ||
+           isBlockedAt(x + size - 1, y + size - 1);
+}
+
+bool checkCollision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2) {
+    return !(x1 + w1 <= x2 || x1 >= x2 + w2 || y1 + h1 <= y2 || y1 >= y2 + h2);
+}
+
+// Les salles voisines n'ont pas forcément la même taille
+static void clampToRoom(Player* player) {
+    int maxX = (tileMap.width - 1) * TILE_SIZE;
+    int maxY = (tileMap.height - 1) * TILE_SIZE;
+    if (player->x > maxX) player->x = maxX;
+    if (player->y > maxY) player->y = maxY;
+}
+
+void movePlayer(Player* player, int dx, int dy) {
+    PROFILE_ZONE(PROFILE_MOVE_PLAYER);
+    int newX = player->x + dx;
+    int newY = player->y + dy;
+
+    int hits[OCCUPANCY_MAX_HITS];
+    int hitCount = occupancyQuery(OCC_DOOR, newX, newY, hits);
+    for (int h = 0; h < hitCount; h++) {
+        if (!(doors.flags[hits[h]] & ENTITY_OPEN)) {
+            // Collision avec une porte FERMÉE
+            LOG_DEBUG(LOG_GAME, "Bloqué par une porte fermée !");
+            return; // Ne pas bouger
+        }
+    }
+
+    // Vérifie s’il y a une caisse
+    if (occupancyQuery(OCC_BOX, newX, newY, hits) > 0) {
+        int i = hits[0];
+
+        // Coordonnées de destination de la caisse
+        int boxNewX = boxes.x[i] + dx;
+        int boxNewY = boxes.y[i] + dy;
+
+        // Vérifie si la caisse peut être poussée (pas de mur ni autre caisse)
+        if (!isCollision(boxNewX, boxNewY, TILE_SIZE)) {
+            int blockers[OCCUPANCY_MAX_HITS];
+            int blockerCount = occupancyQuery(OCC_BOX, boxNewX, boxNewY, blockers);
+            bool boxBlocked = blockerCount > 1 || (blockerCount == 1 && blockers[0] != i);
+
+            if (!boxBlocked) {
+                // Déplace la caisse et le joueur
+                occupancyMove(OCC_BOX, i, boxes.x[i], boxes.y[i], boxNewX, boxNewY);
+                triggerBoxMoved(boxes.x[i], boxes.y[i], boxNewX, boxNewY);
+                flowBoxMoved(boxes.x[i], boxes.y[i], boxNewX, boxNewY);
+                boxes.x[i] = boxNewX;
+                boxes.y[i] = boxNewY;
+                stateRevision++;
+                // Caisse arrivée sur une tuile : la salle peut-elle encore être terminée ?
+                if (boxNewX % TILE_SIZE == 0 && boxNewY % TILE_SIZE == 0) puzzleBoxPushed(i);
+                player->x = newX;
+                player->y = newY;
+                return;
+            }
+        }
+
+        // Sinon, blocage : le joueur ne bouge pas
+        return;
+    }
+
+
+    // Détection de direction
+    if (dy < 0) player->dir = DIR_UP;
+    else if (dy > 0) player->dir = DIR_DOWN;
+    else if (dx < 0) player->dir = DIR_LEFT;
+    else if (dx > 0) player->dir = DIR_RIGHT;
+
+
+    // Transition droite
+    if (newX + TILE_SIZE > tileMap.width * TILE_SIZE) {
+        if (worldFind(currentMapX + 1, currentMapY)) {
+            loadMapFromWorld(currentMapX + 1, currentMapY);
+            player->x = 0;
+            clampToRoom(player);
+            return;
+        } else {
+            newX = tileMap.width * TILE_SIZE - TILE_SIZE; // blocage
+        }
+    }
+
+    // Transition gauche
+    if (newX < 0) {
+        if (worldFind(currentMapX - 1, currentMapY)) {
+            loadMapFromWorld(currentMapX - 1, currentMapY);
+            player->x = (tileMap.width - 1) * TILE_SIZE;
+            clampToRoom(player);
+            return;
+        } else {
+            newX = 0;
+        }
+    }
+
+    // Transition haut
+    if (newY < 0) {
+        if (worldFind(currentMapX, currentMapY - 1)) {
+            loadMapFromWorld(currentMapX, currentMapY - 1);
+            player->y = (tileMap.height - 1) * TILE_SIZE;
+            clampToRoom(player);
+            return;
+        } else {
+            newY = 0;
+        }
+    }
+
+    // Transition bas
+    if (newY + TILE_SIZE > tileMap.height * TILE_SIZE) {
+        if (worldFind(currentMapX, currentMapY + 1)) {
+            loadMapFromWorld(currentMapX, currentMapY + 1);
+            player->y = 0;
+            clampToRoom(player);
+            return;
+        } else {
+            newY = tileMap.height * TILE_SIZE - TILE_SIZE;
+        }
+    }
+
+    // Déplacement horizontal
+    if (!isCollision(newX, player->y, TILE_SIZE)) {
+        player->x = newX;
+    }
+
+    // Déplacement vertical
+    if (!isCollision(player->x, newY, TILE_SIZE)) {
+        player->y = newY;
+    }
+
+      // Animation
+    if (dx != 0 || dy != 0) {
+        player->frameTimer++;
+        if (player->frameTimer >= ANIM_SPEED) {
+            player->frame = (player->frame + 1) % FRAME_COUNT;
+            player->frameTimer = 0;
+        }
+    } else {
+        player->frame = 0; // frame fixe si inactif
+    }
+}
+
+void activateSwitch(void) {
+    PROFILE_ZONE(PROFILE_ACTIVATE);
+    LOG_DEBUG(LOG_GAME, "Activate Swich");
+
+    // Les interrupteurs suivent déjà les caisses : simple resynchronisation
+    triggerRebuild();
+}
+
+void collectKeys(Player* player) {
+    int hits[OCCUPANCY_MAX_HITS];
+    int hitCount = occupancyQuery(OCC_KEY, player->x, player->y, hits);
+
+    // Les clés ramassées sont supprimées : indices décroissants, pour que
+    // la dernière clé déplacée dans le trou ne soit pas l'une des suivantes
+    for (int h = hitCount - 1; h >= 0; h--) {
+        int i = hits[h];
+        keysCollected++;
+        LOG_INFO(LOG_GAME, "Clé ramassée ! (%d ramassées, %d restantes)", keysCollected, keys.count - 1);
+
+        int doorToOpen = keys.target[i];
+        if (doorToOpen >= 0 && doorToOpen < doors.count) {
+            doors.flags[doorToOpen] |= ENTITY_OPEN;
+            flowDoorOpened(doors.x[doorToOpen], doors.y[doorToOpen]);
+            fovInvalidate();
+            LOG_INFO(LOG_GAME, "Porte %d ouverte par clé %d !", doorToOpen, i);
+        }
+
+        occupancyRemove(OCC_KEY, i);
+        entityRemove(&keys, i);
+        stateRevision++;
+    }
+}
+
+// Vrai si au moins un zombie a bougé pendant moveEnemies
+static atomic_bool enemiesMoved;
+
+// Chaque zombie ne lit que le champ de flux et la vue du joueur et n'écrit
+// que ses propres colonnes : les tranches sont indépendantes. Un zombie
+// reste immobile tant qu'il n'a pas aperçu le joueur : la vue est
+// symétrique, la tuile du zombie en vue du joueur suffit.
+static void moveEnemyRange(void* context, int begin, int end, int chunk) {
+    (void)context;
+    (void)chunk;
+    int moved = 0;
+    int* x = enemies.x;
+    int* y = enemies.y;
+    int16_t* stepX = enemies.dx;
+    int16_t* stepY = enemies.dy;
+    uint8_t* flags = enemies.flags;
+
+    for (int i = begin; i < end; i++) {
+        // Nouvelle direction seulement une fois la tuile atteinte
+        if (x[i] % TILE_SIZE == 0 && y[i] % TILE_SIZE == 0) {
+            int dx = 0, dy = 0;
+            if (!(flags[i] & ENTITY_ALERTED) && fovVisible(x[i] / TILE_SIZE, y[i] / TILE_SIZE))
+                flags[i] |= ENTITY_ALERTED;
+            if (flags[i] & ENTITY_ALERTED) flowDirection(x[i] / TILE_SIZE, y[i] / TILE_SIZE, &dx, &dy);
+            stepX[i] = (int16_t)(dx * ENEMY_SPEED);
+            stepY[i] = (int16_t)(dy * ENEMY_SPEED);
+            moved |= dx | dy;
+        } else {
+            // Entre deux tuiles : forcément en marche
+            moved = 1;
+        }
+
+        x[i] += stepX[i];
+        y[i] += stepY[i];
+    }
+    if (moved) atomic_store_explicit(&enemiesMoved, true, memory_order_relaxed);
+}
+
+void moveEnemies(void) {
+    PROFILE_ZONE(PROFILE_ENEMIES);
+    atomic_store_explicit(&enemiesMoved, false, memory_order_relaxed);
+    jobsParallelFor(enemies.count, ENEMY_GRAIN, moveEnemyRange, NULL);
+    if (atomic_load_explicit(&enemiesMoved, memory_order_relaxed)) stateRevision++;
+}
+
+void checkEnemyContacts(Player* player) {
+    int previous = player->contacts;
+    player->contacts = collideList(player->x, player->y, TILE_SIZE, TILE_SIZE,
+                                   enemies.x, enemies.y, enemies.count, TILE_SIZE, TILE_SIZE, NULL, 0);
+
+    if (player->contacts > 0 && previous == 0) {
+        LOG_INFO(LOG_GAME, "Le joueur est au contact de %d zombie(s) !", player->contacts);
+    }
+}
+
+bool gameStart(Player* player) {
+    if (!initWorld()) {
+        LOG_ERROR(LOG_WORLD, "Monde introuvable ou vide : %s", WORLD_MANIFEST);
+        return false;
+    }
+    // Nouvelle partie : les salles repartent de leur fichier
+    roomCacheClear();
+    roomLoaded = false;
+    loadMapFromWorld(currentMapX, currentMapY);
+
+    if (playerStartX == -1 || playerStartY == -1) {
+        LOG_ERROR(LOG_GAME, "Position du joueur non définie dans la carte !");
+        return false;
+    }
+
+    player->x = playerStartX * TILE_SIZE;
+    player->y = playerStartY * TILE_SIZE;
+    player->prevX = player->x;
+    player->prevY = player->y;
+    player->frame = 0;       // frame 1 (index 0)
+    player->dir = DIR_DOWN;  // direction vers le bas
+    player->frameTimer = 0;
+    player->contacts = 0;
+    return true;
+}
+
+void gameTick(Player* player, unsigned input) {
+    PROFILE_ZONE(PROFILE_TICK);
+    int mapX = currentMapX, mapY = currentMapY;
+    Player before = *player;
+
+    player->prevX = player->x;
+    player->prevY = player->y;
+    for (int i = 0; i < boxes.count; i++) {
+        boxes.prevX[i] = boxes.x[i];
+        boxes.prevY[i] = boxes.y[i];
+    }
+
+    if (input & INPUT_ACTIVATE) {
+        activateSwitch();
+    }
+
+    int dx = 0, dy = 0;
+    if (input & INPUT_UP)    dy -= PLAYER_SPEED;
+    if (input & INPUT_DOWN)  dy += PLAYER_SPEED;
+    if (input & INPUT_LEFT)  dx -= PLAYER_SPEED;
+    if (input & INPUT_RIGHT) dx += PLAYER_SPEED;
+
+    // Un axe à la fois : les caisses ne sont poussées qu'en ligne droite
+    if (dx != 0) {
+        movePlayer(player, dx, 0);
+    }
+    if (dy != 0) {
+        movePlayer(player, 0, dy);
+    }
+
+    // Changement de salle : pas d'interpolation à travers l'écran
+    if (mapX != currentMapX || mapY != currentMapY) {
+        player->prevX = player->x;
+        player->prevY = player->y;
+    }
+
+    collectKeys(player);
+
+    fovUpdate(player);
+    flowUpdate(player);
+    moveEnemies();
+    checkEnemyContacts(player);
+
+    if (player->x != before.x || player->y != before.y || player->prevX != before.prevX ||
+        player->prevY != before.prevY || player->frame != before.frame || player->dir != before.dir) {
+        stateRevision++;
+    }
+}
+
+// FNV-1a sur des mots de 32 bits
+static uint32_t hashWord(uint32_t hash, uint32_t value) {
+    return (hash ^ value) * 16777619u;
+}
+
+static uint32_t hashPool(uint32_t hash, const EntityPool* pool) {
+    hash = hashWord(hash, (uint32_t)pool->count);
+    for (int i = 0; i < pool->count; i++) {
+        hash = hashWord(hash, (uint32_t)pool->x[i]);
+        hash = hashWord(hash, (uint32_t)pool->y[i]);
+        hash = hashWord(hash, pool->flags[i]);
+    }
+    return hash;
+}
+
+uint32_t gameStateHash(const Player* player) {
+    uint32_t hash = 2166136261u;
+    hash = hashWord(hash, (uint32_t)currentMapX);
+    hash = hashWord(hash, (uint32_t)currentMapY);
+    hash = hashWord(hash, (uint32_t)player->x);
+    hash = hashWord(hash, (uint32_t)player->y);
+    hash = hashWord(hash, (uint32_t)player->dir);
+    hash = hashWord(hash, (uint32_t)player->frame);
+    hash = hashWord(hash, (uint32_t)player->contacts);
+    hash = hashWord(hash, (uint32_t)keysCollected);
+    hash = hashPool(hash, &enemies);
+    hash = hashPool(hash, &keys);
+    hash = hashPool(hash, &doors);
+    hash = hashPool(hash, &boxes);
+    hash = hashPool(hash, &switches);
+    return hash;
+}
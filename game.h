@@ -0,0 +1,155 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "entity.h"
+#include "log.h"
+#include "tilemap.h"
+
+// Logique du jeu, indépendante de SDL : carte, entités, déplacements.
+// Utilisée par le jeu (main.c) et, sans fenêtre, par les benchmarks.
+
+#define TILE_SIZE 32
+#define PLAYER_SPEED 4
+
+#define FRAME_COUNT 9
+#define ANIM_SPEED 8
+
+#define MAX_LINKS 16
+#define MAX_LINK_INPUTS 8
+#define MAX_LINK_OUTPUTS 8
+#define ENEMY_GRAIN 1024        // zombies par tâche (jobs.h)
+
+typedef enum {
+    DIR_UP = 0,
+    DIR_LEFT = 1,
+    DIR_DOWN = 2,
+    DIR_RIGHT = 3,
+} Direction;
+
+typedef struct {
+    int x, y;
+    int prevX, prevY;     // position au tick précédent (interpolation)
+    int frame;            // 0 → 8
+    int frameTimer;
+    Direction dir;        // Direction actuelle
+    int contacts;         // zombies qui le touchent (dernier tick)
+} Player;
+
+typedef enum {
+    LINK_OR = 0,        // un interrupteur suffit
+    LINK_AND = 1,       // tous les interrupteurs doivent être enfoncés
+} LinkOp;
+
+// Mécanisme décrit dans les métadonnées de la salle : quand la condition sur
+// ses interrupteurs devient vraie, ses portes s'ouvrent (et le restent).
+typedef struct {
+    uint8_t op;                             // LinkOp
+    uint8_t switchCount;
+    uint8_t doorCount;
+    bool satisfied;
+    uint8_t switches[MAX_LINK_INPUTS];      // indices : seuls les 256 premiers sont reliables
+    uint8_t doors[MAX_LINK_OUTPUTS];
+} Link;
+
+// Contenu d'une salle, indépendant de l'état global : produit par les
+// lecteurs (texte ou compilé), éventuellement sur un autre thread, puis
+// installé par applyRoom.
+typedef struct {
+    TileMap tiles;                      // taille quelconque
+    int playerStartX, playerStartY;     // -1 si pas de 'P'
+    EntityPool enemies;                 // dx, dy
+    EntityPool keys;                    // target : porte ouverte
+    EntityPool doors;                   // ENTITY_OPEN
+    EntityPool boxes;                   // ENTITY_ACTIVE, prevX, prevY
+    EntityPool switches;                // ENTITY_ACTIVE, ENTITY_TRIGGERED, occupants, links
+    Link links[MAX_LINKS];
+    int linkCount;
+} Room;
+
+// Entrées d'un tick de simulation (touches maintenues + actions ponctuelles)
+typedef enum {
+    INPUT_UP       = 1 << 0,
+    INPUT_DOWN     = 1 << 1,
+    INPUT_LEFT     = 1 << 2,
+    INPUT_RIGHT    = 1 << 3,
+    INPUT_ACTIVATE = 1 << 4,
+} InputFlags;
+
+extern int currentMapX;
+extern int currentMapY;
+
+// Entités de la salle courante (entity.h), mêmes colonnes que dans Room
+extern EntityPool enemies;
+extern EntityPool keys;                 // les clés ramassées sont supprimées
+extern EntityPool doors;
+extern EntityPool boxes;
+extern EntityPool switches;
+extern int keysCollected;
+extern Link links[MAX_LINKS];
+extern int linkCount;
+
+// Grille de la salle courante (TILE_GROUND / TILE_WALL), de taille quelconque
+extern TileMap tileMap;
+// Incrémenté à chaque modification de la grille (chargement, setTile)
+extern unsigned tileRevision;
+// Incrémenté à chaque changement visible de la salle : joueur, caisses,
+// portes, interrupteurs, clés, zombies, chargement. Le rendu ne redessine
+// l'image que si ce compteur a bougé (ou pendant une interpolation).
+extern unsigned stateRevision;
+
+extern int playerStartX;
+extern int playerStartY;
+
+// Charge le manifeste du monde (world.h) et place la salle courante au départ
+bool initWorld(void);
+void loadMapFromWorld(int x, int y);
+// Appelé par loadMapFromWorld avec une salle lue depuis son fichier (ou
+// préchargée), juste avant son installation ; NULL par défaut
+extern void (*roomLoadedHook)(int x, int y, const Room* room);
+// Installe la salle (x, y) dans l'état donné (sauvegarde), sans garder
+// l'état de la salle quittée
+void restoreRoom(int x, int y, const Room* room);
+// Demande au préchargeur les salles voisines de la salle courante
+void prefetchNeighbours(void);
+// Lecture sans effet de bord : version compilée (.czr) si elle est à jour, sinon le texte
+bool readRoom(const char* filename, Room* room);
+bool readRoomText(const char* filename, Room* room);
+// Grille de glyphes déjà en mémoire (width * height, ligne par ligne), comme
+// dans un fichier texte ; convertie en tuiles sur place
+bool readRoomGlyphs(uint8_t* cells, int width, int height, Room* room);
+// Remplace la salle courante (grille et entités)
+void applyRoom(const Room* room);
+// Vide une salle en gardant sa mémoire (lecteurs)
+void roomClear(Room* room);
+// Libère la grille et les entités d'une salle et la remet à zéro
+void roomFree(Room* room);
+// Copie la salle courante avec son état (caisses, portes, clés, interrupteurs)
+void captureRoom(Room* room);
+bool loadMap(const char* filename);
+void setTile(int x, int y, int value);
+
+bool isBlockedAt(int x, int y);
+bool isCollision(int x, int y, int size);
+bool checkCollision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2);
+
+void movePlayer(Player* player, int dx, int dy);
+// Réévalue tous les interrupteurs (touche A) ; en jeu, les déplacements
+// de caisses les mettent déjà à jour au fil de l'eau (voir trigger.h)
+void activateSwitch(void);
+void collectKeys(Player* player);
+// Les zombies suivent le champ de flux vers le joueur (flow.h), en
+// parallèle par tranches de ENEMY_GRAIN (jobs.h)
+void moveEnemies(void);
+// Compte les zombies qui touchent le joueur (collide.h)
+void checkEnemyContacts(Player* player);
+
+// Charge la salle de départ et y place le joueur ; false si pas de 'P'
+bool gameStart(Player* player);
+// Un tick de simulation à pas fixe
+void gameTick(Player* player, unsigned input);
+// Empreinte de l'état de la partie : salle, joueur et entités (replay.h)
+uint32_t gameStateHash(const Player* player);
+
+#endif
@@ -0,0 +1,210 @@
+#include "jobs.h"
+#include "game.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEQUE_MASK (JOBS_DEQUE_SIZE - 1)
+
+typedef struct {
+    atomic_int remaining;           // tranches pas encore terminées
+} Batch;
+
+typedef struct {
+    JobRange fn;
+    void* context;
+    int begin, end, chunk;
+    Batch* batch;
+} Job;
+
+// File de Chase-Lev de taille fixe : bottom n'est modifié que par le
+// propriétaire, top avance par compare-and-swap (vol ou dernière tâche)
+typedef struct {
+    atomic_long top;
+    atomic_long bottom;
+    Job jobs[JOBS_DEQUE_SIZE];
+} Deque;
+
+static Deque deques[JOBS_MAX_THREADS];
+static pthread_t threads[JOBS_MAX_THREADS];
+static int threadCount = 1;
+static atomic_bool running = false;
+
+// Réveil des threads inoccupés : epoch change à chaque lot publié
+static pthread_mutex_t idleLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idleWake = PTHREAD_COND_INITIALIZER;
+static unsigned epoch = 0;
+
+static _Thread_local int threadIndex = 0;     // 0 : thread principal
+
+
+static bool dequePush(Deque* deque, const Job* job) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOBS_DEQUE_SIZE) return false;
+
+    deque->jobs[bottom & DEQUE_MASK] = *job;
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+static bool dequePop(Deque* deque, Job* job) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    *job = deque->jobs[bottom & DEQUE_MASK];
+    if (top == bottom) {
+        // Dernière tâche : course avec un voleur
+        bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                           memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+static bool dequeSteal(Deque* deque, Job* job) {
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return false;
+
+    *job = deque->jobs[top & DEQUE_MASK];
+    return atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed);
+}
+
+static void runJob(const Job* job) {
+    job->fn(job->context, job->begin, job->end, job->chunk);
+    atomic_fetch_sub_explicit(&job->batch->remaining, 1, memory_order_release);
+}
+
+// Une tâche : la sienne d'abord, sinon volée aux autres en partant du voisin
+static bool findJob(Job* job) {
+    if (dequePop(&deques[threadIndex], job)) return true;
+
+    for (int i = 1; i < threadCount; i++) {
+        int victim = (threadIndex + i) % threadCount;
+        if (dequeSteal(&deques[victim], job)) return true;
+    }
+    return false;
+}
+
+static void* workerMain(void* arg) {
+    threadIndex = (int)(intptr_t)arg;
+
+    while (atomic_load_explicit(&running, memory_order_acquire)) {
+        pthread_mutex_lock(&idleLock);
+        unsigned seen = epoch;
+        pthread_mutex_unlock(&idleLock);
+
+        Job job;
+        while (findJob(&job)) {
+            runJob(&job);
+        }
+
+        // Rien à faire : attente d'un nouveau lot
+        pthread_mutex_lock(&idleLock);
+        while (epoch == seen && atomic_load_explicit(&running, memory_order_relaxed)) {
+            pthread_cond_wait(&idleWake, &idleLock);
+        }
+        pthread_mutex_unlock(&idleLock);
+    }
+    return NULL;
+}
+
+bool jobsStart(int count) {
+    if (atomic_load(&running)) return true;
+
+    if (count <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        count = cores > 0 ? (int)cores : 1;
+    }
+    if (count > JOBS_MAX_THREADS) count = JOBS_MAX_THREADS;
+
+    memset(deques, 0, sizeof(deques));
+    threadIndex = 0;
+    threadCount = count;
+    atomic_store(&running, true);
+
+    for (int i = 1; i < threadCount; i++) {
+        if (pthread_create(&threads[i], NULL, workerMain, (void*)(intptr_t)i) != 0) {
+            LOG_ERROR(LOG_SYSTEM, "Impossible de lancer le thread de calcul %d", i);
+            threadCount = i;
+            break;
+        }
+    }
+    return true;
+}
+
+void jobsStop(void) {
+    if (!atomic_load(&running)) return;
+
+    pthread_mutex_lock(&idleLock);
+    atomic_store(&running, false);
+    epoch++;
+    pthread_cond_broadcast(&idleWake);
+    pthread_mutex_unlock(&idleLock);
+
+    for (int i = 1; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    threadCount = 1;
+}
+
+int jobsThreadCount(void) {
+    return threadCount;
+}
+
+int jobsChunkCount(int count, int grain) {
+    if (count <= 0) return 0;
+    if (grain <= 0) grain = 1;
+    return (count + grain - 1) / grain;
+}
+
+void jobsParallelFor(int count, int grain, JobRange fn, void* context) {
+    int chunks = jobsChunkCount(count, grain);
+    if (grain <= 0) grain = 1;
+
+    // Une seule tranche ou pas de threads : pas de file
+    if (chunks <= 1 || threadCount <= 1 || !atomic_load_explicit(&running, memory_order_relaxed)) {
+        for (int c = 0; c < chunks; c++) {
+            int begin = c * grain;
+            fn(context, begin, begin + grain < count ? begin + grain : count, c);
+        }
+        return;
+    }
+
+    Batch batch;
+    atomic_init(&batch.remaining, chunks);
+
+    // Empilées à l'envers : le propriétaire dépile la tranche 0 en premier
+    Deque* own = &deques[threadIndex];
+    for (int c = chunks - 1; c >= 0; c--) {
+        int begin = c * grain;
+        Job job = { fn, context, begin, begin + grain < count ? begin + grain : count, c, &batch };
+        if (!dequePush(own, &job)) runJob(&job);     // file pleine : tout de suite
+    }
+
+    pthread_mutex_lock(&idleLock);
+    epoch++;
+    pthread_cond_broadcast(&idleWake);
+    pthread_mutex_unlock(&idleLock);
+
+    // L'appelant travaille aussi, puis attend les tranches volées
+    Job job;
+    while (atomic_load_explicit(&batch.remaining, memory_order_acquire) > 0) {
+        if (findJob(&job)) runJob(&job);
+        else sched_yield();
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+
+// Système de tâches : un thread par cœur, chacun avec sa file à double
+// entrée (Chase-Lev). Le propriétaire empile et dépile par le bas, les
+// threads inoccupés volent par le haut.
+//
+// jobsParallelFor découpe [0, count) en tranches de grain éléments. Le
+// découpage ne dépend que de count et grain, jamais du nombre de threads :
+// une tâche qui écrit ses résultats par tranche (indice chunk) puis les
+// fusionne dans l'ordre des tranches donne le même résultat sur 1 ou 16 cœurs.
+
+#define JOBS_MAX_THREADS 64
+#define JOBS_DEQUE_SIZE 4096        // tâches en attente par thread (puissance de 2)
+
+typedef void (*JobRange)(void* context, int begin, int end, int chunk);
+
+// threadCount : threads au total, appelant compris (0 : un par cœur).
+// Sans jobsStart, jobsParallelFor s'exécute sur l'appelant.
+bool jobsStart(int threadCount);
+void jobsStop(void);
+int jobsThreadCount(void);
+
+// Nombre de tranches de grain éléments pour count éléments
+int jobsChunkCount(int count, int grain);
+// Exécute fn sur toutes les tranches et attend la fin ; l'appelant participe
+void jobsParallelFor(int count, int grain, JobRange fn, void* context);
+
+#endif
@@ -0,0 +1,220 @@
+#include "log.h"
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define QUEUE_MASK (LOG_QUEUE_SIZE - 1)
+
+// File bornée à plusieurs producteurs (Vyukov) : chaque case porte un
+// numéro de séquence. sequence == position : case libre pour le producteur
+// qui réserve cette position ; position + 1 : message prêt pour le thread
+// d'écriture, qui la rend libre pour le tour suivant (+ LOG_QUEUE_SIZE).
+typedef struct {
+    atomic_uint sequence;
+    uint8_t level;
+    uint8_t category;
+    uint64_t time;                  // nanosecondes, horloge monotone
+    char text[LOG_LINE_MAX];
+} LogCell;
+
+static LogCell cells[LOG_QUEUE_SIZE];
+static atomic_uint enqueuePos = 0;
+static unsigned dequeuePos = 0;     // thread d'écriture seulement
+static atomic_uint written = 0;     // messages écrits depuis logStart
+static atomic_uint dropped = 0;     // perdus, file pleine
+
+static sem_t pending;               // un jeton par message publié
+static pthread_t writer;
+static atomic_bool running = false;
+static bool exitHandler = false;
+
+static atomic_int runtimeLevel = LOG_MIN_LEVEL;
+static uint64_t startTime = 0;
+
+static const char* levelNames[] = { "DEBUG", "INFO", "WARN", "ERREUR" };
+static const char* categoryNames[LOG_CATEGORY_COUNT] = { "jeu", "salle", "monde", "système", "ressource" };
+
+
+static uint64_t monotonicNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void printLine(int level, int category, uint64_t time, const char* text) {
+    double seconds = (double)(time - startTime) * 1e-9;
+    fprintf(stderr, "[%9.3f] %-6s [%s] %s\n", seconds, levelNames[level], categoryNames[category], text);
+}
+
+// Réserve une case, y compose le message et la publie ; false si la file est pleine
+static bool enqueue(int level, LogCategory category, const char* fmt, va_list args) {
+    unsigned pos = atomic_load_explicit(&enqueuePos, memory_order_relaxed);
+    LogCell* cell;
+    for (;;) {
+        cell = &cells[pos & QUEUE_MASK];
+        unsigned sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int diff = (int)(sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&enqueuePos, memory_order_relaxed);
+        }
+    }
+
+    cell->level = (uint8_t)level;
+    cell->category = (uint8_t)category;
+    cell->time = monotonicNanoseconds();
+    vsnprintf(cell->text, sizeof(cell->text), fmt, args);
+
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    sem_post(&pending);
+    return true;
+}
+
+// Écrit les messages publiés, dans l'ordre des positions
+static void drain(void) {
+    for (;;) {
+        LogCell* cell = &cells[dequeuePos & QUEUE_MASK];
+        unsigned sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        if ((int)(sequence - (dequeuePos + 1)) < 0) break;
+
+        printLine(cell->level, cell->category, cell->time, cell->text);
+        atomic_store_explicit(&cell->sequence, dequeuePos + LOG_QUEUE_SIZE, memory_order_release);
+        dequeuePos++;
+        atomic_fetch_add_explicit(&written, 1, memory_order_release);
+    }
+
+    unsigned lost = atomic_exchange_explicit(&dropped, 0, memory_order_relaxed);
+    if (lost) {
+        char text[64];
+        snprintf(text, sizeof(text), "%u message(s) perdu(s), file pleine", lost);
+        printLine(LOG_LEVEL_WARN, LOG_SYSTEM, monotonicNanoseconds(), text);
+    }
+    fflush(stderr);
+}
+
+static void* logWriter(void* arg) {
+    (void)arg;
+
+    while (atomic_load_explicit(&running, memory_order_acquire)) {
+        sem_wait(&pending);
+        drain();
+    }
+    drain();
+    return NULL;
+}
+
+static void emitv(int level, LogCategory category, const char* fmt, va_list args) {
+    if (atomic_load_explicit(&running, memory_order_acquire)) {
+        if (!enqueue(level, category, fmt, args))
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+    } else {
+        char text[LOG_LINE_MAX];
+        vsnprintf(text, sizeof(text), fmt, args);
+        printLine(level, category, monotonicNanoseconds(), text);
+    }
+}
+
+static void emit(int level, LogCategory category, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    emitv(level, category, fmt, args);
+    va_end(args);
+}
+
+void logWrite(LogSite* site, int level, LogCategory category, const char* fmt, ...) {
+    if (level < atomic_load_explicit(&runtimeLevel, memory_order_relaxed)) return;
+
+    // Nouvelle seconde : compteur remis à zéro, messages écartés signalés
+    unsigned now = (unsigned)(monotonicNanoseconds() / 1000000000ull);
+    unsigned window = atomic_load_explicit(&site->window, memory_order_relaxed);
+    if (window != now &&
+        atomic_compare_exchange_strong_explicit(&site->window, &window, now,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        atomic_store_explicit(&site->count, 0, memory_order_relaxed);
+        unsigned suppressed = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+        if (suppressed) emit(level, category, "(%u message(s) semblable(s) écarté(s) : \"%s\")", suppressed, fmt);
+    }
+    if (atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed) >= LOG_RATE_LIMIT) {
+        atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    emitv(level, category, fmt, args);
+    va_end(args);
+}
+
+bool logStart(void) {
+    if (atomic_load(&running)) return true;
+
+    for (unsigned i = 0; i < LOG_QUEUE_SIZE; i++) {
+        atomic_init(&cells[i].sequence, i);
+    }
+    atomic_store(&enqueuePos, 0);
+    dequeuePos = 0;
+    atomic_store(&written, 0);
+    startTime = monotonicNanoseconds();
+    if (sem_init(&pending, 0, 0) != 0) return false;
+
+    atomic_store(&running, true);
+    if (pthread_create(&writer, NULL, logWriter, NULL) != 0) {
+        atomic_store(&running, false);
+        sem_destroy(&pending);
+        return false;
+    }
+
+    // Sorties anticipées (return depuis main, exit) : rien n'est perdu
+    if (!exitHandler) {
+        atexit(logStop);
+        exitHandler = true;
+    }
+    return true;
+}
+
+void logStop(void) {
+    if (!atomic_load(&running)) return;
+
+    atomic_store(&running, false);
+    sem_post(&pending);
+    pthread_join(writer, NULL);
+    sem_destroy(&pending);
+}
+
+void logFlush(void) {
+    if (!atomic_load(&running)) {
+        fflush(stderr);
+        return;
+    }
+
+    // Tout ce qui a été réservé jusqu'ici, publié puis écrit
+    unsigned target = atomic_load_explicit(&enqueuePos, memory_order_acquire);
+    while ((int)(atomic_load_explicit(&written, memory_order_acquire) - target) < 0) {
+        sched_yield();
+    }
+}
+
+void logSetLevel(int level) {
+    if (level < LOG_LEVEL_DEBUG) level = LOG_LEVEL_DEBUG;
+    if (level > LOG_LEVEL_OFF) level = LOG_LEVEL_OFF;
+    atomic_store(&runtimeLevel, level);
+}
+
+int logParseLevel(const char* name) {
+    static const char* names[] = { "debug", "info", "warn", "error", "off" };
+    for (int level = LOG_LEVEL_DEBUG; level <= LOG_LEVEL_OFF; level++) {
+        if (strcmp(name, names[level]) == 0) return level;
+    }
+    return -1;
+}
@@ -0,0 +1,99 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Journal à niveaux et catégories. Les messages sous LOG_MIN_LEVEL
+// disparaissent à la compilation, arguments compris (LOG_DEBUG en version
+// finale : -DNDEBUG ou -DLOG_MIN_LEVEL=LOG_LEVEL_INFO).
+//
+// Une fois logStart appelé, l'appelant ne fait que composer le message dans
+// une case d'une file sans verrou ; l'horodatage et l'écriture sur stderr
+// se font sur un thread dédié. File pleine : le message est perdu (compté),
+// le jeu n'attend jamais. Sans logStart (outils, benchmarks), l'écriture
+// est immédiate.
+//
+// Chaque appel est limité à LOG_RATE_LIMIT messages par seconde ; au-delà,
+// les messages ne sont même pas formatés, seul leur nombre est signalé.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#define LOG_QUEUE_SIZE 1024         // messages en attente (puissance de 2)
+#define LOG_LINE_MAX 256            // texte d'un message, zéro final compris
+#define LOG_RATE_LIMIT 10           // messages par seconde et par appel
+
+typedef enum {
+    LOG_GAME,                       // déroulement de la partie
+    LOG_ROOM,                       // lecture et écriture des salles
+    LOG_WORLD,                      // manifeste du monde
+    LOG_SYSTEM,                     // threads, mémoire
+    LOG_ASSET,                      // images, police
+    LOG_CATEGORY_COUNT
+} LogCategory;
+
+// État d'un appel (limitation de débit), une variable statique par appel
+typedef struct {
+    atomic_uint window;             // seconde en cours
+    atomic_uint count;              // messages dans cette seconde
+    atomic_uint suppressed;         // messages écartés, pas encore signalés
+} LogSite;
+
+void logWrite(LogSite* site, int level, LogCategory category, const char* fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+#define LOG_AT(level, category, ...) do { \
+        static LogSite logSite_; \
+        logWrite(&logSite_, (level), (category), __VA_ARGS__); \
+    } while (0)
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#else
+#define LOG_WARN(category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) ((void)0)
+#endif
+
+// Lance le thread d'écriture ; les messages restants sont écrits à la sortie
+bool logStart(void);
+// Écrit tout ce qui est en attente et arrête le thread (les autres threads
+// ne doivent plus journaliser)
+void logStop(void);
+// Attend que les messages déjà envoyés soient écrits
+void logFlush(void);
+
+// Niveau minimal à l'exécution, au-dessus de LOG_MIN_LEVEL (LOG_LEVEL_OFF : silence)
+void logSetLevel(int level);
+// "debug", "info", "warn", "error" ou "off" ; -1 si inconnu
+int logParseLevel(const char* name);
+
+#endif
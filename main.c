@@ -2,97 +2,46 @@
 #include <stdbool.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
-
-bool loadMap(const char* filename);
-
-#define WORLD_WIDTH  3
-#define WORLD_HEIGHT 3
-
-typedef struct MapInfo {
-    char* filename;
-    bool exists;
-} MapInfo;
-
-MapInfo world[WORLD_HEIGHT][WORLD_WIDTH];
-
-
-
-int currentMapX = 1;
-int currentMapY = 1;
-
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 576
-#define TILE_SIZE 32
-#define MAP_WIDTH (SCREEN_WIDTH / TILE_SIZE)
-#define MAP_HEIGHT (SCREEN_HEIGHT / TILE_SIZE)
-#define PLAYER_SPEED 4
+#include "asset.h"
+#include "fov.h"
+#include "game.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include "prefetch.h"
+#include "profile.h"
+#include "replay.h"
+#include "roomcache.h"
+#include "savestate.h"
+#include "text.h"
+#include "sprite.h"
+
+// Fenêtre sur la salle, en tuiles ; les salles plus grandes défilent
+#define VIEW_WIDTH 25
+#define VIEW_HEIGHT 18
+#define SCREEN_WIDTH (VIEW_WIDTH * TILE_SIZE)
+#define SCREEN_HEIGHT (VIEW_HEIGHT * TILE_SIZE)
+// Tuiles parcourues pour le rendu des objets : la vue et une marge
+#define VISIBLE_CAPACITY ((VIEW_WIDTH + 3) * (VIEW_HEIGHT + 3))
+#define CULL_GRAIN 2048           // zombies testés par tâche
+// Tuiles explorées hors de vue : assombries
+#define FOG_TINT ((SDL_Color){ 96, 96, 112, 255 })
+
+// Simulation à pas fixe, indépendante de la fréquence d'affichage
+#define DEFAULT_TICK_RATE 60
+#define MAX_FRAME_TIME 0.25       // au-delà, on considère que le jeu était suspendu
+#define MAX_TICKS_PER_FRAME 8     // protection contre la spirale de la mort
 
 #define FRAME_WIDTH 32
 #define FRAME_HEIGHT 32
-#define FRAME_COUNT 9
-#define ANIM_SPEED 8  
-
-typedef enum {
-    DIR_UP = 0,
-    DIR_LEFT = 1,
-    DIR_DOWN = 2,
-    DIR_RIGHT = 3,
-} Direction;
-
-typedef struct {
-    int x, y;
-    int frame;            // 0 → 8
-    int frameTimer;
-    Direction dir;        // Direction actuelle
-    SDL_Texture* texture; // Sprite sheet
-
-} Player;
-
-#define MAX_ENTITIES 64
-
-typedef struct {
-    int x, y;
-} Enemy;
-
-typedef struct {
-    int x, y;
-    bool collected;
-    int doorIndex; 
-} Key;
-
-typedef struct {
-    int x, y;
-    bool open;
-} Door;
-
-Enemy enemies[MAX_ENTITIES];
-int enemyCount = 0;
-
-Key keys[MAX_ENTITIES];
-int keyCount = 0;
-
-Door doors[MAX_ENTITIES];
-int doorCount = 0;
-
-int keysCollected = 0;
-
-typedef struct {
-    int x, y;
-    bool active;
-} Box;
-
-#define MAX_BOXES 10
-Box boxes[MAX_BOXES];
-int boxCount = 0;
-
-
-// 0 = sol, 1 = mur
-int map[MAP_HEIGHT][MAP_WIDTH];
-
-int playerStartX = -1;
-int playerStartY = -1;
 
+#define MENU_FONT_SIZE 28
+#define MENU_ITEM_COUNT 2
+#define MENU_X (SCREEN_WIDTH / 2)
+#define MENU_Y 250
+#define MENU_LINE_SPACING 60
 
+// Rien ne bouge : la boucle dort jusqu'au prochain événement (au plus ce délai)
+#define IDLE_WAIT_MS 100
 
 typedef enum {
     STATE_MENU,
@@ -100,425 +49,270 @@ typedef enum {
     STATE_QUIT
 } GameState;
 
-
-typedef struct {
-    int x, y;
-    bool active;        // l'interrupteur existe dans la carte
-    bool triggered;     // est-ce qu'une caisse est dessus ?
-    int linkedDoor;     // -1 si aucun lien, sinon index de la porte à ouvrir
-} Switch;
-
-#define MAX_SWITCHES 10
-Switch switches[MAX_SWITCHES];
-int switchCount = 0;
-
-SDL_Texture* boxTexture = NULL;
-SDL_Texture* wallTexture = NULL;
-SDL_Texture* groundTexture = NULL;
-SDL_Texture* switchOffTexture = NULL;
-SDL_Texture* switchOnTexture = NULL;
-SDL_Texture* doorTexture = NULL;
-
 SDL_Texture* menuBackground = NULL;
+const char* menuItems[MENU_ITEM_COUNT] = { "MISSION", "QUITTER" };
 
-void loadMapFromWorld(int x, int y) {
-    if (x < 0 || x >= WORLD_WIDTH || y < 0 || y >= WORLD_HEIGHT)
-        return;
+// Couche statique (sol + murs) pré-rendue dans une texture cible, d'une
+// tuile de plus que la vue dans chaque sens pour le défilement au pixel.
+// Elle n'est redessinée que si staticLayerDirty est vrai, si la grille a
+// changé depuis (tileRevision : changement de salle, setTile), si la vue
+// du joueur a été recalculée (fovRevision) ou si la caméra a franchi une
+// tuile.
+SDL_Texture* staticLayer = NULL;
+bool staticLayerDirty = true;
+unsigned staticLayerRevision = 0;
+unsigned staticLayerFov = 0;
+int staticLayerTileX = 0, staticLayerTileY = 0;
 
-    if (!world[y][x].exists)
-        return;
-
-    currentMapX = x;
-    currentMapY = y;
+// Coin haut-gauche de la vue dans la salle, en pixels. Négatif si la salle
+// est plus petite que la fenêtre (elle est alors centrée).
+int cameraX = 0, cameraY = 0;
 
-    loadMap(world[y][x].filename);
-    SDL_Log("filename: %s", world[y][x].filename);   
-    
-}
 
 
-bool loadMap(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        SDL_Log("Impossible d'ouvrir %s", filename);
-        return false;
-    }
 
-    char line[MAP_WIDTH + 2]; // +2 pour '\n' et '\0'
 
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        if (!fgets(line, sizeof(line), file)) {
-            SDL_Log("Erreur de lecture ligne %d (fichier trop court ?)", y + 1);
-            fclose(file);
-            return false;
-        }
 
-        if (strlen(line) < MAP_WIDTH) {
-            SDL_Log("Ligne %d trop courte : %zu caractères", y + 1, strlen(line));
-            fclose(file);
-            return false;
-        }
 
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            switch (line[x]) {
-                case '.':
-                    map[y][x] = 0;
-                    break;
-                case '#':
-                    map[y][x] = 1;
-                    break;
-                case 'P':
-                    map[y][x] = 0;
-                    playerStartX = x;
-                    playerStartY = y;
-                    break;
-                case 'E':
-                    map[y][x] = 0;
-                    if (enemyCount < MAX_ENTITIES) {
-                        enemies[enemyCount++] = (Enemy){ x * TILE_SIZE, y * TILE_SIZE };
-                    }
-                    break;
-                case 'K':
-                    map[y][x] = 0;
-                    if (keyCount < MAX_ENTITIES) {
-                        keys[keyCount] = (Key){ x * TILE_SIZE, y * TILE_SIZE, false, keyCount };
-                        keyCount++;
-                    }
-                    break;
-                case 'D':
-                    map[y][x] = 0;
-                    if (doorCount < MAX_ENTITIES) {
-                        doors[doorCount++] = (Door){ x * TILE_SIZE, y * TILE_SIZE, false };
-                    }
-                    break;
-                case 'C':
-                    map[y][x] = 0;
-                    if (boxCount < MAX_BOXES) {
-                        boxes[boxCount++] = (Box){ x * TILE_SIZE, y * TILE_SIZE, true };
-                    }
-                    break; 
-                    
-                case 'S':    
-                    if (switchCount < MAX_SWITCHES) {
-                        switches[switchCount++] = (Switch){
-                            .x = x * TILE_SIZE,
-                            .y = y * TILE_SIZE,
-                            .active = true,
-                            .triggered = false,
-                            .linkedDoor = -1 // tu peux lier plus tard
-                        };
-                    }
-                    break;
-                default:
-                    SDL_Log("Caractère inconnu '%c' à (%d, %d)", line[x], y, x);
-                    map[y][x] = 0;
-                    break;
-            }
-        }
-    }
-    fclose(file);
 
-
-
-    // Liaison manuelle : interrupteur 0 ouvre porte 0
-    if (switchCount > 0 && doorCount > 0) {
-          SDL_Log("Set Switch to door");
-        switches[0].linkedDoor = 0;
-    }
-
-    return true;
+// Position affichée entre deux ticks de simulation
+int lerpPosition(int previous, int current, float alpha) {
+    return previous + (int)((current - previous) * alpha + (current >= previous ? 0.5f : -0.5f));
 }
 
-bool isBlockedAt(int x, int y) {
-    int tileX = x / TILE_SIZE;
-    int tileY = y / TILE_SIZE;
+// Division arrondie vers -∞ (caméra négative pour les petites salles)
+int floorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
 
-    if (tileX < 0 || tileX >= MAP_WIDTH || tileY < 0 || tileY >= MAP_HEIGHT)
-        return true;
+// Centre la vue sur le joueur affiché, sans sortir de la salle
+int cameraAxis(int center, int roomSize, int viewSize) {
+    if (roomSize <= viewSize) return (roomSize - viewSize) / 2;
 
-    return map[tileY][tileX] == 1;
+    int camera = center - viewSize / 2;
+    if (camera < 0) camera = 0;
+    if (camera > roomSize - viewSize) camera = roomSize - viewSize;
+    return camera;
 }
 
-bool isCollision(int x, int y, int size) {
-    return isBlockedAt(x, y) ||
-           isBlockedAt(x + size - 1, y) ||
-           isBlockedAt(x, y + size - 1) ||
-           isBlockedAt(x + size - 1, y + size - 1);
+void updateCamera(const Player* player, float alpha) {
+    cameraX = cameraAxis(lerpPosition(player->prevX, player->x, alpha) + TILE_SIZE / 2,
+                         tileMap.width * TILE_SIZE, SCREEN_WIDTH);
+    cameraY = cameraAxis(lerpPosition(player->prevY, player->y, alpha) + TILE_SIZE / 2,
+                         tileMap.height * TILE_SIZE, SCREEN_HEIGHT);
 }
 
-bool checkCollision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2) {
-    return !(x1 + w1 <= x2 || x1 >= x2 + w2 || y1 + h1 <= y2 || y1 >= y2 + h2);
+// Tuiles visibles (une de marge pour les objets en cours de déplacement)
+void visibleTiles(int* minX, int* minY, int* maxX, int* maxY) {
+    *minX = floorDiv(cameraX, TILE_SIZE) - 1;
+    *minY = floorDiv(cameraY, TILE_SIZE) - 1;
+    *maxX = floorDiv(cameraX + SCREEN_WIDTH - 1, TILE_SIZE) + 1;
+    *maxY = floorDiv(cameraY + SCREEN_HEIGHT - 1, TILE_SIZE) + 1;
 }
 
-void renderBoxes(SDL_Renderer* renderer) {
-    for (int i = 0; i < boxCount; i++) {
-        if (boxes[i].active) {
-            SDL_Rect dest = { boxes[i].x, boxes[i].y, TILE_SIZE, TILE_SIZE };
-            if (boxTexture)
-                SDL_RenderCopy(renderer, boxTexture, NULL, &dest);
-            else {
-                SDL_SetRenderDrawColor(renderer, 150, 100, 50, 255);
-                SDL_RenderFillRect(renderer, &dest);
-            }
-        }
-    }
+// Objet en vue du joueur (fov.h), d'après la tuile de son centre
+bool inSight(int x, int y) {
+    return fovVisible((x + TILE_SIZE / 2) / TILE_SIZE, (y + TILE_SIZE / 2) / TILE_SIZE);
 }
 
-void renderWalls(SDL_Renderer* renderer) {
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            SDL_Rect tileRect = {x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE};
-            
-            if (map[y][x] == 1) {
-                if (wallTexture) {
-                    SDL_RenderCopy(renderer, wallTexture, NULL, &tileRect);
-                } else {
-                    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-                    SDL_RenderFillRect(renderer, &tileRect);
-                }                
-            } else {
-                if (groundTexture) {
-                    SDL_RenderCopy(renderer, groundTexture, NULL, &tileRect);
-                } else {
-                    SDL_SetRenderDrawColor(renderer, 20, 150, 20, 255); // sol
-                    SDL_RenderFillRect(renderer, &tileRect);
-                }
-
-            }
+void renderBoxes(const int* visible, int count, float alpha) {
+    for (int v = 0; v < count; v++) {
+        int i = visible[v];
+        if ((boxes.flags[i] & ENTITY_ACTIVE) && inSight(boxes.x[i], boxes.y[i])) {
+            SDL_Rect dest = {
+                lerpPosition(boxes.prevX[i], boxes.x[i], alpha) - cameraX,
+                lerpPosition(boxes.prevY[i], boxes.y[i], alpha) - cameraY,
+                TILE_SIZE, TILE_SIZE
+            };
+            spriteDraw(SPRITE_BOX, NULL, &dest);
         }
     }
 }
 
-
-void renderDoors(SDL_Renderer* renderer) {
-    for (int i = 0; i < doorCount; i++) {
-        if (!doors[i].open) {
-           SDL_Rect r = { doors[i].x, doors[i].y, TILE_SIZE, TILE_SIZE };
-            if (boxTexture) {
-                SDL_RenderCopy(renderer, doorTexture, NULL, &r);
-            } else {
-               SDL_SetRenderDrawColor(renderer, 0, 0, 200, 255);
-               SDL_RenderFillRect(renderer, &r);
-            }
-
+// Tuiles de la vue à partir de (tileX, tileY), en un seul lot de géométrie.
+// (offsetX, offsetY) : position à l'écran de la première tuile. Brouillard :
+// les tuiles jamais vues restent noires, celles hors de vue sont assombries.
+void drawTiles(SDL_Renderer* renderer, int tileX, int tileY, int offsetX, int offsetY) {
+    for (int y = 0; y <= VIEW_HEIGHT; y++) {
+        for (int x = 0; x <= VIEW_WIDTH; x++) {
+            // Hors de la salle ou inexplorée : fond noir
+            int mapX = tileX + x, mapY = tileY + y;
+            if (!fovExplored(mapX, mapY))
+                continue;
+
+            SDL_Rect tileRect = {offsetX + x * TILE_SIZE, offsetY + y * TILE_SIZE, TILE_SIZE, TILE_SIZE};
+            SpriteId sprite = tileMapGet(&tileMap, mapX, mapY) == TILE_WALL ? SPRITE_WALL : SPRITE_GROUND;
+            if (fovVisible(mapX, mapY)) spriteDraw(sprite, NULL, &tileRect);
+            else spriteDrawTinted(sprite, NULL, &tileRect, FOG_TINT);
         }
     }
+    spriteFlush(renderer);
 }
 
-
-void  renderSwitchs(SDL_Renderer* renderer) {
-    for (int i = 0; i < switchCount; i++) {
-        if (switches[i].active) {
-            SDL_Rect rect = { switches[i].x, switches[i].y, TILE_SIZE, TILE_SIZE };
-            if (switches[i].triggered) {
-
-                if (switchOnTexture) {
-                    SDL_RenderCopy(renderer, switchOnTexture, NULL, &rect);
-                } else {
-                    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // vert = activé
-                    SDL_RenderFillRect(renderer, &rect);
-                }
-
-            } else {
-
-                if (switchOffTexture) {
-                    SDL_RenderCopy(renderer, switchOffTexture, NULL, &rect);
-                } else {
-                    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // rouge = inactif
-                    SDL_RenderFillRect(renderer, &rect);
-                }
-            }
+// Reconstruit la couche statique si besoin, puis la copie en un seul appel.
+void renderWalls(SDL_Renderer* renderer) {
+    if (!staticLayer && SDL_RenderTargetSupported(renderer)) {
+        staticLayer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                        (VIEW_WIDTH + 1) * TILE_SIZE, (VIEW_HEIGHT + 1) * TILE_SIZE);
+        if (!staticLayer) {
+            SDL_Log("Erreur création couche statique : %s", SDL_GetError());
+        } else {
+            SDL_SetTextureBlendMode(staticLayer, SDL_BLENDMODE_NONE);
+            staticLayerDirty = true;
         }
     }
-}
 
+    int tileX = floorDiv(cameraX, TILE_SIZE);
+    int tileY = floorDiv(cameraY, TILE_SIZE);
+    int offsetX = tileX * TILE_SIZE - cameraX;
+    int offsetY = tileY * TILE_SIZE - cameraY;
 
-void renderMap(SDL_Renderer* renderer) {
-    
-    renderWalls(renderer);
-        
-
-    // Ennemis : rouge
-    for (int i = 0; i < enemyCount; i++) {
-        SDL_Rect r = { enemies[i].x, enemies[i].y, TILE_SIZE, TILE_SIZE };
-        SDL_SetRenderDrawColor(renderer, 200, 0, 0, 255);
-        SDL_RenderFillRect(renderer, &r);
+    // Pas de texture cible disponible : tuiles visibles renvoyées à chaque image
+    if (!staticLayer) {
+        drawTiles(renderer, tileX, tileY, offsetX, offsetY);
+        return;
     }
 
-    // Clés : jaune
-    for (int i = 0; i < keyCount; i++) {
-        if (!keys[i].collected) {
-            SDL_Rect r = { keys[i].x, keys[i].y, TILE_SIZE, TILE_SIZE };
-            SDL_SetRenderDrawColor(renderer, 128, 128, 0, 255);
-            SDL_RenderFillRect(renderer, &r);
-        }
+    if (staticLayerDirty || staticLayerRevision != tileRevision || staticLayerFov != fovRevision ||
+        staticLayerTileX != tileX || staticLayerTileY != tileY) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, staticLayer);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        drawTiles(renderer, tileX, tileY, 0, 0);
+        SDL_SetRenderTarget(renderer, previousTarget);
+        staticLayerDirty = false;
+        staticLayerRevision = tileRevision;
+        staticLayerFov = fovRevision;
+        staticLayerTileX = tileX;
+        staticLayerTileY = tileY;
     }
 
+    SDL_Rect layerRect = { offsetX, offsetY, (VIEW_WIDTH + 1) * TILE_SIZE, (VIEW_HEIGHT + 1) * TILE_SIZE };
+    SDL_RenderCopy(renderer, staticLayer, NULL, &layerRect);
+}
 
-    renderDoors(renderer);
-
-    renderBoxes(renderer);
 
-   renderSwitchs(renderer);
-    
+void renderDoors(const int* visible, int count) {
+    for (int v = 0; v < count; v++) {
+        int i = visible[v];
+        if (!(doors.flags[i] & ENTITY_OPEN) && inSight(doors.x[i], doors.y[i])) {
+            SDL_Rect r = { doors.x[i] - cameraX, doors.y[i] - cameraY, TILE_SIZE, TILE_SIZE };
+            spriteDraw(SPRITE_DOOR, NULL, &r);
+        }
+    }
 }
 
 
-void movePlayer(Player* player, int dx, int dy) {
-    int newX = player->x + dx;
-    int newY = player->y + dy;
-
-    for (int i = 0; i < doorCount; i++) {
-        if (!doors[i].open &&
-            checkCollision(newX, newY, TILE_SIZE, TILE_SIZE,
-                           doors[i].x, doors[i].y, TILE_SIZE, TILE_SIZE)) {
-            // Collision avec une porte FERMÉE
-            SDL_Log("Bloqué par une porte fermée !");
-            return; // Ne pas bouger
+void renderSwitchs(const int* visible, int count) {
+    for (int v = 0; v < count; v++) {
+        int i = visible[v];
+        if ((switches.flags[i] & ENTITY_ACTIVE) && inSight(switches.x[i], switches.y[i])) {
+            SDL_Rect rect = { switches.x[i] - cameraX, switches.y[i] - cameraY, TILE_SIZE, TILE_SIZE };
+            spriteDraw(switches.flags[i] & ENTITY_TRIGGERED ? SPRITE_SWITCH_ON : SPRITE_SWITCH_OFF, NULL, &rect);
         }
     }
+}
 
-    // Vérifie s’il y a une caisse
-    for (int i = 0; i < boxCount; i++) {
-        if (boxes[i].active &&
-            checkCollision(newX, newY, TILE_SIZE, TILE_SIZE,
-                        boxes[i].x, boxes[i].y, TILE_SIZE, TILE_SIZE)) {
-
-            // Coordonnées de destination de la caisse
-            int boxNewX = boxes[i].x + dx;
-            int boxNewY = boxes[i].y + dy;
-
-            // Vérifie si la caisse peut être poussée (pas de mur ni autre caisse)
-            if (!isCollision(boxNewX, boxNewY, TILE_SIZE)) {
-                bool boxBlocked = false;
-
-                for (int j = 0; j < boxCount; j++) {
-                    if (i != j && boxes[j].active &&
-                        checkCollision(boxNewX, boxNewY, TILE_SIZE, TILE_SIZE,
-                                    boxes[j].x, boxes[j].y, TILE_SIZE, TILE_SIZE)) {
-                        boxBlocked = true;
-                        break;
-                    }
-                }
 
-                if (!boxBlocked) {
-                    // Déplace la caisse et le joueur
-                    boxes[i].x = boxNewX;
-                    boxes[i].y = boxNewY;
-                    player->x = newX;
-                    player->y = newY;
-                    return;
-                }
-            }
+// Liste des zombies à l'écran et en vue du joueur, construite en parallèle : chaque tranche
+// écrit ses indices au début de sa propre plage de enemyList puis note leur
+// nombre ; la fusion les recompacte dans l'ordre des tranches, donc dans
+// l'ordre des indices, quel que soit le nombre de threads.
+int* enemyList = NULL;
+int* enemyListCounts = NULL;
+int enemyListCapacity = 0;
+
+void cullEnemyRange(void* context, int begin, int end, int chunk) {
+    (void)context;
+    int count = 0;
+    for (int i = begin; i < end; i++) {
+        int x = enemies.x[i] - cameraX, y = enemies.y[i] - cameraY;
+        if (x + TILE_SIZE > 0 && y + TILE_SIZE > 0 && x < SCREEN_WIDTH && y < SCREEN_HEIGHT &&
+            inSight(enemies.x[i], enemies.y[i]))
+            enemyList[begin + count++] = i;
+    }
+    enemyListCounts[chunk] = count;
+}
 
-            // Sinon, blocage : le joueur ne bouge pas
-            return;
-        }
+int buildEnemyList(void) {
+    if (enemies.count > enemyListCapacity) {
+        int capacity = enemies.count;
+        int* list = realloc(enemyList, capacity * sizeof(int));
+        if (list) enemyList = list;
+        int* counts = realloc(enemyListCounts, jobsChunkCount(capacity, CULL_GRAIN) * sizeof(int));
+        if (counts) enemyListCounts = counts;
+        if (!list || !counts) return 0;
+        enemyListCapacity = capacity;
     }
 
+    jobsParallelFor(enemies.count, CULL_GRAIN, cullEnemyRange, NULL);
 
-    // Détection de direction
-    if (dy < 0) player->dir = DIR_UP;
-    else if (dy > 0) player->dir = DIR_DOWN;
-    else if (dx < 0) player->dir = DIR_LEFT;
-    else if (dx > 0) player->dir = DIR_RIGHT;
+    int total = 0;
+    for (int c = 0; c < jobsChunkCount(enemies.count, CULL_GRAIN); c++) {
+        memmove(enemyList + total, enemyList + c * CULL_GRAIN, enemyListCounts[c] * sizeof(int));
+        total += enemyListCounts[c];
+    }
+    return total;
+}
 
+// Les entités sont accumulées dans le lot de sprites ; l'appelant le vide
+// avec spriteFlush une fois le joueur ajouté. Seuls les objets ancrés
+// dans les tuiles visibles sont parcourus (index d'occupation).
+void renderMap(SDL_Renderer* renderer, float alpha) {
+    
+    renderWalls(renderer);
 
-    // Transition droite
-    if (newX + TILE_SIZE > MAP_WIDTH * TILE_SIZE) {
-        if (currentMapX + 1 < WORLD_WIDTH && world[currentMapY][currentMapX + 1].exists) {
-            loadMapFromWorld(currentMapX + 1, currentMapY);
-            player->x = 0;
-            return;
-        } else {
-            newX = MAP_WIDTH * TILE_SIZE - TILE_SIZE; // blocage
-        }
-    }
+    int minX, minY, maxX, maxY;
+    visibleTiles(&minX, &minY, &maxX, &maxY);
+    // Au plus un objet de chaque type par tuile visible
+    int visible[VISIBLE_CAPACITY];
+    int count;
 
-    // Transition gauche
-    if (newX < 0) {
-        if (currentMapX - 1 >= 0 && world[currentMapY][currentMapX - 1].exists) {
-            loadMapFromWorld(currentMapX - 1, currentMapY);
-            player->x = (MAP_WIDTH - 1) * TILE_SIZE;
-            return;
-        } else {
-            newX = 0;
-        }
+    // Ennemis : rouge. Mobiles, ils ne sont pas indexés : test de la vue
+    count = buildEnemyList();
+    for (int v = 0; v < count; v++) {
+        int i = enemyList[v];
+        SDL_Rect r = { enemies.x[i] - cameraX, enemies.y[i] - cameraY, TILE_SIZE, TILE_SIZE };
+        spriteFill(&r, (SDL_Color){ 200, 0, 0, 255 });
     }
 
-    // Transition haut
-    if (newY < 0) {
-        if (currentMapY - 1 >= 0 && world[currentMapY - 1][currentMapX].exists) {
-            loadMapFromWorld(currentMapX, currentMapY - 1);
-            player->y = (MAP_HEIGHT - 1) * TILE_SIZE;
-            return;
-        } else {
-            newY = 0;
-        }
+    // Clés : jaune
+    count = occupancyCollect(OCC_KEY, minX, minY, maxX, maxY, visible, VISIBLE_CAPACITY);
+    for (int v = 0; v < count; v++) {
+        int i = visible[v];
+        if (!inSight(keys.x[i], keys.y[i])) continue;
+        SDL_Rect r = { keys.x[i] - cameraX, keys.y[i] - cameraY, TILE_SIZE, TILE_SIZE };
+        spriteFill(&r, (SDL_Color){ 128, 128, 0, 255 });
     }
 
-    // Transition bas
-    if (newY + TILE_SIZE > MAP_HEIGHT * TILE_SIZE) {
-        if (currentMapY + 1 < WORLD_HEIGHT && world[currentMapY + 1][currentMapX].exists) {
-            loadMapFromWorld(currentMapX, currentMapY + 1);
-            player->y = 0;
-            return;
-        } else {
-            newY = MAP_HEIGHT * TILE_SIZE - TILE_SIZE;
-        }
-    }
 
-    // Déplacement horizontal
-    if (!isCollision(newX, player->y, TILE_SIZE)) {
-        player->x = newX;
-    }
+    count = occupancyCollect(OCC_DOOR, minX, minY, maxX, maxY, visible, VISIBLE_CAPACITY);
+    renderDoors(visible, count);
 
-    // Déplacement vertical
-    if (!isCollision(player->x, newY, TILE_SIZE)) {
-        player->y = newY;
-    }
+    count = occupancyCollect(OCC_BOX, minX, minY, maxX, maxY, visible, VISIBLE_CAPACITY);
+    renderBoxes(visible, count, alpha);
 
-      // Animation
-    if (dx != 0 || dy != 0) {
-        player->frameTimer++;
-        if (player->frameTimer >= ANIM_SPEED) {
-            player->frame = (player->frame + 1) % FRAME_COUNT;
-            player->frameTimer = 0;
-        }
-    } else {
-        player->frame = 0; // frame fixe si inactif
-    }
+    count = occupancyCollect(OCC_SWITCH, minX, minY, maxX, maxY, visible, VISIBLE_CAPACITY);
+    renderSwitchs(visible, count);
+    
 }
 
-void handleKeyPress(SDL_KeyboardEvent* key, Player* player, bool* running) {
-    int dx = 0, dy = 0;
-
-    switch (key->keysym.scancode) {
-        case SDL_SCANCODE_ESCAPE:
-            *running = false;
-            break;
-        case SDL_SCANCODE_UP:
-            dy = -PLAYER_SPEED;
-            break;
-        case SDL_SCANCODE_DOWN:
-            dy = PLAYER_SPEED;
-            break;
-        case SDL_SCANCODE_LEFT:
-            dx = -PLAYER_SPEED;
-            break;
-        case SDL_SCANCODE_RIGHT:
-            dx = PLAYER_SPEED;
-            break;
-        default:
-            break;
-    }
 
-    if (dx != 0 || dy != 0) {
-        movePlayer(player, dx, dy);
-    }
+
+// Touches maintenues, lues à chaque tick de simulation
+unsigned readHeldKeys(const Uint8* keyboard) {
+    unsigned input = 0;
+
+    if (keyboard[SDL_SCANCODE_UP])    input |= INPUT_UP;
+    if (keyboard[SDL_SCANCODE_DOWN])  input |= INPUT_DOWN;
+    if (keyboard[SDL_SCANCODE_LEFT])  input |= INPUT_LEFT;
+    if (keyboard[SDL_SCANCODE_RIGHT]) input |= INPUT_RIGHT;
+
+    return input;
 }
 
-void renderPlayer(SDL_Renderer* renderer, Player* player) {
+void renderPlayer(Player* player, float alpha) {
     SDL_Rect src = {
         player->frame * FRAME_WIDTH,
         (8 + player->dir) * FRAME_HEIGHT,
@@ -526,238 +320,205 @@ void renderPlayer(SDL_Renderer* renderer, Player* player) {
         FRAME_HEIGHT
     };
     SDL_Rect dst = {
-        player->x,
-        player->y,
+        lerpPosition(player->prevX, player->x, alpha) - cameraX,
+        lerpPosition(player->prevY, player->y, alpha) - cameraY,
         FRAME_WIDTH,
         FRAME_HEIGHT
     };
 
     //printf("Render frame %d at src.x=%d src.y=%d\n", player->frame, src.x, src.y);
     
-    SDL_RenderCopy(renderer, player->texture, &src, &dst);
+    spriteDraw(SPRITE_PLAYER, &src, &dst);
 }
 
-void initWorld() {
-    memset(world, 0, sizeof(world));
 
-    world[1][1] = (MapInfo){ "world/map_1_1.txt", true };
-    world[1][0] = (MapInfo){ "world/map_1_0.txt", true };
-    world[1][2] = (MapInfo){ "world/map_1_2.txt", true };
-    world[0][1] = (MapInfo){ "world/map_0_1.txt", true };
-    world[2][1] = (MapInfo){ "world/map_2_1.txt", true };
+void renderText(SDL_Renderer* renderer, int size, const char* text, int x, int y, SDL_Color color) {
+    textDraw(renderer, size, TTF_STYLE_NORMAL, text, x, y, color);
 }
 
-void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
-    if (!surface) return;
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_Rect dest = { x, y, surface->w, surface->h };
-    SDL_RenderCopy(renderer, texture, NULL, &dest);
 
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-}
 
+void renderTextCentered(SDL_Renderer* renderer, int size, const char* text, int x, int y, bool selected) {
+    SDL_Color color = selected ? (SDL_Color){255, 255, 0, 255} : (SDL_Color){255, 255, 255, 255};
 
-void activateSwitch(Player* player) {
-    SDL_Log("Activate Swich");
-
+    int w, h;
+    SDL_Texture* texture = textCached(renderer, size, TTF_STYLE_NORMAL, text, color, &w, &h);
+    if (!texture) return;
 
-    for (int i = 0; i < switchCount; i++) {
-        switches[i].triggered = false;
-    
-        for (int j = 0; j < boxCount; j++) {
-            SDL_Log("i: %d, j: %d, %s", i, j, (boxes[j].active ? "true" : "false"));
-            SDL_Log("box: %d, %d, %d / switch: %d, %d, %d", j, boxes[j].x, boxes[j].y, i, switches[i].x, switches[i].y);
-            if (boxes[j].active && checkCollision(boxes[j].x, boxes[j].y, TILE_SIZE, TILE_SIZE, switches[i].x, switches[i].y, TILE_SIZE, TILE_SIZE)) {
-                SDL_Log("switch triggered");
-                switches[i].triggered = true;
-    
-                // Si lié à une porte, l'ouvrir
-                if (switches[i].linkedDoor >= 0 && switches[i].linkedDoor < doorCount) {
-                    doors[switches[i].linkedDoor].open = true;
-                }
-            }
-        }
-    }
+    SDL_Rect dst = { x - w / 2, y, w, h };
+    SDL_RenderCopy(renderer, texture, NULL, &dst);
 }
 
 
-void renderTextCentered(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, bool selected) {
-    SDL_Color color = selected ? (SDL_Color){255, 255, 0, 255} : (SDL_Color){255, 255, 255, 255};
-
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text, color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_Rect dst = { x - surface->w / 2, y, surface->w, surface->h };
-    SDL_RenderCopy(renderer, texture, NULL, &dst);
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
+// Rectangle de l'entrée i du menu, d'après la texture en cache : aucune
+// rastérisation pour le survol
+SDL_Rect menuItemRect(SDL_Renderer* renderer, int i) {
+    int textW = 0, textH = 0;
+    textCached(renderer, MENU_FONT_SIZE, TTF_STYLE_NORMAL, menuItems[i], (SDL_Color){255, 255, 255, 255}, &textW, &textH);
+    return (SDL_Rect){ MENU_X - textW / 2, MENU_Y + i * MENU_LINE_SPACING, textW, textH };
 }
 
+// Entrée du menu sous la souris, -1 si aucune
+int menuHitTest(SDL_Renderer* renderer, int mouseX, int mouseY) {
+    for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+        SDL_Rect textRect = menuItemRect(renderer, i);
+        if (mouseX >= textRect.x && mouseX <= textRect.x + textRect.w &&
+            mouseY >= textRect.y && mouseY <= textRect.y + textRect.h) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-void renderMenu(SDL_Renderer* renderer, TTF_Font* font, SDL_Texture* background, SDL_Texture* cursorTexture, int* hoveredIndex) {
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-
+// Le survol est suivi par la boucle principale (menuHitTest) : le menu n'est
+// redessiné que lorsqu'il change. L'appelant efface et présente l'image.
+void renderMenu(SDL_Renderer* renderer, SDL_Texture* background, SDL_Texture* cursorTexture, int hoveredIndex) {
     if (background) {
         SDL_Rect bgRect = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
         SDL_RenderCopy(renderer, background, NULL, &bgRect);
     }
 
-    const char* menuItems[] = { "MISSION", "QUITTER" };
-    int menuX = SCREEN_WIDTH / 2;
-    int menuY = 250;
-    int lineSpacing = 60;
-
-    int mouseX, mouseY;
-    SDL_GetMouseState(&mouseX, &mouseY);
-    *hoveredIndex = -1;
-
-    for (int i = 0; i < 2; i++) {
-        SDL_Color color = {255, 255, 255, 255}; // blanc par défaut
-
-        // Création surface et détection hover
-        SDL_Surface* surface = TTF_RenderUTF8_Blended(font, menuItems[i], color);
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-
-        SDL_Rect textRect = {
-            menuX - surface->w / 2,
-            menuY + i * lineSpacing,
-            surface->w,
-            surface->h
-        };
-
-        // Hover detection
-        if (mouseX >= textRect.x && mouseX <= textRect.x + textRect.w &&
-            mouseY >= textRect.y && mouseY <= textRect.y + textRect.h) {
-            color = (SDL_Color){255, 255, 0, 255}; // Jaune si survolé
-            *hoveredIndex = i;
-        }
-
-        // Recréer texture avec la bonne couleur si survol
-        SDL_FreeSurface(surface);
-        surface = TTF_RenderUTF8_Blended(font, menuItems[i], color);
-        SDL_DestroyTexture(texture);
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
+    for (int i = 0; i < MENU_ITEM_COUNT; i++) {
+        SDL_Rect textRect = menuItemRect(renderer, i);
 
-        SDL_RenderCopy(renderer, texture, NULL, &textRect);
+        // Texture pré-rendue (blanc ou jaune si survolé), construite une seule fois
+        renderTextCentered(renderer, MENU_FONT_SIZE, menuItems[i], MENU_X, textRect.y, hoveredIndex == i);
 
         // Curseur graphique facultatif
-        if (*hoveredIndex == i && cursorTexture) {
-            SDL_Rect cursorRect = { menuX - 120, textRect.y, 32, 32 };
+        if (hoveredIndex == i && cursorTexture) {
+            SDL_Rect cursorRect = { MENU_X - 120, textRect.y, 32, 32 };
             SDL_RenderCopy(renderer, cursorTexture, NULL, &cursorRect);
         }
-
-        SDL_FreeSurface(surface);
-        SDL_DestroyTexture(texture);
     }
-
-    SDL_RenderPresent(renderer);
 }
 
-int main() {
-    SDL_Init(SDL_INIT_VIDEO);
-    SDL_Window* window = SDL_CreateWindow("SDLCommandoZombi", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-
-    initWorld();
-
-    loadMapFromWorld(currentMapX, currentMapY);
-
-
-    SDL_Surface* tempSurface;
-
-    tempSurface = IMG_Load("assets/box.png");
-    if (!tempSurface) {
-        SDL_Log("Erreur chargement box.png : %s", IMG_GetError());
-    } else {
-        boxTexture = SDL_CreateTextureFromSurface(renderer, tempSurface);
-        SDL_FreeSurface(tempSurface);
-    }
-    
-    tempSurface = IMG_Load("assets/wall.png");
-    if (!tempSurface) {
-        SDL_Log("Erreur chargement wall.png : %s", IMG_GetError());
-    } else {
-        wallTexture = SDL_CreateTextureFromSurface(renderer, tempSurface);
-        SDL_FreeSurface(tempSurface);
+// Sans vsync : attente jusqu'à l'échéance de l'image suivante. SDL_Delay
+// couvre l'essentiel, la dernière milliseconde (sa résolution) se fait en
+// rendant la main. L'échéance avance d'une période à chaque image, sans
+// dériver ; après un retard de plus d'une image, elle repart de maintenant.
+void paceFrame(Uint64* deadline, Uint64 period) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    *deadline += period;
+    if (now >= *deadline) {
+        if (now - *deadline > period) *deadline = now;
+        return;
     }
 
-    tempSurface = IMG_Load("assets/ground.png");
-    if (!tempSurface) {
-        SDL_Log("Erreur chargement ground.png : %s", IMG_GetError());
-    } else {
-        groundTexture = SDL_CreateTextureFromSurface(renderer, tempSurface);
-        SDL_FreeSurface(tempSurface);
+    Uint32 milliseconds = (Uint32)((*deadline - now) * 1000 / SDL_GetPerformanceFrequency());
+    if (milliseconds > 1) SDL_Delay(milliseconds - 1);
+    while (SDL_GetPerformanceCounter() < *deadline) {
+        SDL_Delay(0);
     }
+}
 
-    tempSurface = IMG_Load("assets/door.png");
-    if (!tempSurface) {
-        SDL_Log("Erreur chargement door.png : %s", IMG_GetError());
-    } else {
-        doorTexture = SDL_CreateTextureFromSurface(renderer, tempSurface);
-        SDL_FreeSurface(tempSurface);
-    }
 
-    tempSurface = IMG_Load("assets/switchOff.png");
-    if (!tempSurface) {
-        SDL_Log("Erreur chargement switchOff.png : %s", IMG_GetError());
-    } else {
-        switchOffTexture = SDL_CreateTextureFromSurface(renderer, tempSurface);
-        SDL_FreeSurface(tempSurface);
-    }
 
-    tempSurface = IMG_Load("assets/switchOn.png");
-    if (!tempSurface) {
-        SDL_Log("Erreur chargement switchOn.png : %s", IMG_GetError());
-    } else {
-        switchOnTexture = SDL_CreateTextureFromSurface(renderer, tempSurface);
-        SDL_FreeSurface(tempSurface);
+int main(int argc, char* argv[]) {
+    int tickRate = DEFAULT_TICK_RATE;
+    int threadCount = 0;
+    const char* profilePath = NULL;
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    bool replayRealtime = false;
+    bool wantVsync = true;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--tick-rate=", 12) == 0) {
+            tickRate = atoi(argv[i] + 12);
+        } else if (strncmp(argv[i], "--room-cache=", 13) == 0) {
+            // Budget du cache des salles visitées, en Kio (0 : désactivé)
+            roomCacheSetBudget((size_t)atoi(argv[i] + 13) * 1024);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            // Threads de calcul, thread principal compris (0 : un par cœur)
+            threadCount = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--profile=", 10) == 0) {
+            // Profil des dernières images écrit à la sortie (profile.h)
+            profilePath = argv[i] + 10;
+        } else if (strncmp(argv[i], "--log-level=", 12) == 0) {
+            // debug, info, warn, error ou off (log.h)
+            int level = logParseLevel(argv[i] + 12);
+            if (level >= 0) logSetLevel(level);
+            else SDL_Log("Niveau de journal inconnu : %s", argv[i] + 12);
+        } else if (strncmp(argv[i], "--record=", 9) == 0) {
+            // Entrées de chaque tick enregistrées pour un rejeu (replay.h)
+            recordPath = argv[i] + 9;
+        } else if (strncmp(argv[i], "--replay=", 9) == 0) {
+            // Rejeu sans fenêtre, aussi vite que possible (ou --replay-realtime)
+            replayPath = argv[i] + 9;
+        } else if (strcmp(argv[i], "--replay-realtime") == 0) {
+            replayRealtime = true;
+        } else if (strcmp(argv[i], "--no-vsync") == 0) {
+            // Images cadencées par la boucle (paceFrame) plutôt que par l'écran
+            wantVsync = false;
+        }
     }
+    if (tickRate <= 0) {
+        SDL_Log("Fréquence de simulation invalide, %d utilisée", DEFAULT_TICK_RATE);
+        tickRate = DEFAULT_TICK_RATE;
+    }
+
 
+    // Messages du jeu écrits par un thread dédié
+    logStart();
 
-    SDL_Surface* menu_background = IMG_Load("assets/menu_background.png");
-    if (!menu_background) {
-        SDL_Log("Erreur chargement fond menu : %s", IMG_GetError());
-    } else {
-        menuBackground = SDL_CreateTextureFromSurface(renderer, menu_background);
-        SDL_FreeSurface(menu_background);
+    // Rejeu : ni fenêtre ni ressources, seulement la simulation
+    if (replayPath) {
+        prefetchStart();
+        jobsStart(threadCount);
+        ReplayResult result;
+        bool ok = replayRun(replayPath, replayRealtime, &result);
+        SDL_Log("Rejeu %s : %u ticks en %.3f s (%.0f ticks/s)%s", replayPath, result.ticks, result.seconds,
+                result.seconds > 0 ? result.ticks / result.seconds : 0.0, ok ? "" : ", ÉCHEC");
+        prefetchStop();
+        jobsStop();
+        roomCacheShutdown();
+        logStop();
+        return ok ? 0 : 1;
     }
+    // Images décodées en parallèle pendant la création de la fenêtre
+    assetLoadStart();
 
-    SDL_Texture* cursorTexture = NULL;
+    SDL_Init(SDL_INIT_VIDEO);
+    SDL_Window* window = SDL_CreateWindow("SDLCommandoZombi", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE |
+                                                (wantVsync ? SDL_RENDERER_PRESENTVSYNC : 0));
 
-    SDL_Surface* cursor = IMG_Load("assets/cursor.png");
-    if (!cursor) {
-        SDL_Log("Erreur chargement curseur : %s", IMG_GetError());
-    } else {
-        cursorTexture = SDL_CreateTextureFromSurface(renderer, cursor);
-        SDL_FreeSurface(cursor);
+    // Sans vsync, on limite l'affichage à la fréquence de l'écran
+    SDL_RendererInfo rendererInfo;
+    bool vsync = SDL_GetRendererInfo(renderer, &rendererInfo) == 0 &&
+                 (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC);
+    SDL_DisplayMode displayMode;
+    int refreshRate = 60;
+    if (SDL_GetWindowDisplayMode(window, &displayMode) == 0 && displayMode.refresh_rate > 0) {
+        refreshRate = displayMode.refresh_rate;
     }
 
+    // Les salles voisines sont lues en arrière-plan pendant le jeu
+    prefetchStart();
+    jobsStart(threadCount);
+    saveStateStart(SAVESTATE_QUICK_PATH);
 
     Player player;
-
-    SDL_Surface* surface = IMG_Load("assets/player_without_sword.png");
-    if (!surface) {
-        SDL_Log("Erreur de chargement joueur : %s", IMG_GetError());
+    if (!gameStart(&player)) {
+        jobsStop();
+        prefetchStop();
+        SDL_Quit();
+        return 1;
     }
-    player.texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
 
 
-    if (playerStartX == -1 || playerStartY == -1) {
-        SDL_Log("Position du joueur non définie dans la carte !");
-        SDL_Quit();
-        return 1;
+    // Ressources prêtes : envoi au GPU en un seul lot, puis pixels libérés
+    assetLoadWait();
+    if (!spriteAtlasBuild(renderer)) {
+        SDL_Log("Atlas de sprites indisponible, couleurs de secours utilisées");
     }
-    player.x = playerStartX * TILE_SIZE;
-    player.y = playerStartY * TILE_SIZE;
-    player.frame = 0;       // frame 1 (index 0)
-    player.dir = DIR_DOWN;  // direction vers le bas
-    player.frameTimer = 0;
+    assetCreateTextures(renderer);
+    assetReleasePixels();
+    menuBackground = assetTexture(ASSET_MENU_BACKGROUND);
+    SDL_Texture* cursorTexture = assetTexture(ASSET_CURSOR);
 
+    if (recordPath) replayRecordStart(recordPath, tickRate, &player);
 
     bool running = true;
    
@@ -769,95 +530,232 @@ int main() {
     }
 
 
-    TTF_Font* font = TTF_OpenFont("assets/font.ttf", 28);
-    if (!font) {
+    size_t fontSize;
+    const void* fontData = assetFileData(ASSET_FONT, &fontSize);
+    textInit("assets/font.ttf");
+    textSetFontData(fontData, fontSize);
+    if (!textFont(MENU_FONT_SIZE, TTF_STYLE_NORMAL)) {
         SDL_Log("Erreur chargement police: %s", TTF_GetError());
         return 1;
     }
 
-    int selected = -1;
+    // Entrée du menu survolée, mise à jour par les mouvements de la souris
+    int mouseX, mouseY;
+    SDL_GetMouseState(&mouseX, &mouseY);
+    int selected = menuHitTest(renderer, mouseX, mouseY);
     int hovered = -1;
-    
+
+    Uint64 perfFrequency = SDL_GetPerformanceFrequency();
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+    double tickDuration = 1.0 / tickRate;
+    double accumulator = 0.0;
+    unsigned pendingInput = 0;   // actions ponctuelles en attente du prochain tick
+
+    // Suivi des changements : une image n'est dessinée et présentée que si
+    // quelque chose a changé depuis la précédente
+    bool redraw = true;                     // fenêtre, menu, changement d'état
+    unsigned drawnRevision = stateRevision; // stateRevision de la dernière image
+    bool idle = false;                      // rien ne changera sans événement
+    Uint64 framePeriod = perfFrequency / refreshRate;
+    Uint64 nextFrame = lastCounter;
+
     while (running) {
         SDL_Event event;
+        bool waited = false;
+
+        profileFrameBegin();
+
+        // Au repos : la boucle dort jusqu'au prochain événement. Le temps
+        // passé à attendre n'est pas simulé (les ticks au repos ne changent rien).
+        if (idle) {
+            PROFILE_ZONE(PROFILE_WAIT);
+            waited = SDL_WaitEventTimeout(&event, IDLE_WAIT_MS) != 0;
+            lastCounter = SDL_GetPerformanceCounter();
+            nextFrame = lastCounter;
+        }
+
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        double frameTime = (double)(frameStart - lastCounter) / perfFrequency;
+        lastCounter = frameStart;
+        if (frameTime > MAX_FRAME_TIME) {
+            frameTime = MAX_FRAME_TIME;
+        }
+        GameState previousState = gameState;
+
+        {
+            PROFILE_ZONE(PROFILE_EVENTS);
+            while (waited || SDL_PollEvent(&event)) {
+                waited = false;
+
+                if (event.type == SDL_QUIT) {
+                    running = false;
+                }
+
+                // Fenêtre découverte, redimensionnée... : image à refaire
+                if (event.type == SDL_WINDOWEVENT || event.type == SDL_RENDER_DEVICE_RESET) {
+                    redraw = true;
+                }
+
+                // Le contenu des textures cibles peut être perdu (changement de contexte GPU)
+                if (event.type == SDL_RENDER_TARGETS_RESET) {
+                    staticLayerDirty = true;
+                    redraw = true;
+                }
+
+                // Graphe du profileur, en jeu comme au menu
+                if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_F3) {
+                    profileToggleOverlay();
+                    redraw = true;
+                }
     
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = false;
-            }
-    
-            if (gameState == STATE_MENU) {
-                if (event.type == SDL_KEYDOWN && !event.key.repeat) {
-                    if (event.key.keysym.sym == SDLK_RETURN) {
+                if (gameState == STATE_MENU) {
+                    if (event.type == SDL_MOUSEMOTION) {
+                        int hover = menuHitTest(renderer, event.motion.x, event.motion.y);
+                        if (hover != selected) {
+                            selected = hover;
+                            redraw = true;
+                        }
+                    } else if (event.type == SDL_KEYDOWN && !event.key.repeat) {
+                        if (event.key.keysym.sym == SDLK_RETURN) {
+                            if (selected == 0) gameState = STATE_GAME;
+                            else if (selected == 1) gameState = STATE_QUIT;
+                        } else if (event.key.keysym.sym == SDLK_ESCAPE) {
+                            gameState = STATE_QUIT;
+                        }
+                    } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
                         if (selected == 0) gameState = STATE_GAME;
                         else if (selected == 1) gameState = STATE_QUIT;
-                    } else if (event.key.keysym.sym == SDLK_ESCAPE) {
-                        gameState = STATE_QUIT;
                     }
-                } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
-                    if (selected == 0) gameState = STATE_GAME;
-                    else if (selected == 1) gameState = STATE_QUIT;
-                }
-            } else if (gameState == STATE_GAME) {
-                if (event.type == SDL_KEYDOWN && !event.key.repeat) {
-                    if (event.key.keysym.sym == SDLK_ESCAPE) {
-                        gameState = STATE_MENU;  // Retour au menu au lieu de quitter
-                    } else if (event.key.keysym.sym == SDLK_a) {
-                        activateSwitch(&player);
-                    } else {
-                        handleKeyPress(&event.key, &player, &running);
+                } else if (gameState == STATE_GAME) {
+                    if (event.type == SDL_KEYDOWN && !event.key.repeat) {
+                        if (event.key.keysym.sym == SDLK_ESCAPE) {
+                            gameState = STATE_MENU;  // Retour au menu au lieu de quitter
+                        } else if (event.key.keysym.sym == SDLK_a) {
+                            pendingInput |= INPUT_ACTIVATE;
+                        } else if (event.key.keysym.sym == SDLK_F5) {
+                            // Sauvegarde rapide, écrite en arrière-plan (savestate.h)
+                            saveStateWrite(SAVESTATE_QUICK_PATH, &player);
+                        } else if (event.key.keysym.sym == SDLK_F9) {
+                            // Un chargement romprait l'enregistrement en cours
+                            if (recordPath) LOG_WARN(LOG_GAME, "Chargement impossible pendant un enregistrement");
+                            else saveStateRead(SAVESTATE_QUICK_PATH, &player);
+                        }
                     }
                 }
             }
         }
-    
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-    
-        if (gameState == STATE_MENU) {
-            renderMenu(renderer, font, menuBackground, cursorTexture, &selected);
-        } else if (gameState == STATE_GAME) {
-            renderMap(renderer);
-            renderPlayer(renderer, &player);
-    
-            for (int i = 0; i < keyCount; i++) {
-                if (!keys[i].collected &&
-                    checkCollision(player.x, player.y, TILE_SIZE, TILE_SIZE,
-                                   keys[i].x, keys[i].y, TILE_SIZE, TILE_SIZE)) {
-                    
-                    keys[i].collected = true;
-                    keysCollected++;
-                    SDL_Log("Clé ramassée ! (%d/%d)", keysCollected, keyCount);
-    
-                    int doorToOpen = keys[i].doorIndex;
-                    if (doorToOpen >= 0 && doorToOpen < doorCount) {
-                        doors[doorToOpen].open = true;
-                        SDL_Log("Porte %d ouverte par clé %d !", doorToOpen, i);
-                    }
-                }
+
+        // Retour au menu : le survol part de la position actuelle de la souris
+        if (gameState != previousState) {
+            redraw = true;
+            if (gameState == STATE_MENU) {
+                SDL_GetMouseState(&mouseX, &mouseY);
+                selected = menuHitTest(renderer, mouseX, mouseY);
             }
-        } else if (gameState == STATE_QUIT) {
-            running = false;
         }
-    
-        SDL_RenderPresent(renderer);
-        SDL_Delay(16);
-    }
 
-    if (boxTexture) SDL_DestroyTexture(boxTexture);
-    if (wallTexture) SDL_DestroyTexture(wallTexture);
-    
+        // Simulation : autant de ticks fixes que le temps écoulé le demande
+        bool settled = false;   // des ticks ont eu lieu, sans rien changer
+        if (gameState == STATE_GAME) {
+            accumulator += frameTime;
+
+            int ticks = 0;
+            unsigned held = 0;
+            unsigned revision = stateRevision;
+            while (accumulator >= tickDuration && ticks < MAX_TICKS_PER_FRAME) {
+                unsigned input = readHeldKeys(SDL_GetKeyboardState(NULL)) | pendingInput;
+                gameTick(&player, input);
+                replayRecordTick(input, &player);
+                held |= input;
+                pendingInput = 0;
+                accumulator -= tickDuration;
+                ticks++;
+            }
+            settled = ticks > 0 && held == 0 && pendingInput == 0 && revision == stateRevision;
 
-    TTF_CloseFont(font);
+            // Trop de retard : on abandonne le temps restant plutôt que de s'enliser
+            while (accumulator >= tickDuration) {
+                accumulator -= tickDuration;
+            }
+        } else {
+            accumulator = 0.0;
+            pendingInput = 0;
+        }
 
-    if (menuBackground) {
-        SDL_DestroyTexture(menuBackground);
-    }
+        // En jeu : image à refaire si l'état a changé ou pendant une interpolation
+        if (gameState == STATE_GAME &&
+            (stateRevision != drawnRevision || player.prevX != player.x || player.prevY != player.y)) {
+            redraw = true;
+        }
+        if (profileOverlayVisible() || gameState == STATE_QUIT) {
+            redraw = true;
+        }
+
+        bool presented = false;
+        if (redraw) {
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+
+            if (gameState == STATE_MENU) {
+                PROFILE_ZONE(PROFILE_RENDER_MENU);
+                renderMenu(renderer, menuBackground, cursorTexture, selected);
+            } else if (gameState == STATE_GAME) {
+                PROFILE_ZONE(PROFILE_RENDER_MAP);
+                float alpha = (float)(accumulator / tickDuration);
+                updateCamera(&player, alpha);
+                renderMap(renderer, alpha);
+                renderPlayer(&player, alpha);
+                spriteFlush(renderer);
+            } else if (gameState == STATE_QUIT) {
+                running = false;
+            }
+
+            profileDrawOverlay(renderer);
+            {
+                PROFILE_ZONE(PROFILE_PRESENT);
+                SDL_RenderPresent(renderer);
+            }
+            presented = true;
+            redraw = false;
+            drawnRevision = stateRevision;
+        }
+
+        // Au repos au menu, ou en jeu quand les derniers ticks n'ont rien changé
+        idle = !profileOverlayVisible() &&
+               (gameState == STATE_MENU || (gameState == STATE_GAME && settled));
+
+        // Le vsync cadence déjà les images présentées ; sinon, échéance suivante
+        if (!idle && !(presented && vsync)) {
+            PROFILE_ZONE(PROFILE_WAIT);
+            paceFrame(&nextFrame, framePeriod);
+        }
+        profileFrameEnd();
+    }
+
+    PrefetchStats prefetchStats = prefetchGetStats();
+    SDL_Log("Préchargement : %u prêtes, %u en retard, %u manquées",
+            prefetchStats.hits, prefetchStats.lateHits, prefetchStats.misses);
+    prefetchStop();
+    jobsStop();
+    replayRecordStop();
+    saveStateShutdown();
+    if (profilePath) profileDump(profilePath);
+    roomCacheShutdown();
+    free(enemyList);
+    free(enemyListCounts);
+
+    spriteAtlasDestroy();
+    if (staticLayer) SDL_DestroyTexture(staticLayer);
+    
+
+    textShutdown();
+    assetShutdown();
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     TTF_Quit();
     SDL_Quit();
+    logStop();
     return 0;
 }
 
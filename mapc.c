@@ -0,0 +1,60 @@
+// Compilateur de salles : world/*.txt → world/*.czr (voir roomfile.h).
+// Usage : ./mapc salle.txt [salle.txt ...]
+//         ./mapc -o sortie.czr salle.txt
+
+#include "game.h"
+#include "roomfile.h"
+#include <stdio.h>
+#include <string.h>
+
+static bool compileRoom(const char* input, const char* output) {
+    static Room room;
+
+    // Les glyphes inconnus sont signalés ici, une fois pour toutes
+    if (!readRoomText(input, &room)) {
+        fprintf(stderr, "%s : lecture impossible\n", input);
+        return false;
+    }
+
+    if (!writeRoomBinary(output, &room)) {
+        fprintf(stderr, "%s : écriture impossible\n", output);
+        return false;
+    }
+
+    printf("%s -> %s (%d ennemis, %d clés, %d portes, %d caisses, %d interrupteurs, %d mécanismes)\n",
+           input, output, room.enemies.count, room.keys.count, room.doors.count, room.boxes.count, room.switches.count,
+           room.linkCount);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* output = NULL;
+    int failures = 0;
+    int inputs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+            continue;
+        }
+
+        char path[256];
+        if (output) {
+            snprintf(path, sizeof(path), "%s", output);
+            output = NULL;
+        } else if (!roomBinaryPath(argv[i], path, sizeof(path))) {
+            fprintf(stderr, "%s : chemin trop long\n", argv[i]);
+            failures++;
+            continue;
+        }
+
+        if (!compileRoom(argv[i], path)) failures++;
+        inputs++;
+    }
+
+    if (inputs == 0) {
+        fprintf(stderr, "Usage : %s [-o sortie.czr] salle.txt [salle.txt ...]\n", argv[0]);
+        return 1;
+    }
+    return failures ? 1 : 0;
+}
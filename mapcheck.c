@@ -0,0 +1,132 @@
+// Vérificateur de salles : chaque salle peut-elle être terminée, et en
+// combien de poussées au minimum (voir puzzle.h) ?
+// Usage : ./mapcheck [--max-states=N] [--threads=N] salle.txt [salle.czr ...]
+//         ./mapcheck --generate=N [--seed=N] [--size=LxH] [--loops=P] [--max-states=N] [--threads=N]
+// Code de retour 1 si une salle donnée est insoluble ; les salles générées
+// (roomgen.h) ne font qu'un bilan, avec la graine des salles insolubles.
+
+#include "puzzle.h"
+#include "jobs.h"
+#include "roomgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t maxStates = PUZZLE_DEFAULT_STATES;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void printResult(const char* name, const PuzzleResult* result, double seconds) {
+    switch (result->status) {
+        case PUZZLE_SOLVED:
+            printf("%s : résoluble en %d poussée(s)", name, result->pushes);
+            break;
+        case PUZZLE_UNSOLVABLE:
+            printf("%s : INSOLUBLE", name);
+            break;
+        default:
+            printf("%s : non conclu", name);
+            break;
+    }
+    printf(" (%d porte(s) à ouvrir, %llu états, %.1f ms)", result->goalDoors,
+           (unsigned long long)result->states, seconds * 1e3);
+    if (result->lockedDoors > 0) printf(", %d porte(s) sans ouverture", result->lockedDoors);
+    printf("\n");
+}
+
+static bool checkRoom(const char* path) {
+    static Room room;
+
+    if (!readRoom(path, &room)) {
+        fprintf(stderr, "%s : lecture impossible\n", path);
+        return false;
+    }
+
+    PuzzleResult result;
+    double start = now();
+    puzzleSolve(&room, maxStates, &result);
+    printResult(path, &result, now() - start);
+    return result.status != PUZZLE_UNSOLVABLE;
+}
+
+static void checkGenerated(int count, const RoomGenParams* base) {
+    static Room room;
+    int counts[3] = { 0, 0, 0 };
+    int maxPushes = 0;
+    double start = now();
+
+    for (int i = 0; i < count; i++) {
+        RoomGenParams params = *base;
+        params.seed = base->seed + (uint32_t)i;
+        if (!roomGenerate(&params, &room)) {
+            fprintf(stderr, "Graine %u : génération impossible\n", params.seed);
+            continue;
+        }
+
+        PuzzleResult result;
+        puzzleSolve(&room, maxStates, &result);
+        counts[result.status]++;
+        if (result.status == PUZZLE_SOLVED && result.pushes > maxPushes) maxPushes = result.pushes;
+        if (result.status != PUZZLE_SOLVED) {
+            char name[32];
+            snprintf(name, sizeof(name), "graine %u", params.seed);
+            printResult(name, &result, 0.0);
+        }
+    }
+
+    printf("%d salles de %d × %d : %d résolubles (au plus %d poussées), %d insolubles, %d non conclues (%.2f s)\n",
+           count, base->width, base->height, counts[PUZZLE_SOLVED], maxPushes, counts[PUZZLE_UNSOLVABLE],
+           counts[PUZZLE_UNKNOWN], now() - start);
+}
+
+int main(int argc, char* argv[]) {
+    RoomGenParams params;
+    roomGenDefaults(&params);
+    int generate = 0;
+    int threadCount = 0;
+    int failures = 0;
+    int inputs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--max-states=", 13) == 0) {
+            maxStates = strtoull(argv[i] + 13, NULL, 10);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threadCount = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--generate=", 11) == 0) {
+            generate = atoi(argv[i] + 11);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            params.seed = (uint32_t)strtoul(argv[i] + 7, NULL, 10);
+        } else if (strncmp(argv[i], "--size=", 7) == 0) {
+            if (sscanf(argv[i] + 7, "%dx%d", &params.width, &params.height) != 2) {
+                fprintf(stderr, "Taille invalide : %s\n", argv[i] + 7);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--loops=", 8) == 0) {
+            params.loopPercent = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Option inconnue : %s\n", argv[i]);
+            return 1;
+        } else {
+            inputs++;
+        }
+    }
+
+    if (inputs == 0 && generate <= 0) {
+        fprintf(stderr, "Usage : %s [--max-states=N] [--threads=N] salle.txt [salle.txt ...]\n"
+                        "       %s --generate=N [--seed=N] [--size=LxH] [--loops=P]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    jobsStart(threadCount);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0 && !checkRoom(argv[i])) failures++;
+    }
+    if (generate > 0) checkGenerated(generate, &params);
+    jobsStop();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+#include "occupancy.h"
+#include "collide.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Index découpé comme la grille : un bloc par tronçon de CHUNK_SIZE tuiles,
+// alloué seulement si un objet y est ancré. Les zones vides d'une grande
+// salle ne coûtent qu'un pointeur nul par tronçon.
+typedef struct {
+    int32_t cells[OCC_LAYER_COUNT][CHUNK_SIZE][CHUNK_SIZE];
+} OccupancyChunk;
+
+static OccupancyChunk** chunks = NULL;     // un pointeur par tronçon de la salle
+static int chunksX = 0;
+static int chunkCapacity = 0;
+static int mapWidth = 0, mapHeight = 0;
+
+// Blocs alloués (indices dans chunks) et blocs libres à recycler : changer de
+// salle ne parcourt que les blocs utilisés, pas toute la grande salle d'avant
+static int* usedSlots = NULL;
+static int usedCount = 0, usedCapacity = 0;
+static OccupancyChunk** freeChunks = NULL;
+static int freeCount = 0;
+
+static OccupancyChunk* allocateChunk(int slot) {
+    if (usedCount == usedCapacity) {
+        int capacity = usedCapacity ? usedCapacity * 2 : 16;
+        int* grownSlots = realloc(usedSlots, capacity * sizeof(int));
+        if (!grownSlots) return NULL;
+        usedSlots = grownSlots;
+        OccupancyChunk** grownFree = realloc(freeChunks, capacity * sizeof(OccupancyChunk*));
+        if (!grownFree) return NULL;
+        freeChunks = grownFree;
+        usedCapacity = capacity;
+    }
+
+    OccupancyChunk* chunk = freeCount ? freeChunks[--freeCount] : malloc(sizeof(OccupancyChunk));
+    if (!chunk) return NULL;
+
+    memset(chunk, 0xff, sizeof(OccupancyChunk));
+    usedSlots[usedCount++] = slot;
+    chunks[slot] = chunk;
+    return chunk;
+}
+
+static int32_t* cellAt(OccupancyLayer layer, int tileX, int tileY, bool create) {
+    int slot = (tileY >> CHUNK_SHIFT) * chunksX + (tileX >> CHUNK_SHIFT);
+    OccupancyChunk* chunk = chunks[slot];
+    if (!chunk) {
+        if (!create) return NULL;
+        chunk = allocateChunk(slot);
+        if (!chunk) return NULL;
+    }
+    return &chunk->cells[layer][tileY & CHUNK_MASK][tileX & CHUNK_MASK];
+}
+
+static const EntityPool* layerPool(OccupancyLayer layer) {
+    switch (layer) {
+        case OCC_DOOR:   return &doors;
+        case OCC_BOX:    return &boxes;
+        case OCC_SWITCH: return &switches;
+        case OCC_KEY:    return &keys;
+        default:         return NULL;
+    }
+}
+
+static bool entityPosition(OccupancyLayer layer, int index, int* x, int* y) {
+    const EntityPool* pool = layerPool(layer);
+    if (!pool || index >= pool->count) return false;
+
+    *x = pool->x[index];
+    *y = pool->y[index];
+    // Une caisse inactive n'occupe rien ; portes, clés et interrupteurs toujours
+    return layer != OCC_BOX || (pool->flags[index] & ENTITY_ACTIVE);
+}
+
+static void place(OccupancyLayer layer, int index, int x, int y) {
+    int tileX = x / TILE_SIZE;
+    int tileY = y / TILE_SIZE;
+    if (x < 0 || y < 0 || tileX >= mapWidth || tileY >= mapHeight)
+        return;
+
+    int32_t* cell = cellAt(layer, tileX, tileY, true);
+    if (!cell) return;
+    if (*cell >= 0 && *cell != index) {
+        LOG_WARN(LOG_ROOM, "Objets superposés en (%d, %d), l'objet %d est ignoré", tileX, tileY, index);
+        return;
+    }
+    *cell = index;
+}
+
+static void clear(OccupancyLayer layer, int index, int x, int y) {
+    int tileX = x / TILE_SIZE;
+    int tileY = y / TILE_SIZE;
+    if (x < 0 || y < 0 || tileX >= mapWidth || tileY >= mapHeight)
+        return;
+
+    int32_t* cell = cellAt(layer, tileX, tileY, false);
+    if (cell && *cell == index)
+        *cell = -1;
+}
+
+void occupancyRebuild(void) {
+    // Les blocs déjà alloués sont recyclés d'une salle à l'autre
+    for (int i = 0; i < usedCount; i++) {
+        freeChunks[freeCount++] = chunks[usedSlots[i]];
+        chunks[usedSlots[i]] = NULL;
+    }
+    usedCount = 0;
+
+    int count = tileMap.chunksX * tileMap.chunksY;
+    if (count > chunkCapacity) {
+        OccupancyChunk** grown = realloc(chunks, count * sizeof(OccupancyChunk*));
+        if (!grown) {
+            mapWidth = mapHeight = 0;
+            return;
+        }
+        memset(grown + chunkCapacity, 0, (count - chunkCapacity) * sizeof(OccupancyChunk*));
+        chunks = grown;
+        chunkCapacity = count;
+    }
+    chunksX = tileMap.chunksX;
+    mapWidth = tileMap.width;
+    mapHeight = tileMap.height;
+
+    for (int layer = 0; layer < OCC_LAYER_COUNT; layer++) {
+        for (int i = 0; i < layerPool(layer)->count; i++) {
+            int x, y;
+            if (entityPosition(layer, i, &x, &y)) place(layer, i, x, y);
+        }
+    }
+}
+
+void occupancyMove(OccupancyLayer layer, int index, int oldX, int oldY, int newX, int newY) {
+    if (oldX / TILE_SIZE == newX / TILE_SIZE && oldY / TILE_SIZE == newY / TILE_SIZE)
+        return;
+
+    clear(layer, index, oldX, oldY);
+    place(layer, index, newX, newY);
+}
+
+void occupancyRemove(OccupancyLayer layer, int index) {
+    int x, y;
+    if (entityPosition(layer, index, &x, &y)) clear(layer, index, x, y);
+
+    // La dernière entité va prendre la place de index (entityRemove)
+    int last = layerPool(layer)->count - 1;
+    if (last != index && entityPosition(layer, last, &x, &y)) {
+        clear(layer, last, x, y);
+        place(layer, index, x, y);
+    }
+}
+
+int occupancyQuery(OccupancyLayer layer, int x, int y, int hits[OCCUPANCY_MAX_HITS]) {
+    // Un objet chevauche le rectangle si son coin est dans ]x - TILE_SIZE, x + TILE_SIZE[
+    int minX = (x - TILE_SIZE + 1) / TILE_SIZE, maxX = (x + TILE_SIZE - 1) / TILE_SIZE;
+    int minY = (y - TILE_SIZE + 1) / TILE_SIZE, maxY = (y + TILE_SIZE - 1) / TILE_SIZE;
+    if (minX < 0) minX = 0;
+    if (minY < 0) minY = 0;
+    if (maxX >= mapWidth) maxX = mapWidth - 1;
+    if (maxY >= mapHeight) maxY = mapHeight - 1;
+
+    // Au plus 3 × 3 cellules : candidats rassemblés en colonnes, testés d'un coup
+    int candidates[9], xs[9], ys[9];
+    int candidateCount = 0;
+    for (int tileY = minY; tileY <= maxY; tileY++) {
+        for (int tileX = minX; tileX <= maxX; tileX++) {
+            const int32_t* cell = cellAt(layer, tileX, tileY, false);
+            int index = cell ? *cell : -1;
+            if (index < 0 || !entityPosition(layer, index, &xs[candidateCount], &ys[candidateCount]))
+                continue;
+            candidates[candidateCount++] = index;
+        }
+    }
+
+    uint32_t mask;
+    if (candidateCount == 0 ||
+        collideMask(x, y, TILE_SIZE, TILE_SIZE, xs, ys, candidateCount, TILE_SIZE, TILE_SIZE, &mask) == 0)
+        return 0;
+
+    int count = 0;
+    for (int c = 0; c < candidateCount; c++) {
+        if (!(mask & 1u << c)) continue;
+
+        // Tri par insertion : même ordre que le parcours des tableaux
+        int index = candidates[c];
+        int slot = count < OCCUPANCY_MAX_HITS ? count++ : OCCUPANCY_MAX_HITS - 1;
+        while (slot > 0 && hits[slot - 1] > index) {
+            hits[slot] = hits[slot - 1];
+            slot--;
+        }
+        hits[slot] = index;
+    }
+    return count;
+}
+
+int occupancyCollect(OccupancyLayer layer, int minX, int minY, int maxX, int maxY, int* out, int capacity) {
+    if (minX < 0) minX = 0;
+    if (minY < 0) minY = 0;
+    if (maxX >= mapWidth) maxX = mapWidth - 1;
+    if (maxY >= mapHeight) maxY = mapHeight - 1;
+
+    int count = 0;
+    for (int cy = minY >> CHUNK_SHIFT; cy <= maxY >> CHUNK_SHIFT; cy++) {
+        for (int cx = minX >> CHUNK_SHIFT; cx <= maxX >> CHUNK_SHIFT; cx++) {
+            // Tronçon sans objet : rien à lire
+            const OccupancyChunk* chunk = chunks[cy * chunksX + cx];
+            if (!chunk) continue;
+
+            int x0 = cx << CHUNK_SHIFT, y0 = cy << CHUNK_SHIFT;
+            int x1 = x0 + CHUNK_MASK < maxX ? x0 + CHUNK_MASK : maxX;
+            int y1 = y0 + CHUNK_MASK < maxY ? y0 + CHUNK_MASK : maxY;
+            if (x0 < minX) x0 = minX;
+            if (y0 < minY) y0 = minY;
+
+            for (int tileY = y0; tileY <= y1; tileY++) {
+                for (int tileX = x0; tileX <= x1; tileX++) {
+                    int index = chunk->cells[layer][tileY & CHUNK_MASK][tileX & CHUNK_MASK];
+                    if (index >= 0 && count < capacity) out[count++] = index;
+                }
+            }
+        }
+    }
+    return count;
+}
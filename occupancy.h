@@ -0,0 +1,48 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stdint.h>
+#include "game.h"
+
+// Index d'occupation de la salle courante : pour chaque tuile et chaque
+// type d'objet, l'indice de l'objet dont le coin haut-gauche est dans la
+// tuile (-1 si aucun). Les objets font une tuile et ne se chevauchent pas
+// entre objets du même type, donc une tuile en contient au plus un par type.
+// Les zombies, mobiles et qui se chevauchent en horde, n'y sont pas : ils
+// suivent le champ de flux (flow.h).
+//
+// Un rectangle d'une tuile ne peut toucher que des objets ancrés dans les
+// 3 × 3 tuiles autour de lui : une requête coûte au plus 9 lectures, quel
+// que soit le nombre d'objets dans la salle.
+
+typedef enum {
+    OCC_DOOR = 0,
+    OCC_BOX,
+    OCC_SWITCH,
+    OCC_KEY,
+    OCC_LAYER_COUNT
+} OccupancyLayer;
+
+// Objets d'un même type qui peuvent chevaucher un rectangle d'une tuile
+#define OCCUPANCY_MAX_HITS 4
+
+// Reconstruit l'index depuis les tableaux d'entités et la taille de
+// tileMap (changement de salle)
+void occupancyRebuild(void);
+// Mise à jour incrémentale après le déplacement d'un objet
+void occupancyMove(OccupancyLayer layer, int index, int oldX, int oldY, int newX, int newY);
+
+// À appeler juste avant entityRemove : retire l'objet et réindexe le
+// dernier, qui prend sa place
+void occupancyRemove(OccupancyLayer layer, int index);
+
+// Objets du type donné qui chevauchent le rectangle (x, y, TILE_SIZE, TILE_SIZE),
+// par indice croissant. Les caisses inactives ne sont pas indexées.
+int occupancyQuery(OccupancyLayer layer, int x, int y, int hits[OCCUPANCY_MAX_HITS]);
+
+// Objets ancrés dans le rectangle de tuiles [minX, maxX] × [minY, maxY]
+// (bornes incluses), au plus capacity ; les tronçons vides sont sautés.
+// Sert au rendu : seules les tuiles visibles sont parcourues.
+int occupancyCollect(OccupancyLayer layer, int minX, int minY, int maxX, int maxY, int* out, int capacity);
+
+#endif
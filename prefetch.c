@@ -0,0 +1,192 @@
+#include "prefetch.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_REQUESTED,     // en attente du thread de chargement
+    SLOT_LOADING,       // lecture en cours (le thread écrit dans room)
+    SLOT_READY,
+    SLOT_FAILED,
+} SlotState;
+
+typedef struct {
+    SlotState state;
+    int x, y;
+    bool wanted;        // fait partie du dernier ensemble demandé
+    int pins;           // réservations par prefetchAcquire
+    char filename[256];
+    Room room;
+} PrefetchSlot;
+
+static PrefetchSlot slots[PREFETCH_SLOTS];
+static PrefetchStats stats;
+
+static pthread_t worker;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;      // nouvelle demande ou arrêt
+static pthread_cond_t finished = PTHREAD_COND_INITIALIZER;  // une lecture s'est terminée
+static bool running = false;
+
+
+static void* prefetchWorker(void* arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&lock);
+    while (running) {
+        PrefetchSlot* slot = NULL;
+        for (int i = 0; i < PREFETCH_SLOTS && !slot; i++) {
+            if (slots[i].state == SLOT_REQUESTED) slot = &slots[i];
+        }
+
+        if (!slot) {
+            pthread_cond_wait(&wake, &lock);
+            continue;
+        }
+
+        // Le créneau est à nous tant qu'il est en LOADING : lecture hors verrou
+        slot->state = SLOT_LOADING;
+        pthread_mutex_unlock(&lock);
+
+        bool ok = readRoom(slot->filename, &slot->room);
+
+        pthread_mutex_lock(&lock);
+        slot->state = ok ? SLOT_READY : SLOT_FAILED;
+        pthread_cond_broadcast(&finished);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+bool prefetchStart(void) {
+    if (running) return true;
+
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        roomFree(&slots[i].room);
+    }
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+    running = true;
+
+    if (pthread_create(&worker, NULL, prefetchWorker, NULL) != 0) {
+        LOG_ERROR(LOG_SYSTEM, "Impossible de lancer le thread de préchargement");
+        running = false;
+        return false;
+    }
+    return true;
+}
+
+void prefetchStop(void) {
+    if (!running) return;
+
+    pthread_mutex_lock(&lock);
+    running = false;
+    pthread_cond_broadcast(&wake);
+    pthread_mutex_unlock(&lock);
+
+    pthread_join(worker, NULL);
+
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        roomFree(&slots[i].room);
+    }
+}
+
+
+static PrefetchSlot* findSlot(int x, int y) {
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        if (slots[i].state != SLOT_EMPTY && slots[i].x == x && slots[i].y == y)
+            return &slots[i];
+    }
+    return NULL;
+}
+
+void prefetchWant(const PrefetchRequest* requests, int count) {
+    if (!running) return;
+
+    pthread_mutex_lock(&lock);
+
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        slots[i].wanted = false;
+    }
+    for (int r = 0; r < count; r++) {
+        PrefetchSlot* slot = findSlot(requests[r].x, requests[r].y);
+        if (slot) slot->wanted = true;
+    }
+    // Demandes pas encore commencées et devenues inutiles : annulées
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        if (!slots[i].wanted && slots[i].state == SLOT_REQUESTED) slots[i].state = SLOT_EMPTY;
+    }
+
+    // Les salles qui ne sont plus voisines restent disponibles (retour en
+    // arrière) jusqu'à ce que leur créneau soit repris par une nouvelle demande
+    bool queued = false;
+    for (int r = 0; r < count; r++) {
+        if (findSlot(requests[r].x, requests[r].y)) continue;
+
+        PrefetchSlot* slot = NULL;
+        for (int i = 0; i < PREFETCH_SLOTS && !slot; i++) {
+            if (slots[i].state == SLOT_EMPTY) slot = &slots[i];
+        }
+        for (int i = 0; i < PREFETCH_SLOTS && !slot; i++) {
+            if (!slots[i].wanted && slots[i].pins == 0 && slots[i].state != SLOT_LOADING)
+                slot = &slots[i];
+        }
+        if (!slot) break;
+
+        slot->state = SLOT_REQUESTED;
+        slot->x = requests[r].x;
+        slot->y = requests[r].y;
+        slot->wanted = true;
+        snprintf(slot->filename, sizeof(slot->filename), "%s", requests[r].filename);
+        queued = true;
+    }
+
+    if (queued) pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+const Room* prefetchAcquire(int x, int y) {
+    if (!running) return NULL;
+
+    pthread_mutex_lock(&lock);
+
+    // Une lecture en cours qui échoue compte comme un échec, pas comme une attente
+    PrefetchSlot* slot = findSlot(x, y);
+    bool late = slot && (slot->state == SLOT_REQUESTED || slot->state == SLOT_LOADING);
+    while (late && (slot->state == SLOT_REQUESTED || slot->state == SLOT_LOADING)) {
+        pthread_cond_wait(&finished, &lock);
+    }
+
+    const Room* room = NULL;
+    if (slot && slot->state == SLOT_READY) {
+        if (late) stats.lateHits++;
+        else stats.hits++;
+        slot->pins++;
+        room = &slot->room;
+    } else {
+        stats.misses++;
+    }
+
+    pthread_mutex_unlock(&lock);
+    return room;
+}
+
+void prefetchRelease(const Room* room) {
+    if (!room) return;
+
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < PREFETCH_SLOTS; i++) {
+        if (&slots[i].room == room && slots[i].pins > 0) {
+            slots[i].pins--;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+PrefetchStats prefetchGetStats(void) {
+    pthread_mutex_lock(&lock);
+    PrefetchStats copy = stats;
+    pthread_mutex_unlock(&lock);
+    return copy;
+}
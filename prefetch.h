@@ -0,0 +1,37 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "game.h"
+
+// Préchargement des salles voisines sur un thread dédié. Le thread lit et
+// analyse les salles demandées dans des tampons de préparation ; au moment
+// de la transition, le thread principal récupère la salle prête sans E/S.
+
+#define PREFETCH_SLOTS 8
+
+typedef struct {
+    int x, y;                   // coordonnées dans le monde
+    const char* filename;
+} PrefetchRequest;
+
+typedef struct {
+    unsigned hits;              // salle prête au moment de la transition
+    unsigned lateHits;          // lecture en cours : attente de sa fin
+    unsigned misses;            // salle non demandée ou illisible : lecture synchrone
+} PrefetchStats;
+
+bool prefetchStart(void);
+void prefetchStop(void);
+
+// Remplace l'ensemble des salles à garder prêtes
+void prefetchWant(const PrefetchRequest* requests, int count);
+
+// Salle préchargée pour (x, y), ou NULL si absente (le préchargeur
+// n'est pas lancé, la salle n'a pas été demandée ou n'a pas pu être lue).
+// La salle reste réservée jusqu'à prefetchRelease.
+const Room* prefetchAcquire(int x, int y);
+void prefetchRelease(const Room* room);
+
+PrefetchStats prefetchGetStats(void);
+
+#endif
@@ -0,0 +1,232 @@
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include <SDL2/SDL.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "text.h"
+
+#define HISTORY_MASK (PROFILE_HISTORY - 1)
+#define EVENT_MASK (PROFILE_EVENT_CAPACITY - 1)
+
+#define OVERLAY_BAR_WIDTH 3
+#define OVERLAY_HEIGHT 132                  // pixels pour OVERLAY_SCALE_MS
+#define OVERLAY_SCALE_MS 33.0
+#define OVERLAY_FONT_SIZE 12
+
+typedef struct {
+    uint64_t start;
+    uint64_t duration;
+    uint64_t zones[PROFILE_ZONE_COUNT];
+} FrameRecord;
+
+typedef struct {
+    uint64_t start, end;
+    uint8_t zone;
+    uint8_t thread;
+} ZoneEvent;
+
+static const char* zoneNames[PROFILE_ZONE_COUNT] = {
+    "events", "gameTick", "movePlayer", "activateSwitch", "moveEnemies",
+    "renderMap", "renderMenu", "present", "wait",
+};
+
+// Zones mesurées à l'intérieur de gameTick : pas empilées dans le graphe
+static const bool nestedZone[PROFILE_ZONE_COUNT] = {
+    [PROFILE_MOVE_PLAYER] = true, [PROFILE_ACTIVATE] = true, [PROFILE_ENEMIES] = true,
+};
+
+static const SDL_Color zoneColors[PROFILE_ZONE_COUNT] = {
+    { 120, 120, 255, 255 }, { 80, 200, 80, 255 }, { 160, 255, 160, 255 }, { 255, 255, 120, 255 },
+    { 40, 140, 40, 255 }, { 255, 140, 60, 255 }, { 255, 90, 200, 255 }, { 230, 60, 60, 255 },
+    { 90, 90, 90, 255 },
+};
+
+// Anneau des images : écrit par le thread principal, l'indice est publié
+// après la ligne (release) ; un lecteur ne lit que des lignes terminées
+static FrameRecord frames[PROFILE_HISTORY];
+static atomic_uint frameHead = 0;           // images terminées depuis le début
+
+// Durées de l'image en cours, ajoutées par les zones de tous les threads
+static atomic_uint_fast64_t zoneTotals[PROFILE_ZONE_COUNT];
+static uint64_t frameStart = 0;
+
+// Anneau des zones pour la trace : une place réservée par fetch_add,
+// les plus anciennes sont écrasées
+static ZoneEvent events[PROFILE_EVENT_CAPACITY];
+static atomic_uint eventHead = 0;
+
+static atomic_uint threadCounter = 0;
+static _Thread_local int threadId = -1;
+
+static bool overlayVisible = false;
+
+
+uint64_t profileNow(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+void profileZoneEnd(ProfileScope* scope) {
+    uint64_t end = SDL_GetPerformanceCounter();
+    atomic_fetch_add_explicit(&zoneTotals[scope->zone], end - scope->start, memory_order_relaxed);
+
+    if (threadId < 0) threadId = (int)atomic_fetch_add(&threadCounter, 1);
+    unsigned slot = atomic_fetch_add_explicit(&eventHead, 1, memory_order_relaxed) & EVENT_MASK;
+    events[slot] = (ZoneEvent){ scope->start, end, (uint8_t)scope->zone, (uint8_t)threadId };
+}
+
+void profileFrameBegin(void) {
+    frameStart = SDL_GetPerformanceCounter();
+}
+
+void profileFrameEnd(void) {
+    unsigned head = atomic_load_explicit(&frameHead, memory_order_relaxed);
+    FrameRecord* record = &frames[head & HISTORY_MASK];
+
+    record->start = frameStart;
+    record->duration = SDL_GetPerformanceCounter() - frameStart;
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        record->zones[z] = atomic_exchange_explicit(&zoneTotals[z], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&frameHead, head + 1, memory_order_release);
+}
+
+void profileToggleOverlay(void) {
+    overlayVisible = !overlayVisible;
+}
+
+bool profileOverlayVisible(void) {
+    return overlayVisible;
+}
+
+static double toMilliseconds(uint64_t ticks) {
+    return (double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+void profileDrawOverlay(SDL_Renderer* renderer) {
+    if (!overlayVisible) return;
+
+    unsigned head = atomic_load_explicit(&frameHead, memory_order_acquire);
+    unsigned count = head < PROFILE_HISTORY ? head : PROFILE_HISTORY;
+    if (count == 0) return;
+
+    int viewW, viewH;
+    SDL_GetRendererOutputSize(renderer, &viewW, &viewH);
+    int left = 8, bottom = viewH - 8;
+    double pixelsPerMs = OVERLAY_HEIGHT / OVERLAY_SCALE_MS;
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_Rect background = { left - 4, bottom - OVERLAY_HEIGHT - 4,
+                            PROFILE_HISTORY * OVERLAY_BAR_WIDTH + 8, OVERLAY_HEIGHT + 8 };
+    SDL_RenderFillRect(renderer, &background);
+
+    // Une barre par image, zones empilées, la plus récente à droite
+    double sum = 0.0, worst = 0.0;
+    for (unsigned i = 0; i < count; i++) {
+        const FrameRecord* record = &frames[(head - count + i) & HISTORY_MASK];
+        double total = toMilliseconds(record->duration);
+        sum += total;
+        if (total > worst) worst = total;
+
+        int x = left + (int)(PROFILE_HISTORY - count + i) * OVERLAY_BAR_WIDTH;
+        int y = bottom;
+        for (int z = 0; z < PROFILE_ZONE_COUNT && y > bottom - OVERLAY_HEIGHT; z++) {
+            int h = (int)(toMilliseconds(record->zones[z]) * pixelsPerMs + 0.5);
+            if (nestedZone[z] || h <= 0) continue;
+            SDL_SetRenderDrawColor(renderer, zoneColors[z].r, zoneColors[z].g, zoneColors[z].b, 255);
+            SDL_Rect bar = { x, y - h, OVERLAY_BAR_WIDTH - 1, h };
+            SDL_RenderFillRect(renderer, &bar);
+            y -= h;
+        }
+
+        // Temps hors zones (reste de l'image) en gris clair
+        int frameTop = bottom - (int)(total * pixelsPerMs + 0.5);
+        if (frameTop < y) {
+            SDL_SetRenderDrawColor(renderer, 200, 200, 200, 120);
+            SDL_Rect rest = { x, frameTop, OVERLAY_BAR_WIDTH - 1, y - frameTop };
+            SDL_RenderFillRect(renderer, &rest);
+        }
+    }
+
+    // Repères à 60 et 30 images par seconde
+    int right = left + PROFILE_HISTORY * OVERLAY_BAR_WIDTH;
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 160);
+    SDL_RenderDrawLine(renderer, left, bottom - (int)(1000.0 / 60 * pixelsPerMs), right, bottom - (int)(1000.0 / 60 * pixelsPerMs));
+    SDL_RenderDrawLine(renderer, left, bottom - (int)(1000.0 / 30 * pixelsPerMs), right, bottom - (int)(1000.0 / 30 * pixelsPerMs));
+
+    char line[96];
+    snprintf(line, sizeof(line), "image : %.2f ms moy., %.2f ms max", sum / count, worst);
+    SDL_Color white = { 255, 255, 255, 255 };
+    textDraw(renderer, OVERLAY_FONT_SIZE, TTF_STYLE_NORMAL, line, left, bottom - OVERLAY_HEIGHT - 4 - 2 * (OVERLAY_FONT_SIZE + 4), white);
+
+    // Légende
+    int x = left;
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) {
+        if (nestedZone[z]) continue;
+        int w, h;
+        textMeasure(OVERLAY_FONT_SIZE, TTF_STYLE_NORMAL, zoneNames[z], &w, &h);
+        textDraw(renderer, OVERLAY_FONT_SIZE, TTF_STYLE_NORMAL, zoneNames[z], x, bottom - OVERLAY_HEIGHT - 4 - (OVERLAY_FONT_SIZE + 4), zoneColors[z]);
+        x += w + 8;
+    }
+}
+
+static void dumpCsv(FILE* file) {
+    unsigned head = atomic_load_explicit(&frameHead, memory_order_acquire);
+    unsigned count = head < PROFILE_HISTORY ? head : PROFILE_HISTORY;
+
+    fprintf(file, "frame,start_ms,total_ms");
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++) fprintf(file, ",%s_ms", zoneNames[z]);
+    fprintf(file, "\n");
+
+    uint64_t origin = count ? frames[(head - count) & HISTORY_MASK].start : 0;
+    for (unsigned i = 0; i < count; i++) {
+        const FrameRecord* record = &frames[(head - count + i) & HISTORY_MASK];
+        fprintf(file, "%u,%.3f,%.3f", head - count + i, toMilliseconds(record->start - origin),
+                toMilliseconds(record->duration));
+        for (int z = 0; z < PROFILE_ZONE_COUNT; z++) fprintf(file, ",%.3f", toMilliseconds(record->zones[z]));
+        fprintf(file, "\n");
+    }
+}
+
+static void dumpTrace(FILE* file) {
+    unsigned head = atomic_load_explicit(&eventHead, memory_order_acquire);
+    unsigned count = head < PROFILE_EVENT_CAPACITY ? head : PROFILE_EVENT_CAPACITY;
+    double microsPerTick = 1e6 / (double)SDL_GetPerformanceFrequency();
+
+    // Événements complets ("X") : début et durée en microsecondes
+    fprintf(file, "{\"traceEvents\":[\n");
+    uint64_t origin = UINT64_MAX;
+    for (unsigned i = 0; i < count; i++) {
+        const ZoneEvent* event = &events[(head - count + i) & EVENT_MASK];
+        if (event->start < origin) origin = event->start;
+    }
+    for (unsigned i = 0; i < count; i++) {
+        const ZoneEvent* event = &events[(head - count + i) & EVENT_MASK];
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}\n",
+                i ? "," : "", zoneNames[event->zone], event->thread,
+                (event->start - origin) * microsPerTick, (event->end - event->start) * microsPerTick);
+    }
+    fprintf(file, "]}\n");
+}
+
+bool profileDump(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        SDL_Log("Impossible d'écrire le profil : %s", path);
+        return false;
+    }
+
+    size_t length = strlen(path);
+    bool trace = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+    if (trace) dumpTrace(file);
+    else dumpCsv(file);
+    bool ok = !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    if (ok) SDL_Log("Profil écrit : %s", path);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Profileur d'images : chaque zone mesure le temps passé dans son bloc
+// (SDL_GetPerformanceCounter). Les durées s'additionnent par image, les
+// PROFILE_HISTORY dernières images sont gardées dans un anneau, affichées en
+// surimpression (F3) et écrites à la sortie (--profile=fichier.csv ou .json,
+// format Chrome trace : chrome://tracing, Perfetto).
+//
+// Sans PROFILE à la compilation (benchmarks, mapc, PROFILE=0 ./buildGame.sh),
+// les zones et les appels ne génèrent aucun code.
+
+#define PROFILE_HISTORY 256                 // images gardées (puissance de 2)
+#define PROFILE_EVENT_CAPACITY 65536        // zones gardées pour la trace (puissance de 2)
+
+typedef enum {
+    PROFILE_EVENTS,             // SDL_PollEvent
+    PROFILE_TICK,               // gameTick
+    PROFILE_MOVE_PLAYER,
+    PROFILE_ACTIVATE,
+    PROFILE_ENEMIES,            // moveEnemies
+    PROFILE_RENDER_MAP,
+    PROFILE_RENDER_MENU,
+    PROFILE_PRESENT,            // SDL_RenderPresent
+    PROFILE_WAIT,               // attente de fin d'image (sans vsync)
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+#ifdef PROFILE
+
+struct SDL_Renderer;
+
+typedef struct {
+    ProfileZone zone;
+    uint64_t start;
+} ProfileScope;
+
+uint64_t profileNow(void);
+void profileZoneEnd(ProfileScope* scope);
+
+// Mesure jusqu'à la fin du bloc englobant ; utilisable depuis n'importe quel thread
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(z) \
+    ProfileScope PROFILE_CONCAT(profileScope, __LINE__) __attribute__((cleanup(profileZoneEnd))) = { (z), profileNow() }
+
+// Thread principal uniquement
+void profileFrameBegin(void);
+void profileFrameEnd(void);
+void profileToggleOverlay(void);
+// Graphe affiché : il change à chaque image, qui doit donc être redessinée
+bool profileOverlayVisible(void);
+void profileDrawOverlay(struct SDL_Renderer* renderer);
+// CSV (une ligne par image) ou, pour un nom en .json, trace Chrome ; false si l'écriture échoue
+bool profileDump(const char* path);
+
+#else
+
+#define PROFILE_ZONE(z) ((void)0)
+#define profileFrameBegin() ((void)0)
+#define profileFrameEnd() ((void)0)
+#define profileToggleOverlay() ((void)0)
+#define profileOverlayVisible() false
+#define profileDrawOverlay(renderer) ((void)(renderer))
+static inline bool profileDump(const char* path) {
+    (void)path;
+    return true;
+}
+
+#endif
+
+#endif
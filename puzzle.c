@@ -0,0 +1,825 @@
+#include "puzzle.h"
+#include "jobs.h"
+#include "occupancy.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PUZZLE_GRAIN 256            // états développés par tâche
+#define STATE_HEADER 3              // joueur, portes ouvertes (2 mots), puis les caisses
+#define FIRST_TABLE_SIZE (1 << 12)
+
+enum {
+    CELL_WALL = 1 << 0,
+    CELL_DEAD = 1 << 1,             // aucune caisse n'en repartira vers un interrupteur relié
+    CELL_SWITCH = 1 << 2,           // interrupteur relié à un mécanisme
+};
+
+// Tampons d'un thread : marques datées, remises à zéro seulement quand le
+// compteur fait le tour
+typedef struct {
+    uint32_t* boxes;                // caisses de l'état développé
+    uint32_t* zone;                 // zone du joueur de l'état développé
+    uint32_t* child;                // zone du joueur après une poussée
+    uint32_t* cut;                  // points d'articulation de la zone
+    uint32_t* order;                // rang de visite en profondeur
+    uint32_t* low;                  // plus petit rang atteignable (Tarjan)
+    uint8_t* step;                  // prochaine direction de chaque case de la pile
+    int* queue;                     // file ou pile
+    uint32_t boxStamp, zoneStamp, childStamp, cutStamp;
+    atomic_bool busy;
+} Scratch;
+
+// États d'une couche, STATE_HEADER + boxCount mots chacun
+typedef struct {
+    uint32_t* states;
+    size_t count, capacity;
+} Layer;
+
+// Grille bordée d'un mur : les 4 voisines d'une case intérieure existent toujours
+typedef struct {
+    int stride;
+    int cells;
+    uint8_t* flags;
+    int16_t* doorAt;                // porte de la case, -1
+    int16_t* keyDoor;               // porte ouverte par la clé de la case, -1
+    uint64_t* zobrist;              // caisse sur la case, puis joueur : 2 × cells
+
+    int boxCount;
+    int stateSize;
+    int linkCount;
+    uint64_t linkDoors[MAX_LINKS];
+    uint8_t linkOp[MAX_LINKS];
+    int linkSwitchCount[MAX_LINKS];
+    int linkSwitches[MAX_LINKS][MAX_LINK_INPUTS];   // cases
+    uint64_t goal;
+    int doorNeed[PUZZLE_MAX_DOORS];     // caisses du mécanisme le moins exigeant qui l'ouvre, 0 si clé
+
+    _Atomic uint64_t* table;        // hachages, 0 : case libre
+    uint64_t tableSize;
+    atomic_uint_fast64_t stored;
+    uint64_t maxStates;
+    atomic_bool overflow;           // limite atteinte ou mémoire insuffisante
+    atomic_bool solved;
+
+    const uint32_t* frontier;
+    Layer* outputs;                 // une par tranche (jobs.h)
+    int outputCount;
+
+    Scratch scratch[JOBS_MAX_THREADS];
+} Solver;
+
+static Solver solver;
+
+// Salle courante, pour puzzleBoxPushed
+static uint8_t* roomFlags = NULL;
+static size_t roomFlagsSize = 0;
+static int roomStride = 0;
+static uint8_t* deadBoxes = NULL;
+static int deadBoxCapacity = 0;
+static int deadBoxCount = 0;
+static unsigned roomRevision = 0;
+static bool roomBuilt = false;
+static bool deadlocked = false;
+static uint8_t roomDoorNeed[MAX_LINKS][MAX_LINK_OUTPUTS];  // comme Solver.doorNeed, par porte de mécanisme
+
+
+static int cellOf(int stride, int x, int y) {
+    return (y / TILE_SIZE + 1) * stride + x / TILE_SIZE + 1;
+}
+
+// Position en pixels sur la grille : cellOf ne sort pas de la bordure
+static bool inGrid(const TileMap* tiles, int x, int y) {
+    return x >= 0 && y >= 0 && x / TILE_SIZE < tiles->width && y / TILE_SIZE < tiles->height;
+}
+
+static bool poolInGrid(const TileMap* tiles, const EntityPool* pool) {
+    for (int i = 0; i < pool->count; i++) {
+        if (!inGrid(tiles, pool->x[i], pool->y[i])) return false;
+    }
+    return true;
+}
+
+// Caisses qu'un mécanisme demande en même temps : et, un par interrupteur distinct
+static int linkBoxNeed(const Link* link) {
+    if (link->op == LINK_OR) return 1;
+
+    int distinct = 0;
+    for (int i = 0; i < link->switchCount; i++) {
+        bool seen = false;
+        for (int j = 0; j < i; j++) seen |= link->switches[j] == link->switches[i];
+        distinct += !seen;
+    }
+    return distinct;
+}
+
+// Marque CELL_DEAD les cases de sol d'où aucune caisse ne peut atteindre
+// une case CELL_SWITCH, murs seuls. Parcours à rebours depuis les
+// interrupteurs : une caisse arrive en q depuis p = q - d, le joueur
+// derrière elle en p - d.
+static bool markDeadCells(uint8_t* flags, int stride, int cells) {
+    const int offsets[4] = { -stride, -1, stride, 1 };
+    int* queue = malloc((size_t)cells * sizeof(int));
+    uint8_t* live = calloc((size_t)cells, 1);
+    if (!queue || !live) {
+        free(queue);
+        free(live);
+        return false;
+    }
+
+    int head = 0, tail = 0;
+    for (int c = 0; c < cells; c++) {
+        if (flags[c] & CELL_SWITCH) {
+            live[c] = 1;
+            queue[tail++] = c;
+        }
+    }
+    while (head < tail) {
+        int q = queue[head++];
+        for (int d = 0; d < 4; d++) {
+            int p = q - offsets[d];
+            if (live[p] || (flags[p] & CELL_WALL) || (flags[p - offsets[d]] & CELL_WALL)) continue;
+            live[p] = 1;
+            queue[tail++] = p;
+        }
+    }
+
+    for (int c = 0; c < cells; c++) {
+        if (!(flags[c] & CELL_WALL) && !live[c]) flags[c] |= CELL_DEAD;
+    }
+    free(queue);
+    free(live);
+    return true;
+}
+
+
+static uint64_t splitMix(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint32_t nextStamp(uint32_t* stamp, uint32_t* marks, int cells) {
+    if (++*stamp == 0) {
+        memset(marks, 0, (size_t)cells * sizeof(uint32_t));
+        *stamp = 1;
+    }
+    return *stamp;
+}
+
+// Au plus un tampon par thread : une tâche en prend un libre et le rend
+static Scratch* acquireScratch(Solver* s) {
+    for (int i = 0; i < JOBS_MAX_THREADS; i++) {
+        Scratch* w = &s->scratch[i];
+        if (atomic_exchange(&w->busy, true)) continue;
+
+        if (!w->boxes) {
+            w->boxes = calloc((size_t)s->cells, sizeof(uint32_t));
+            w->zone = calloc((size_t)s->cells, sizeof(uint32_t));
+            w->child = calloc((size_t)s->cells, sizeof(uint32_t));
+            w->cut = calloc((size_t)s->cells, sizeof(uint32_t));
+            w->order = malloc((size_t)s->cells * sizeof(uint32_t));
+            w->low = malloc((size_t)s->cells * sizeof(uint32_t));
+            w->step = malloc((size_t)s->cells);
+            w->queue = malloc((size_t)s->cells * sizeof(int));
+            if (!w->boxes || !w->zone || !w->child || !w->cut || !w->order || !w->low || !w->step || !w->queue) {
+                atomic_store(&w->busy, false);
+                return NULL;
+            }
+        }
+        return w;
+    }
+    return NULL;
+}
+
+static void releaseScratch(Scratch* w) {
+    atomic_store(&w->busy, false);
+}
+
+static bool passable(const Solver* s, const Scratch* w, int cell, uint64_t open) {
+    if ((s->flags[cell] & CELL_WALL) || w->boxes[cell] == w->boxStamp) return false;
+    int door = s->doorAt[cell];
+    return door < 0 || (open >> door & 1);
+}
+
+// Zone du joueur depuis start, marquée dans marks : les clés atteintes
+// ouvrent leur porte (*open). Renvoie la plus petite case de la zone,
+// position canonique du joueur.
+static int floodZone(const Solver* s, Scratch* w, uint32_t* marks, uint32_t* stamp, int start, uint64_t* open) {
+    const int offsets[4] = { -s->stride, -1, s->stride, 1 };
+
+    for (;;) {
+        uint32_t mark = nextStamp(stamp, marks, s->cells);
+        uint64_t before = *open;
+        int head = 0, tail = 0, lowest = start;
+        marks[start] = mark;
+        w->queue[tail++] = start;
+
+        while (head < tail) {
+            int cell = w->queue[head++];
+            if (cell < lowest) lowest = cell;
+            if (s->keyDoor[cell] >= 0) *open |= 1ull << s->keyDoor[cell];
+
+            for (int d = 0; d < 4; d++) {
+                int next = cell + offsets[d];
+                if (marks[next] != mark && passable(s, w, next, *open)) {
+                    marks[next] = mark;
+                    w->queue[tail++] = next;
+                }
+            }
+        }
+        // Une porte ouverte en chemin a pu être écartée avant : nouveau parcours
+        if (*open == before) return lowest;
+    }
+}
+
+// Zone du joueur d'un état normalisé (ses clés sont déjà ramassées), par
+// parcours en profondeur depuis start, avec ses points d'articulation :
+// les cases dont le retrait couperait la zone (Tarjan). Une caisse poussée
+// sur une autre case de la zone ne la coupe pas, la zone fille se déduit
+// alors de celle-ci sans nouveau parcours. lowest : les deux plus petites
+// cases de la zone.
+static void exploreZone(const Solver* s, Scratch* w, int start, uint64_t open, int lowest[2]) {
+    const int offsets[4] = { -s->stride, -1, s->stride, 1 };
+    uint32_t mark = nextStamp(&w->zoneStamp, w->zone, s->cells);
+    uint32_t cutMark = nextStamp(&w->cutStamp, w->cut, s->cells);
+    uint32_t rank = 0;
+    int depth = 1, rootChildren = 0;
+
+    lowest[0] = lowest[1] = INT32_MAX;
+    w->zone[start] = mark;
+    w->order[start] = w->low[start] = ++rank;
+    w->queue[0] = start;
+    w->step[0] = 0;
+
+    while (depth > 0) {
+        int cell = w->queue[depth - 1];
+        if (w->step[depth - 1] < 4) {
+            int next = cell + offsets[w->step[depth - 1]++];
+            if (!passable(s, w, next, open)) continue;
+            if (w->zone[next] == mark) {
+                if (w->order[next] < w->low[cell]) w->low[cell] = w->order[next];
+            } else {
+                w->zone[next] = mark;
+                w->order[next] = w->low[next] = ++rank;
+                w->queue[depth] = next;
+                w->step[depth++] = 0;
+            }
+            continue;
+        }
+
+        depth--;
+        if (cell < lowest[0]) {
+            lowest[1] = lowest[0];
+            lowest[0] = cell;
+        } else if (cell < lowest[1]) {
+            lowest[1] = cell;
+        }
+        if (depth == 0) break;
+
+        int parent = w->queue[depth - 1];
+        if (w->low[cell] < w->low[parent]) w->low[parent] = w->low[cell];
+        if (depth == 1) rootChildren++;
+        else if (w->low[cell] >= w->order[parent]) w->cut[parent] = cutMark;
+    }
+    if (rootChildren > 1) w->cut[start] = cutMark;
+}
+
+// La case libérée par une poussée dans la direction d rejoint la zone
+// sans rien lui ajouter d'autre : ses deux côtés sont dans la zone ou
+// bloqués, et elle n'a pas de clé à ramasser
+static bool sideJoinsZone(const Solver* s, const Scratch* w, int cell, int d, uint64_t open, uint32_t zoneMark) {
+    int key = s->keyDoor[cell];
+    if (key >= 0 && !(open >> key & 1)) return false;
+
+    int side = (d & 1) ? s->stride : 1;
+    return (w->zone[cell - side] == zoneMark || !passable(s, w, cell - side, open)) &&
+           (w->zone[cell + side] == zoneMark || !passable(s, w, cell + side, open));
+}
+
+// Mécanismes satisfaits par les caisses marquées : leurs portes s'ouvrent
+static uint64_t openLinks(const Solver* s, const Scratch* w, uint64_t open) {
+    for (int l = 0; l < s->linkCount; l++) {
+        if (!(s->linkDoors[l] & ~open)) continue;
+
+        bool satisfied = s->linkOp[l] == LINK_AND;
+        for (int i = 0; i < s->linkSwitchCount[l]; i++) {
+            bool covered = w->boxes[s->linkSwitches[l][i]] == w->boxStamp;
+            if (covered != satisfied) {
+                satisfied = covered;
+                break;
+            }
+        }
+        if (satisfied) open |= s->linkDoors[l];
+    }
+    return open;
+}
+
+static bool blocked(const Solver* s, const Scratch* w, int cell) {
+    return (s->flags[cell] & CELL_WALL) || w->boxes[cell] == w->boxStamp;
+}
+
+// Carré 2 × 2 de murs et de caisses : aucune de ses caisses ne bougera plus
+static bool frozen(const Solver* s, const Scratch* w, int cell) {
+    for (int dx = -1; dx <= 1; dx += 2) {
+        for (int dy = -s->stride; dy <= s->stride; dy += 2 * s->stride) {
+            if (blocked(s, w, cell + dx) && blocked(s, w, cell + dy) && blocked(s, w, cell + dx + dy))
+                return true;
+        }
+    }
+    return false;
+}
+
+// Une porte encore fermée demande plus de caisses utiles qu'il n'en reste
+static bool stateDeadlocked(const Solver* s, const Scratch* w, const uint32_t* boxes, uint64_t open) {
+    int need = 0;
+    for (uint64_t closed = s->goal & ~open; closed; closed &= closed - 1) {
+        int door = __builtin_ctzll(closed);
+        if (s->doorNeed[door] > need) need = s->doorNeed[door];
+    }
+    if (need == 0) return false;
+
+    int live = 0;
+    for (int b = 0; b < s->boxCount; b++) {
+        uint8_t flags = s->flags[boxes[b]];
+        if (flags & CELL_DEAD) continue;
+        if (!(flags & CELL_SWITCH) && frozen(s, w, boxes[b])) continue;
+        live++;
+    }
+    return live < need;
+}
+
+static uint64_t stateHash(const Solver* s, uint64_t boxHash, int player, uint64_t open) {
+    uint64_t doorHash = open * 0x9E3779B97F4A7C15ull;
+    return boxHash ^ s->zobrist[s->cells + player] ^ (doorHash ^ doorHash >> 29);
+}
+
+// true si l'état est nouveau
+static bool insertState(Solver* s, uint64_t hash) {
+    if (hash == 0) hash = 1;
+    uint64_t mask = s->tableSize - 1;
+
+    for (uint64_t i = hash & mask; ; i = (i + 1) & mask) {
+        uint64_t current = atomic_load_explicit(&s->table[i], memory_order_relaxed);
+        if (current == hash) return false;
+        if (current != 0) continue;
+
+        uint64_t expected = 0;
+        if (atomic_compare_exchange_strong_explicit(&s->table[i], &expected, hash, memory_order_relaxed,
+                                                    memory_order_relaxed)) {
+            if (atomic_fetch_add_explicit(&s->stored, 1, memory_order_relaxed) + 1 >= s->maxStates)
+                atomic_store(&s->overflow, true);
+            return true;
+        }
+        if (expected == hash) return false;
+    }
+}
+
+// Table au plus à moitié pleine après incoming insertions de plus ;
+// agrandie entre deux couches seulement, jamais pendant les insertions
+static bool reserveTable(Solver* s, uint64_t incoming) {
+    uint64_t target = atomic_load(&s->stored) + incoming;
+    if (target > s->maxStates + JOBS_MAX_THREADS) target = s->maxStates + JOBS_MAX_THREADS;
+    if (target * 2 <= s->tableSize) return true;
+
+    uint64_t size = s->tableSize ? s->tableSize : FIRST_TABLE_SIZE;
+    while (size < target * 2) size <<= 1;
+    _Atomic uint64_t* table = calloc(size, sizeof(*table));
+    if (!table) return false;
+
+    for (uint64_t i = 0; i < s->tableSize; i++) {
+        uint64_t hash = atomic_load_explicit(&s->table[i], memory_order_relaxed);
+        if (hash == 0) continue;
+        uint64_t j = hash & (size - 1);
+        while (atomic_load_explicit(&table[j], memory_order_relaxed) != 0) j = (j + 1) & (size - 1);
+        atomic_store_explicit(&table[j], hash, memory_order_relaxed);
+    }
+    free(s->table);
+    s->table = table;
+    s->tableSize = size;
+    return true;
+}
+
+static bool appendState(const Solver* s, Layer* layer, const uint32_t* state) {
+    if (layer->count == layer->capacity) {
+        size_t capacity = layer->capacity ? layer->capacity * 2 : 64;
+        uint32_t* states = realloc(layer->states, capacity * s->stateSize * sizeof(uint32_t));
+        if (!states) return false;
+        layer->states = states;
+        layer->capacity = capacity;
+    }
+    memcpy(layer->states + layer->count++ * s->stateSize, state, s->stateSize * sizeof(uint32_t));
+    return true;
+}
+
+// Développe les états [begin, end) de la couche : chaque poussée possible
+// donne un état de la couche suivante, écrit dans la sortie de la tranche
+static void expandRange(void* context, int begin, int end, int chunk) {
+    Solver* s = context;
+    const int offsets[4] = { -s->stride, -1, s->stride, 1 };
+    Layer* out = &s->outputs[chunk];
+    out->count = 0;
+
+    Scratch* w = acquireScratch(s);
+    if (!w) {
+        atomic_store(&s->overflow, true);
+        return;
+    }
+
+    uint32_t next[STATE_HEADER + PUZZLE_MAX_BOXES];
+    for (int i = begin; i < end; i++) {
+        if (atomic_load_explicit(&s->solved, memory_order_relaxed) ||
+            atomic_load_explicit(&s->overflow, memory_order_relaxed))
+            break;
+
+        const uint32_t* state = s->frontier + (size_t)i * s->stateSize;
+        const uint32_t* boxes = state + STATE_HEADER;
+        uint64_t open = state[1] | (uint64_t)state[2] << 32;
+
+        uint32_t boxMark = nextStamp(&w->boxStamp, w->boxes, s->cells);
+        uint64_t boxHash = 0;
+        for (int b = 0; b < s->boxCount; b++) {
+            w->boxes[boxes[b]] = boxMark;
+            boxHash ^= s->zobrist[boxes[b]];
+        }
+        int lowest[2];
+        exploreZone(s, w, (int)state[0], open, lowest);
+        uint32_t zoneMark = w->zoneStamp, cutMark = w->cutStamp;
+        memcpy(next, state, s->stateSize * sizeof(uint32_t));
+
+        for (int b = 0; b < s->boxCount; b++) {
+            int cell = (int)boxes[b];
+            // Caisse sur une porte fermée : le joueur ne peut pas y entrer
+            int door = s->doorAt[cell];
+            if (door >= 0 && !(open >> door & 1)) continue;
+
+            for (int d = 0; d < 4; d++) {
+                int from = cell - offsets[d], to = cell + offsets[d];
+                if (w->zone[from] != zoneMark || blocked(s, w, to)) continue;
+
+                w->boxes[cell] = 0;
+                w->boxes[to] = boxMark;
+                next[STATE_HEADER + b] = (uint32_t)to;
+
+                uint64_t childOpen = openLinks(s, w, open);
+                int player;
+                bool joins = childOpen == open && sideJoinsZone(s, w, cell, d, open, zoneMark);
+                if (joins && w->zone[to] != zoneMark) {
+                    // La zone gagne seulement la case libérée
+                    player = cell < lowest[0] ? cell : lowest[0];
+                } else if (joins && w->cut[to] != cutMark) {
+                    // ... et perd la case de la caisse, sans être coupée
+                    int remaining = to == lowest[0] ? lowest[1] : lowest[0];
+                    player = cell < remaining ? cell : remaining;
+                } else {
+                    player = floodZone(s, w, w->child, &w->childStamp, cell, &childOpen);
+                }
+                if ((childOpen & s->goal) == s->goal) {
+                    atomic_store(&s->solved, true);
+                } else if (!stateDeadlocked(s, w, next + STATE_HEADER, childOpen)) {
+                    uint64_t hash = stateHash(s, boxHash ^ s->zobrist[cell] ^ s->zobrist[to], player, childOpen);
+                    if (insertState(s, hash)) {
+                        next[0] = (uint32_t)player;
+                        next[1] = (uint32_t)childOpen;
+                        next[2] = (uint32_t)(childOpen >> 32);
+                        if (!appendState(s, out, next)) atomic_store(&s->overflow, true);
+                    }
+                }
+
+                w->boxes[to] = 0;
+                w->boxes[cell] = boxMark;
+                next[STATE_HEADER + b] = (uint32_t)cell;
+            }
+        }
+    }
+    releaseScratch(w);
+}
+
+static void solverFree(Solver* s) {
+    free(s->flags);
+    free(s->doorAt);
+    free(s->keyDoor);
+    free(s->zobrist);
+    free(s->table);
+    for (int i = 0; i < s->outputCount; i++) free(s->outputs[i].states);
+    free(s->outputs);
+    for (int i = 0; i < JOBS_MAX_THREADS; i++) {
+        free(s->scratch[i].boxes);
+        free(s->scratch[i].zone);
+        free(s->scratch[i].child);
+        free(s->scratch[i].cut);
+        free(s->scratch[i].order);
+        free(s->scratch[i].low);
+        free(s->scratch[i].step);
+        free(s->scratch[i].queue);
+    }
+    memset(s, 0, sizeof(*s));
+}
+
+// Grille, portes, clés, mécanismes et cases mortes ; *open : portes ouvertes au départ
+static bool buildSolver(Solver* s, const Room* room, uint64_t maxStates, uint64_t* open, PuzzleResult* result) {
+    int width = room->tiles.width, height = room->tiles.height;
+    if ((int64_t)(width + 2) * (height + 2) > PUZZLE_MAX_CELLS || room->boxes.count > PUZZLE_MAX_BOXES ||
+        room->doors.count > PUZZLE_MAX_DOORS || room->playerStartX < 0) {
+        LOG_WARN(LOG_ROOM, "Analyse impossible : %d × %d tuiles, %d caisses, %d portes%s", width, height,
+                 room->boxes.count, room->doors.count, room->playerStartX < 0 ? ", pas de joueur" : "");
+        return false;
+    }
+    if (!inGrid(&room->tiles, room->playerStartX * TILE_SIZE, room->playerStartY * TILE_SIZE) ||
+        !poolInGrid(&room->tiles, &room->doors) || !poolInGrid(&room->tiles, &room->keys) ||
+        !poolInGrid(&room->tiles, &room->boxes) || !poolInGrid(&room->tiles, &room->switches)) {
+        LOG_WARN(LOG_ROOM, "Analyse impossible : joueur ou entité hors de la grille");
+        return false;
+    }
+
+    s->stride = width + 2;
+    s->cells = s->stride * (height + 2);
+    s->maxStates = maxStates < INT32_MAX ? maxStates : INT32_MAX;
+    s->boxCount = room->boxes.count;
+    s->stateSize = STATE_HEADER + s->boxCount;
+    s->flags = malloc((size_t)s->cells);
+    s->doorAt = malloc((size_t)s->cells * sizeof(int16_t));
+    s->keyDoor = malloc((size_t)s->cells * sizeof(int16_t));
+    s->zobrist = malloc((size_t)s->cells * 2 * sizeof(uint64_t));
+    uint8_t* row = malloc((size_t)width);
+    if (!s->flags || !s->doorAt || !s->keyDoor || !s->zobrist || !row) {
+        free(row);
+        return false;
+    }
+
+    memset(s->flags, CELL_WALL, (size_t)s->cells);
+    for (int y = 0; y < height; y++) {
+        tileMapReadRow(&room->tiles, y, row);
+        for (int x = 0; x < width; x++) {
+            s->flags[(y + 1) * s->stride + x + 1] = row[x] == TILE_WALL ? CELL_WALL : 0;
+        }
+    }
+    free(row);
+
+    for (int c = 0; c < s->cells; c++) s->doorAt[c] = s->keyDoor[c] = -1;
+    uint64_t allDoors = 0;
+    *open = 0;
+    for (int d = 0; d < room->doors.count; d++) {
+        s->doorAt[cellOf(s->stride, room->doors.x[d], room->doors.y[d])] = (int16_t)d;
+        allDoors |= 1ull << d;
+        if (room->doors.flags[d] & ENTITY_OPEN) *open |= 1ull << d;
+    }
+    for (int k = 0; k < room->keys.count; k++) {
+        int target = room->keys.target[k];
+        if (target < 0 || target >= room->doors.count) continue;
+        s->keyDoor[cellOf(s->stride, room->keys.x[k], room->keys.y[k])] = (int16_t)target;
+        s->goal |= 1ull << target;
+    }
+
+    for (int l = 0; l < room->linkCount; l++) {
+        const Link* link = &room->links[l];
+        if (link->switchCount == 0) continue;
+
+        int index = s->linkCount++;
+        s->linkOp[index] = link->op;
+        s->linkSwitchCount[index] = link->switchCount;
+        for (int i = 0; i < link->switchCount; i++) {
+            int sw = link->switches[i];
+            int cell = cellOf(s->stride, room->switches.x[sw], room->switches.y[sw]);
+            s->linkSwitches[index][i] = cell;
+            s->flags[cell] |= CELL_SWITCH;
+        }
+        int need = linkBoxNeed(link);
+        for (int i = 0; i < link->doorCount; i++) {
+            int door = link->doors[i];
+            s->linkDoors[index] |= 1ull << door;
+            if (!(s->goal >> door & 1) || need < s->doorNeed[door]) s->doorNeed[door] = need;
+            s->goal |= 1ull << door;
+        }
+    }
+
+    result->goalDoors = __builtin_popcountll(s->goal);
+    result->lockedDoors = __builtin_popcountll(allDoors & ~s->goal & ~*open);
+    if (s->linkCount > 0 && !markDeadCells(s->flags, s->stride, s->cells)) return false;
+
+    // Même table pour toutes les salles : résultats reproductibles
+    uint64_t seed = 0x5A0B0C0DEull;
+    for (int c = 0; c < s->cells * 2; c++) s->zobrist[c] = splitMix(&seed);
+    return true;
+}
+
+void puzzleSolve(const Room* room, uint64_t maxStates, PuzzleResult* result) {
+    *result = (PuzzleResult){ .status = PUZZLE_UNKNOWN, .pushes = -1 };
+    Solver* s = &solver;
+    uint64_t open;
+    if (!buildSolver(s, room, maxStates ? maxStates : PUZZLE_DEFAULT_STATES, &open, result)) {
+        solverFree(s);
+        return;
+    }
+
+    // État de départ : caisses déjà sur des interrupteurs, clés à portée
+    uint32_t* frontier = malloc(s->stateSize * sizeof(uint32_t));
+    Scratch* w = acquireScratch(s);
+    if (!frontier || !w) {
+        free(frontier);
+        solverFree(s);
+        return;
+    }
+    uint32_t boxMark = nextStamp(&w->boxStamp, w->boxes, s->cells);
+    uint64_t boxHash = 0;
+    for (int b = 0; b < s->boxCount; b++) {
+        frontier[STATE_HEADER + b] = (uint32_t)cellOf(s->stride, room->boxes.x[b], room->boxes.y[b]);
+        w->boxes[frontier[STATE_HEADER + b]] = boxMark;
+        boxHash ^= s->zobrist[frontier[STATE_HEADER + b]];
+    }
+    open = openLinks(s, w, open);
+    int player = floodZone(s, w, w->zone, &w->zoneStamp, cellOf(s->stride, room->playerStartX * TILE_SIZE,
+                                                                room->playerStartY * TILE_SIZE), &open);
+    bool done = (open & s->goal) == s->goal;
+    bool stuck = !done && stateDeadlocked(s, w, frontier + STATE_HEADER, open);
+    releaseScratch(w);
+    frontier[0] = (uint32_t)player;
+    frontier[1] = (uint32_t)open;
+    frontier[2] = (uint32_t)(open >> 32);
+
+    size_t frontierCount = 1;
+    if (done) {
+        result->status = PUZZLE_SOLVED;
+        result->pushes = 0;
+        frontierCount = 0;
+    } else if (stuck || !reserveTable(s, 1)) {
+        frontierCount = 0;
+    } else {
+        insertState(s, stateHash(s, boxHash, player, open));
+    }
+
+    for (int depth = 0; frontierCount > 0; depth++) {
+        int count = (int)frontierCount;
+        int chunks = jobsChunkCount(count, PUZZLE_GRAIN);
+        if (!reserveTable(s, (uint64_t)frontierCount * s->boxCount * 4)) break;
+        if (chunks > s->outputCount) {
+            Layer* outputs = realloc(s->outputs, chunks * sizeof(Layer));
+            if (!outputs) break;
+            memset(outputs + s->outputCount, 0, (chunks - s->outputCount) * sizeof(Layer));
+            s->outputs = outputs;
+            s->outputCount = chunks;
+        }
+
+        s->frontier = frontier;
+        jobsParallelFor(count, PUZZLE_GRAIN, expandRange, s);
+        if (atomic_load(&s->solved)) {
+            result->status = PUZZLE_SOLVED;
+            result->pushes = depth + 1;
+            break;
+        }
+        if (atomic_load(&s->overflow)) break;
+
+        // Couche suivante, dans l'ordre des tranches
+        size_t total = 0;
+        for (int c = 0; c < chunks; c++) total += s->outputs[c].count;
+        free(frontier);
+        frontier = malloc((total ? total : 1) * s->stateSize * sizeof(uint32_t));
+        if (!frontier) break;
+        size_t offset = 0;
+        for (int c = 0; c < chunks; c++) {
+            size_t words = s->outputs[c].count * s->stateSize;
+            if (words) memcpy(frontier + offset, s->outputs[c].states, words * sizeof(uint32_t));
+            offset += words;
+        }
+        frontierCount = total;
+        if (total == 0) result->status = PUZZLE_UNSOLVABLE;
+    }
+    if (stuck) result->status = PUZZLE_UNSOLVABLE;
+
+    result->states = done || stuck ? 1 : atomic_load(&s->stored);
+    free(frontier);
+    solverFree(s);
+}
+
+
+// Cases mortes de la salle courante, bordée comme pour la recherche
+static bool rebuildRoomFlags(void) {
+    int stride = tileMap.width + 2;
+    size_t cells = (size_t)stride * (tileMap.height + 2);
+    if (cells > roomFlagsSize) {
+        uint8_t* flags = realloc(roomFlags, cells);
+        if (!flags) return false;
+        roomFlags = flags;
+        roomFlagsSize = cells;
+    }
+    if (boxes.count > deadBoxCapacity) {
+        uint8_t* dead = realloc(deadBoxes, boxes.count);
+        if (!dead) return false;
+        deadBoxes = dead;
+        deadBoxCapacity = boxes.count;
+    }
+
+    // Salle hors limites : pas de vérification en jeu
+    if (!poolInGrid(&tileMap, &boxes) || !poolInGrid(&tileMap, &switches)) return false;
+
+    roomStride = stride;
+    for (int y = -1; y <= tileMap.height; y++) {
+        for (int x = -1; x <= tileMap.width; x++) {
+            roomFlags[(y + 1) * stride + x + 1] = tileMapGet(&tileMap, x, y) == TILE_WALL ? CELL_WALL : 0;
+        }
+    }
+    for (int l = 0; l < linkCount; l++) {
+        for (int i = 0; i < links[l].switchCount; i++) {
+            int sw = links[l].switches[i];
+            roomFlags[cellOf(stride, switches.x[sw], switches.y[sw])] |= CELL_SWITCH;
+        }
+    }
+    if (!markDeadCells(roomFlags, stride, (int)cells)) return false;
+
+    // Porte ouverte par une clé : aucun mécanisme n'est nécessaire pour elle
+    for (int l = 0; l < linkCount; l++) {
+        for (int i = 0; i < links[l].doorCount; i++) {
+            int door = links[l].doors[i], need = MAX_LINK_INPUTS;
+            for (int m = 0; m < linkCount; m++) {
+                for (int j = 0; j < links[m].doorCount; j++) {
+                    if (links[m].doors[j] == door && linkBoxNeed(&links[m]) < need) need = linkBoxNeed(&links[m]);
+                }
+            }
+            for (int k = 0; k < keys.count && need > 0; k++) {
+                if (keys.target[k] == door) need = 0;
+            }
+            roomDoorNeed[l][i] = (uint8_t)need;
+        }
+    }
+
+    // Caisses déjà perdues au chargement (salle restaurée)
+    memset(deadBoxes, 0, boxes.count);
+    deadBoxCount = 0;
+    for (int i = 0; i < boxes.count; i++) {
+        if (boxes.x[i] % TILE_SIZE == 0 && boxes.y[i] % TILE_SIZE == 0 &&
+            (roomFlags[cellOf(stride, boxes.x[i], boxes.y[i])] & CELL_DEAD)) {
+            deadBoxes[i] = 1;
+            deadBoxCount++;
+        }
+    }
+    roomRevision = tileRevision;
+    roomBuilt = true;
+    deadlocked = false;
+    return true;
+}
+
+// Caisse posée exactement sur la tuile, -1 si aucune
+static int boxAtTile(int tileX, int tileY) {
+    int hits[OCCUPANCY_MAX_HITS];
+    int count = occupancyQuery(OCC_BOX, tileX * TILE_SIZE, tileY * TILE_SIZE, hits);
+    for (int h = 0; h < count; h++) {
+        if (boxes.x[hits[h]] == tileX * TILE_SIZE && boxes.y[hits[h]] == tileY * TILE_SIZE) return hits[h];
+    }
+    return -1;
+}
+
+static bool tileBlocked(int tileX, int tileY) {
+    return tileMapGet(&tileMap, tileX, tileY) == TILE_WALL || boxAtTile(tileX, tileY) >= 0;
+}
+
+static void markBoxDead(int index) {
+    if (index < 0 || deadBoxes[index]) return;
+    if (roomFlags[cellOf(roomStride, boxes.x[index], boxes.y[index])] & CELL_SWITCH) return;
+    deadBoxes[index] = 1;
+    deadBoxCount++;
+}
+
+bool puzzleBoxPushed(int index) {
+    if (linkCount == 0) return false;
+    if (!roomBuilt || roomRevision != tileRevision || boxes.count > deadBoxCapacity) {
+        if (!rebuildRoomFlags()) return false;
+    }
+
+    if (!inGrid(&tileMap, boxes.x[index], boxes.y[index])) return false;
+
+    int tileX = boxes.x[index] / TILE_SIZE, tileY = boxes.y[index] / TILE_SIZE;
+    if (roomFlags[cellOf(roomStride, boxes.x[index], boxes.y[index])] & CELL_DEAD) markBoxDead(index);
+
+    // Carrés 2 × 2 qui contiennent la caisse : figés s'ils sont pleins
+    for (int dx = -1; dx <= 1; dx += 2) {
+        for (int dy = -1; dy <= 1; dy += 2) {
+            if (!tileBlocked(tileX + dx, tileY) || !tileBlocked(tileX, tileY + dy) ||
+                !tileBlocked(tileX + dx, tileY + dy))
+                continue;
+            markBoxDead(index);
+            markBoxDead(boxAtTile(tileX + dx, tileY));
+            markBoxDead(boxAtTile(tileX, tileY + dy));
+            markBoxDead(boxAtTile(tileX + dx, tileY + dy));
+        }
+    }
+
+    int need = 0;
+    for (int l = 0; l < linkCount; l++) {
+        for (int i = 0; i < links[l].doorCount; i++) {
+            if (!(doors.flags[links[l].doors[i]] & ENTITY_OPEN) && roomDoorNeed[l][i] > need) need = roomDoorNeed[l][i];
+        }
+    }
+
+    int live = boxes.count - deadBoxCount;
+    if (live >= need) return false;
+    if (!deadlocked) {
+        LOG_WARN(LOG_GAME, "Salle bloquée : %d caisse(s) encore utile(s), un mécanisme en demande %d", live, need);
+        deadlocked = true;
+    }
+    return true;
+}
+
+bool puzzleDeadlocked(void) {
+    return deadlocked && roomBuilt && roomRevision == tileRevision;
+}
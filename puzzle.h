@@ -0,0 +1,63 @@
+#ifndef PUZZLE_H
+#define PUZZLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+// Caisses, interrupteurs et portes font de chaque salle un petit Sokoban :
+// une caisse poussée dans un angle peut rendre une porte impossible à
+// ouvrir. Ce module explore les états de poussée d'une salle (hors ligne,
+// mapcheck.c) et vérifie en jeu, après chaque poussée, que la salle
+// courante n'est pas bloquée.
+//
+// Modèle en tuiles entières : le joueur circule sur le sol hors caisses et
+// portes fermées et ramasse les clés de sa zone ; une poussée déplace une
+// caisse d'une tuile (murs et caisses l'arrêtent, pas les portes). La salle
+// est résolue quand toutes les portes qu'une clé ou un mécanisme peut
+// ouvrir sont ouvertes. Les sorties vers les salles voisines sont ignorées.
+//
+// Recherche en largeur par nombre de poussées, chaque couche développée en
+// parallèle (jobs.h) : la première couche qui contient un état résolu donne
+// le minimum. Un état (caisses, zone du joueur, portes ouvertes) n'est gardé
+// que par son hachage de Zobrist sur 64 bits dans la table de transposition ;
+// une collision, très improbable, écarterait un état.
+//
+// Élagage sûr : une caisse sur une case morte (d'où, murs seuls, elle ne
+// peut plus atteindre aucun interrupteur relié) ou figée dans un carré 2 × 2
+// de murs et de caisses hors interrupteur ne servira plus. Un état où il
+// reste moins de caisses utiles que n'en demande un mécanisme encore
+// nécessaire est abandonné.
+
+#define PUZZLE_MAX_BOXES 64
+#define PUZZLE_MAX_DOORS 64             // portes ouvertes : un masque de 64 bits
+#define PUZZLE_MAX_CELLS (1 << 22)      // tuiles, bordure comprise
+#define PUZZLE_DEFAULT_STATES (1 << 21)
+
+typedef enum {
+    PUZZLE_SOLVED,
+    PUZZLE_UNSOLVABLE,
+    PUZZLE_UNKNOWN,             // limite d'états atteinte ou salle hors limites
+} PuzzleStatus;
+
+typedef struct {
+    PuzzleStatus status;
+    int pushes;                 // minimum si PUZZLE_SOLVED, sinon -1
+    uint64_t states;            // états distincts visités
+    int goalDoors;              // portes qu'une clé ou un mécanisme ouvre
+    int lockedDoors;            // portes fermées que rien n'ouvre (ignorées)
+} PuzzleResult;
+
+// Explore la salle (aucun état global) ; maxStates : 0 pour PUZZLE_DEFAULT_STATES.
+// Un seul appel à la fois.
+void puzzleSolve(const Room* room, uint64_t maxStates, PuzzleResult* result);
+
+// En jeu, salle courante : la caisse index vient d'arriver sur une tuile.
+// true si la salle ne peut plus être résolue ; prudent, un false ne garantit
+// pas qu'elle le soit encore. Les cases mortes sont recalculées au premier
+// appel après un changement de grille (tileRevision).
+bool puzzleBoxPushed(int index);
+// Blocage détecté depuis le dernier changement de grille
+bool puzzleDeadlocked(void);
+
+#endif
@@ -0,0 +1,205 @@
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_RUN_TICKS 65536         // suite coupée au-delà : mémoire bornée à l'enregistrement
+
+// Enregistrement en cours : la suite courante est gardée en mémoire
+// jusqu'au changement d'entrées
+static FILE* recordFile = NULL;
+static const char* recordPath = NULL;
+static ReplayHeader recordHeader;
+static unsigned runInput = 0;
+static uint32_t* runHashes = NULL;
+static uint32_t runLength = 0;
+static bool recordOk = true;
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void writeRun(void) {
+    if (runLength == 0) return;
+
+    uint8_t bytes[1 + 5];
+    size_t length = 0;
+    bytes[length++] = (uint8_t)runInput;
+    for (uint32_t value = runLength; ; value >>= 7) {
+        if (value < 0x80) {
+            bytes[length++] = (uint8_t)value;
+            break;
+        }
+        bytes[length++] = (uint8_t)(value | 0x80);
+    }
+
+    recordOk = recordOk && fwrite(bytes, length, 1, recordFile) == 1 &&
+               fwrite(runHashes, sizeof(uint32_t), runLength, recordFile) == runLength;
+    runLength = 0;
+}
+
+bool replayRecordStart(const char* path, int tickRate, const Player* player) {
+    if (recordFile) return false;
+
+    if (!runHashes) runHashes = malloc(MAX_RUN_TICKS * sizeof(uint32_t));
+    recordFile = runHashes ? fopen(path, "wb") : NULL;
+    if (!recordFile) {
+        LOG_ERROR(LOG_GAME, "Impossible d'enregistrer la partie : %s", path);
+        return false;
+    }
+
+    recordPath = path;
+    memset(&recordHeader, 0, sizeof(recordHeader));
+    memcpy(recordHeader.magic, REPLAY_MAGIC, 4);
+    recordHeader.version = REPLAY_VERSION;
+    recordHeader.tickRate = (uint16_t)tickRate;
+    recordHeader.startHash = gameStateHash(player);
+    runLength = 0;
+    recordOk = fwrite(&recordHeader, sizeof(recordHeader), 1, recordFile) == 1;
+    return recordOk;
+}
+
+void replayRecordTick(unsigned input, const Player* player) {
+    if (!recordFile) return;
+
+    if (runLength > 0 && (input != runInput || runLength == MAX_RUN_TICKS)) writeRun();
+    runInput = input;
+    runHashes[runLength++] = gameStateHash(player);
+    recordHeader.tickCount++;
+}
+
+bool replayRecordStop(void) {
+    if (!recordFile) return true;
+
+    writeRun();
+    // Nombre de ticks connu seulement maintenant : en-tête réécrit
+    recordOk = recordOk && fseek(recordFile, 0, SEEK_SET) == 0 &&
+               fwrite(&recordHeader, sizeof(recordHeader), 1, recordFile) == 1;
+    recordOk = fclose(recordFile) == 0 && recordOk;
+    recordFile = NULL;
+
+    if (recordOk) LOG_INFO(LOG_GAME, "Partie enregistrée : %s (%u ticks)", recordPath, recordHeader.tickCount);
+    else LOG_ERROR(LOG_GAME, "Erreur d'écriture de l'enregistrement : %s", recordPath);
+    free(runHashes);
+    runHashes = NULL;
+    return recordOk;
+}
+
+bool replayOpen(const char* path, Replay* replay) {
+    memset(replay, 0, sizeof(*replay));
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        LOG_ERROR(LOG_GAME, "Rejeu introuvable : %s", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    bool ok = size >= (long)sizeof(ReplayHeader) && (replay->data = malloc((size_t)size)) != NULL &&
+              fread(replay->data, (size_t)size, 1, file) == 1;
+    fclose(file);
+    if (ok) {
+        memcpy(&replay->header, replay->data, sizeof(ReplayHeader));
+        ok = memcmp(replay->header.magic, REPLAY_MAGIC, 4) == 0 &&
+             replay->header.version == REPLAY_VERSION && replay->header.tickRate > 0;
+    }
+    if (!ok) {
+        LOG_ERROR(LOG_GAME, "Rejeu invalide : %s", path);
+        replayClose(replay);
+        return false;
+    }
+
+    replay->size = (size_t)size;
+    replay->offset = sizeof(ReplayHeader);
+    return true;
+}
+
+bool replayNext(Replay* replay, unsigned* input, uint32_t* expectedHash) {
+    if (replay->remaining == 0) {
+        // Suite suivante : entrées, puis nombre de ticks (varint)
+        size_t offset = replay->offset;
+        if (offset >= replay->size) return false;
+        unsigned runInput = replay->data[offset++];
+
+        uint32_t count = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (offset >= replay->size || shift > 28) return false;
+            uint8_t byte = replay->data[offset++];
+            count |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        if (count == 0 || (replay->size - offset) / sizeof(uint32_t) < count) return false;
+
+        replay->input = runInput;
+        replay->remaining = count;
+        replay->offset = offset;
+    }
+
+    *input = replay->input;
+    memcpy(expectedHash, replay->data + replay->offset, sizeof(uint32_t));
+    replay->offset += sizeof(uint32_t);
+    replay->remaining--;
+    replay->tick++;
+    return true;
+}
+
+void replayClose(Replay* replay) {
+    free(replay->data);
+    memset(replay, 0, sizeof(*replay));
+}
+
+bool replayRun(const char* path, bool realtime, ReplayResult* result) {
+    *result = (ReplayResult){ .firstMismatch = -1 };
+
+    Replay replay;
+    if (!replayOpen(path, &replay)) return false;
+
+    Player player;
+    if (!gameStart(&player)) {
+        replayClose(&replay);
+        return false;
+    }
+    if (gameStateHash(&player) != replay.header.startHash) {
+        LOG_ERROR(LOG_GAME, "Rejeu %s : le monde a changé depuis l'enregistrement", path);
+        result->firstMismatch = 0;
+        replayClose(&replay);
+        return false;
+    }
+
+    double tickDuration = 1.0 / replay.header.tickRate;
+    double start = now();
+    unsigned input;
+    uint32_t expected;
+    while (replayNext(&replay, &input, &expected)) {
+        // Temps réel : chaque tick attend son heure
+        if (realtime) {
+            double wait = start + result->ticks * tickDuration - now();
+            if (wait > 0) {
+                struct timespec delay = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+                nanosleep(&delay, NULL);
+            }
+        }
+
+        gameTick(&player, input);
+        if (gameStateHash(&player) != expected) {
+            result->firstMismatch = result->ticks;
+            LOG_ERROR(LOG_GAME, "Rejeu %s : divergence au tick %u", path, result->ticks);
+            break;
+        }
+        result->ticks++;
+    }
+    result->seconds = now() - start;
+
+    bool complete = result->firstMismatch < 0 && result->ticks == replay.header.tickCount;
+    if (result->firstMismatch < 0 && !complete) {
+        LOG_ERROR(LOG_GAME, "Rejeu %s tronqué : %u ticks sur %u", path, result->ticks, replay.header.tickCount);
+    }
+    replayClose(&replay);
+    return complete;
+}
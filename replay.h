@@ -0,0 +1,72 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+// Enregistrement et rejeu des entrées de la simulation (.czi).
+//
+// La partie ne dépend que des entrées de gameTick et du contenu des
+// salles : rejouer les entrées tick par tick depuis gameStart redonne la
+// même partie. Chaque tick enregistré porte l'empreinte de l'état qui en
+// résulte (gameStateHash) ; au rejeu, la première divergence est signalée.
+//
+// Les entrées sont groupées par suites identiques (une touche maintenue
+// donne une seule suite) :
+//
+//   ReplayHeader
+//   suites : entrées (1 octet), nombre de ticks (varint),
+//            puis une empreinte de 4 octets par tick de la suite
+//
+// Valeurs en petit-boutiste. Le numéro du tick sert d'horodatage : le
+// rejeu en temps réel les espace de 1 / tickRate seconde.
+
+#define REPLAY_MAGIC "CZIR"
+#define REPLAY_VERSION 1
+#define REPLAY_EXTENSION ".czi"
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t tickRate;          // ticks par seconde à l'enregistrement
+    uint32_t tickCount;         // complété à la fin de l'enregistrement
+    uint32_t startHash;         // état après gameStart (monde et salle de départ)
+} ReplayHeader;
+
+// Rejeu chargé en mémoire, lu suite par suite
+typedef struct {
+    ReplayHeader header;
+    uint8_t* data;
+    size_t size;
+    size_t offset;              // prochaine suite
+    unsigned input;             // entrées de la suite en cours
+    uint32_t remaining;         // ticks restants dans cette suite
+    uint32_t tick;              // ticks déjà lus
+} Replay;
+
+typedef struct {
+    uint32_t ticks;             // ticks rejoués
+    int64_t firstMismatch;      // premier tick divergent, -1 si aucun
+    double seconds;             // durée du rejeu
+} ReplayResult;
+
+// Enregistrement, après gameStart ; un seul à la fois
+bool replayRecordStart(const char* path, int tickRate, const Player* player);
+// À appeler après chaque gameTick avec ses entrées
+void replayRecordTick(unsigned input, const Player* player);
+// Écrit la dernière suite et le nombre de ticks ; false en cas d'erreur d'écriture
+bool replayRecordStop(void);
+
+bool replayOpen(const char* path, Replay* replay);
+// Entrées du tick suivant et empreinte attendue ; false à la fin du rejeu
+bool replayNext(Replay* replay, unsigned* input, uint32_t* expectedHash);
+void replayClose(Replay* replay);
+
+// Rejoue le fichier depuis gameStart, sans fenêtre : aussi vite que possible,
+// ou au rythme de l'enregistrement (realtime). Les empreintes sont vérifiées à
+// chaque tick ; false si le fichier est illisible ou si la partie diverge.
+bool replayRun(const char* path, bool realtime, ReplayResult* result);
+
+#endif
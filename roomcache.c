@@ -0,0 +1,140 @@
+#include "roomcache.h"
+#include <stdlib.h>
+
+typedef struct {
+    int x, y;
+    bool used;
+    unsigned lastUse;
+    size_t heapBytes;       // grille et entités de la salle, hors entrée
+    Room room;
+} CachedRoom;
+
+static CachedRoom* entries = NULL;
+static size_t capacity = 0;
+static size_t budget = 0;
+static size_t usedBytes = 0;
+static unsigned useClock = 0;
+static bool configured = false;
+
+
+// L'entrée ne compte plus ; sa grille et ses entités restent allouées
+static void forget(CachedRoom* entry) {
+    if (!entry->used) return;
+
+    usedBytes -= sizeof(CachedRoom) + entry->heapBytes;
+    entry->used = false;
+    entry->heapBytes = 0;
+}
+
+// Entrée sortie du cache : sa mémoire est rendue. Une entrée libre n'a
+// rien d'alloué, le vidage ne parcourt que les entrées utilisées
+static void release(CachedRoom* entry) {
+    if (!entry->used) return;
+
+    forget(entry);
+    roomFree(&entry->room);
+}
+
+void roomCacheSetBudget(size_t bytes) {
+    size_t count = bytes / sizeof(CachedRoom);
+
+    if (count != capacity) {
+        for (size_t i = 0; i < capacity; i++) {
+            roomFree(&entries[i].room);
+        }
+        free(entries);
+        entries = count ? calloc(count, sizeof(CachedRoom)) : NULL;
+        capacity = entries ? count : 0;
+    }
+
+    budget = bytes;
+    configured = true;
+    roomCacheClear();
+}
+
+size_t roomCacheCapacity(void) {
+    return capacity;
+}
+
+void roomCacheClear(void) {
+    for (size_t i = 0; i < capacity; i++) {
+        release(&entries[i]);
+    }
+    usedBytes = 0;
+    useClock = 0;
+}
+
+void roomCacheShutdown(void) {
+    for (size_t i = 0; i < capacity; i++) {
+        roomFree(&entries[i].room);
+    }
+    free(entries);
+    entries = NULL;
+    capacity = 0;
+    usedBytes = 0;
+    configured = false;
+}
+
+
+static CachedRoom* findEntry(int x, int y) {
+    for (size_t i = 0; i < capacity; i++) {
+        if (entries[i].used && entries[i].x == x && entries[i].y == y)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+static CachedRoom* leastRecentlyUsed(const CachedRoom* except) {
+    CachedRoom* oldest = NULL;
+    for (size_t i = 0; i < capacity; i++) {
+        CachedRoom* entry = &entries[i];
+        if (entry->used && entry != except && (!oldest || entry->lastUse < oldest->lastUse))
+            oldest = entry;
+    }
+    return oldest;
+}
+
+const Room* roomCacheFind(int x, int y) {
+    CachedRoom* entry = findEntry(x, y);
+    if (!entry) return NULL;
+
+    entry->lastUse = ++useClock;
+    return &entry->room;
+}
+
+bool roomCacheContains(int x, int y) {
+    return findEntry(x, y) != NULL;
+}
+
+void roomCacheSave(int x, int y) {
+    if (!configured) roomCacheSetBudget(ROOM_CACHE_DEFAULT_BUDGET);
+    if (capacity == 0) return;
+
+    CachedRoom* entry = findEntry(x, y);
+
+    // Entrée libre, sinon la moins récemment utilisée
+    for (size_t i = 0; i < capacity && !entry; i++) {
+        if (!entries[i].used) entry = &entries[i];
+    }
+    if (!entry) entry = leastRecentlyUsed(NULL);
+
+    // L'entrée reprise garde sa mémoire : recopiée en place par captureRoom
+    forget(entry);
+    captureRoom(&entry->room);
+    entry->x = x;
+    entry->y = y;
+    entry->used = true;
+    entry->lastUse = ++useClock;
+    entry->heapBytes = tileMapBytes(&entry->room.tiles) +
+                       entityBytes(&entry->room.enemies) + entityBytes(&entry->room.keys) +
+                       entityBytes(&entry->room.doors) + entityBytes(&entry->room.boxes) +
+                       entityBytes(&entry->room.switches);
+    usedBytes += sizeof(CachedRoom) + entry->heapBytes;
+
+    // Les grandes salles comptent pour leur grille : d'autres entrées sortent
+    CachedRoom* victim;
+    while (usedBytes > budget && (victim = leastRecentlyUsed(entry)) != NULL) {
+        release(victim);
+    }
+    if (usedBytes > budget) release(entry);
+}
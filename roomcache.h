@@ -0,0 +1,33 @@
+#ifndef ROOMCACHE_H
+#define ROOMCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "game.h"
+
+// État des salles déjà visitées, indexé par coordonnées dans le monde :
+// caisses déplacées, portes ouvertes, clés ramassées, interrupteurs.
+// Revenir dans une salle restaure cet état au lieu de relire le fichier.
+//
+// Le cache est borné par un budget mémoire qui compte les entrées et les
+// grilles (une grande salle peut en faire sortir plusieurs petites). Les
+// entrées sont allouées une fois pour toutes ; la moins récemment utilisée
+// est recyclée quand le budget est dépassé. Une salle qui sort du cache
+// (ou un cache vidé) rend sa grille et ses entités.
+
+#define ROOM_CACHE_DEFAULT_BUDGET (1024 * 1024)   // octets, ~300 salles d'un écran
+
+// Budget en octets ; 0 désactive le cache. Vide le cache.
+void roomCacheSetBudget(size_t bytes);
+size_t roomCacheCapacity(void);                 // nombre de salles gardées
+void roomCacheClear(void);
+void roomCacheShutdown(void);
+
+// Salle gardée pour (x, y), ou NULL
+const Room* roomCacheFind(int x, int y);
+bool roomCacheContains(int x, int y);
+// Enregistre l'état de la salle courante sous (x, y) ; sans effet si le
+// cache est désactivé ou si la salle dépasse à elle seule le budget
+void roomCacheSave(int x, int y);
+
+#endif
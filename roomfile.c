@@ -0,0 +1,382 @@
+#include "roomfile.h"
+#include "game.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Le format .czr est lu tel quel : machine petit-boutiste requise"
+#endif
+
+_Static_assert(sizeof(RoomFileHeader) == 72, "RoomFileHeader doit rester de taille fixe");
+_Static_assert(sizeof(RoomFileEntity) == 4, "RoomFileEntity doit rester de taille fixe");
+_Static_assert(sizeof(RoomFileKey) == 8, "RoomFileKey doit rester de taille fixe");
+_Static_assert(sizeof(RoomFileLink) == 4 + MAX_LINK_INPUTS + MAX_LINK_OUTPUTS, "RoomFileLink doit rester de taille fixe");
+
+
+bool roomBinaryPath(const char* textPath, char* out, size_t size) {
+    const char* dot = strrchr(textPath, '.');
+    const char* slash = strrchr(textPath, '/');
+    size_t stem = (dot && (!slash || dot > slash)) ? (size_t)(dot - textPath) : strlen(textPath);
+
+    if (stem + strlen(ROOMFILE_EXTENSION) + 1 > size)
+        return false;
+
+    memcpy(out, textPath, stem);
+    strcpy(out + stem, ROOMFILE_EXTENSION);
+    return true;
+}
+
+bool roomBinaryIsFresh(const char* textPath, const char* binaryPath) {
+    struct stat binaryInfo, textInfo;
+
+    if (stat(binaryPath, &binaryInfo) != 0)
+        return false;
+    if (stat(textPath, &textInfo) != 0)
+        return true;   // source absente : seule la version compilée est livrée
+
+    return binaryInfo.st_mtime >= textInfo.st_mtime;
+}
+
+
+// Une section [offset, offset + count * size) doit tenir dans le fichier
+static bool sectionFits(uint32_t offset, uint32_t count, size_t size, size_t fileSize) {
+    return offset <= fileSize && (uint64_t)count * size <= fileSize - offset;
+}
+
+// Positions d'une table d'entités (RoomFileEntity ou RoomFileKey, x et y
+// en tête) dans la grille
+static bool entitiesFit(const uint8_t* data, uint32_t offset, uint32_t count, size_t size,
+                        const RoomFileHeader* header) {
+    for (uint32_t i = 0; i < count; i++) {
+        const RoomFileEntity* e = (const RoomFileEntity*)(data + offset + (size_t)i * size);
+        if (e->x >= header->width || e->y >= header->height) return false;
+    }
+    return true;
+}
+
+// Projections conservées d'un chargement à l'autre : revenir dans une salle
+// ne coûte ni appel système ni validation, seulement les copies.
+typedef struct {
+    char key[256];            // chemin demandé (texte ou .czr)
+    const uint8_t* data;      // NULL : pas de version compilée utilisable
+    size_t size;
+    uint32_t lastUse;
+} MappedRoom;
+
+static MappedRoom mappedRooms[ROOMFILE_CACHE_SIZE];
+static uint32_t mappedClock = 0;
+static pthread_mutex_t mappedLock = PTHREAD_MUTEX_INITIALIZER;   // lectures depuis le préchargeur
+
+static uint32_t chunkCount(const RoomFileHeader* header) {
+    uint32_t chunksX = ((uint32_t)header->width + CHUNK_MASK) >> CHUNK_SHIFT;
+    uint32_t chunksY = ((uint32_t)header->height + CHUNK_MASK) >> CHUNK_SHIFT;
+    return chunksX * chunksY;
+}
+
+// Chaque tronçon stocké doit tenir dans le fichier
+static bool chunksFit(const uint8_t* data, const RoomFileHeader* header, size_t fileSize) {
+    const uint32_t* table = (const uint32_t*)(data + header->tilesOffset);
+    for (uint32_t i = 0; i < chunkCount(header); i++) {
+        if (table[i] == ROOMFILE_CHUNK_GROUND || table[i] == ROOMFILE_CHUNK_WALL) continue;
+        if (!sectionFits(table[i], 1, sizeof(Chunk), fileSize)) return false;
+    }
+    return true;
+}
+
+static const uint8_t* mapAndValidate(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(RoomFileHeader)) {
+        LOG_WARN(LOG_ROOM, "Fichier de salle invalide : %s", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t fileSize = (size_t)info.st_size;
+    const uint8_t* data = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOG_WARN(LOG_ROOM, "mmap impossible pour %s", path);
+        return NULL;
+    }
+
+    const RoomFileHeader* header = (const RoomFileHeader*)data;
+    bool valid = memcmp(header->magic, ROOMFILE_MAGIC, 4) == 0 &&
+                 header->version == ROOMFILE_VERSION &&
+                 header->headerSize == sizeof(RoomFileHeader) &&
+                 header->fileSize == fileSize &&
+                 header->width > 0 && header->width <= MAX_MAP_SIDE &&
+                 header->height > 0 && header->height <= MAX_MAP_SIDE &&
+                 header->tilesOffset % 4 == 0 &&
+                 sectionFits(header->tilesOffset, chunkCount(header), sizeof(uint32_t), fileSize) &&
+                 sectionFits(header->enemyOffset, header->enemyCount, sizeof(RoomFileEntity), fileSize) &&
+                 sectionFits(header->keyOffset, header->keyCount, sizeof(RoomFileKey), fileSize) &&
+                 sectionFits(header->doorOffset, header->doorCount, sizeof(RoomFileEntity), fileSize) &&
+                 sectionFits(header->boxOffset, header->boxCount, sizeof(RoomFileEntity), fileSize) &&
+                 sectionFits(header->switchOffset, header->switchCount, sizeof(RoomFileEntity), fileSize) &&
+                 sectionFits(header->linkOffset, header->linkCount, sizeof(RoomFileLink), fileSize);
+
+    // Entités et départ hors de la grille : la salle est refusée (une seule
+    // fois, la projection est gardée)
+    bool noStart = valid && header->playerStartX == -1 && header->playerStartY == -1;
+    bool startFits = valid && header->playerStartX >= 0 && header->playerStartX < header->width &&
+                     header->playerStartY >= 0 && header->playerStartY < header->height;
+    valid = valid && (noStart || startFits) && chunksFit(data, header, fileSize) &&
+            entitiesFit(data, header->enemyOffset, header->enemyCount, sizeof(RoomFileEntity), header) &&
+            entitiesFit(data, header->keyOffset, header->keyCount, sizeof(RoomFileKey), header) &&
+            entitiesFit(data, header->doorOffset, header->doorCount, sizeof(RoomFileEntity), header) &&
+            entitiesFit(data, header->boxOffset, header->boxCount, sizeof(RoomFileEntity), header) &&
+            entitiesFit(data, header->switchOffset, header->switchCount, sizeof(RoomFileEntity), header);
+
+    if (!valid) {
+        LOG_WARN(LOG_ROOM, "En-tête de salle invalide ou version incompatible : %s", path);
+        munmap((void*)data, fileSize);
+        return NULL;
+    }
+
+    *size = fileSize;
+    return data;
+}
+
+// fromText : key est un fichier texte, on cherche sa version compilée à jour.
+// Les absences sont mémorisées aussi, pour ne pas refaire les stat().
+static const uint8_t* findMappedRoom(const char* key, bool fromText) {
+    MappedRoom* slot = NULL;
+
+    for (int i = 0; i < ROOMFILE_CACHE_SIZE; i++) {
+        MappedRoom* m = &mappedRooms[i];
+        if (m->key[0] && strcmp(m->key, key) == 0) {
+            m->lastUse = ++mappedClock;
+            return m->data;
+        }
+        if (!slot || (slot->key[0] && (!m->key[0] || m->lastUse < slot->lastUse))) slot = m;
+    }
+
+    if (strlen(key) >= sizeof(slot->key))
+        return NULL;
+
+    const uint8_t* data = NULL;
+    size_t size = 0;
+    if (fromText) {
+        char binaryPath[256];
+        if (roomBinaryPath(key, binaryPath, sizeof(binaryPath)) && roomBinaryIsFresh(key, binaryPath)) {
+            data = mapAndValidate(binaryPath, &size);
+        }
+    } else {
+        data = mapAndValidate(key, &size);
+        if (!data) LOG_ERROR(LOG_ROOM, "Impossible de charger %s", key);
+    }
+
+    if (slot->data) munmap((void*)slot->data, slot->size);
+    strcpy(slot->key, key);
+    slot->data = data;
+    slot->size = size;
+    slot->lastUse = ++mappedClock;
+    return data;
+}
+
+void roomFileCacheClear(void) {
+    pthread_mutex_lock(&mappedLock);
+    for (int i = 0; i < ROOMFILE_CACHE_SIZE; i++) {
+        if (mappedRooms[i].data) munmap((void*)mappedRooms[i].data, mappedRooms[i].size);
+    }
+    memset(mappedRooms, 0, sizeof(mappedRooms));
+    pthread_mutex_unlock(&mappedLock);
+}
+
+// Positions en tuiles du fichier → entités en pixels
+static bool addEntities(EntityPool* pool, const RoomFileEntity* e, uint32_t count, uint8_t flags) {
+    if (!entityReserve(pool, (int)count)) return false;
+    for (uint32_t i = 0; i < count; i++) {
+        entityAdd(pool, e[i].x * TILE_SIZE, e[i].y * TILE_SIZE, flags);
+    }
+    return true;
+}
+
+static bool copyRoomFile(const uint8_t* data, Room* room) {
+    const RoomFileHeader* header = (const RoomFileHeader*)data;
+
+    roomClear(room);
+
+    // Les tronçons uniformes restent partagés, les autres sont déjà au
+    // format mémoire du jeu : une copie chacun
+    if (!tileMapInit(&room->tiles, header->width, header->height))
+        return false;
+    const uint32_t* table = (const uint32_t*)(data + header->tilesOffset);
+    for (uint32_t i = 0; i < chunkCount(header); i++) {
+        if (table[i] == ROOMFILE_CHUNK_GROUND) continue;
+        if (table[i] == ROOMFILE_CHUNK_WALL) {
+            tileMapShareChunk(&room->tiles, (int)i, TILE_WALL);
+        } else if (!tileMapSetChunk(&room->tiles, (int)i, (const Chunk*)(data + table[i]))) {
+            return false;
+        }
+    }
+
+    room->playerStartX = header->playerStartX;
+    room->playerStartY = header->playerStartY;
+
+    const RoomFileKey* k = (const RoomFileKey*)(data + header->keyOffset);
+    if (!entityReserve(&room->keys, (int)header->keyCount)) return false;
+    for (uint32_t i = 0; i < header->keyCount; i++) {
+        int key = entityAdd(&room->keys, k[i].x * TILE_SIZE, k[i].y * TILE_SIZE, 0);
+        room->keys.target[key] = k[i].doorIndex;
+    }
+
+    if (!addEntities(&room->enemies, (const RoomFileEntity*)(data + header->enemyOffset), header->enemyCount, 0) ||
+        !addEntities(&room->doors, (const RoomFileEntity*)(data + header->doorOffset), header->doorCount, 0) ||
+        !addEntities(&room->boxes, (const RoomFileEntity*)(data + header->boxOffset), header->boxCount, ENTITY_ACTIVE) ||
+        !addEntities(&room->switches, (const RoomFileEntity*)(data + header->switchOffset), header->switchCount, ENTITY_ACTIVE))
+        return false;
+
+    // Mécanismes invalides (indices hors salle) ignorés un par un
+    const RoomFileLink* links = (const RoomFileLink*)(data + header->linkOffset);
+    for (uint32_t i = 0; i < header->linkCount && room->linkCount < MAX_LINKS; i++) {
+        const RoomFileLink* l = &links[i];
+        bool valid = l->op <= LINK_AND &&
+                     l->switchCount > 0 && l->switchCount <= MAX_LINK_INPUTS &&
+                     l->doorCount > 0 && l->doorCount <= MAX_LINK_OUTPUTS;
+        for (int j = 0; valid && j < l->switchCount; j++) valid = l->switches[j] < room->switches.count;
+        for (int j = 0; valid && j < l->doorCount; j++) valid = l->doors[j] < room->doors.count;
+        if (!valid) continue;
+
+        Link* link = &room->links[room->linkCount++];
+        *link = (Link){ .op = l->op, .switchCount = l->switchCount, .doorCount = l->doorCount };
+        memcpy(link->switches, l->switches, sizeof(link->switches));
+        memcpy(link->doors, l->doors, sizeof(link->doors));
+    }
+    return true;
+}
+
+// La copie se fait sous le verrou : une autre lecture pourrait sinon
+// libérer la projection pendant qu'on la parcourt
+static bool readMapped(const char* key, bool fromText, Room* room) {
+    pthread_mutex_lock(&mappedLock);
+    const uint8_t* data = findMappedRoom(key, fromText);
+    bool ok = data && copyRoomFile(data, room);
+    pthread_mutex_unlock(&mappedLock);
+
+    return ok;
+}
+
+bool readRoomBinary(const char* path, Room* room) {
+    return readMapped(path, false, room);
+}
+
+bool readRoomCompiled(const char* textPath, Room* room) {
+    return readMapped(textPath, true, room);
+}
+
+
+static bool writeEntities(FILE* file, uint32_t offset, const EntityPool* pool) {
+    if (fseek(file, offset, SEEK_SET) != 0) return false;
+
+    for (int i = 0; i < pool->count; i++) {
+        RoomFileEntity record = { (uint16_t)(pool->x[i] / TILE_SIZE), (uint16_t)(pool->y[i] / TILE_SIZE) };
+        if (fwrite(&record, sizeof(record), 1, file) != 1) return false;
+    }
+    return true;
+}
+
+bool writeRoomBinary(const char* path, const Room* room) {
+    RoomFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROOMFILE_MAGIC, 4);
+    header.version = ROOMFILE_VERSION;
+    header.headerSize = sizeof(RoomFileHeader);
+    header.width = (uint16_t)room->tiles.width;
+    header.height = (uint16_t)room->tiles.height;
+    header.playerStartX = (int16_t)room->playerStartX;
+    header.playerStartY = (int16_t)room->playerStartY;
+
+    // Table des tronçons, puis les tronçons non uniformes à la suite
+    uint32_t chunks = chunkCount(&header);
+    uint32_t* table = malloc(chunks * sizeof(uint32_t));
+    if (!table) return false;
+
+    uint32_t offset = sizeof(RoomFileHeader);
+    header.tilesOffset = offset;
+    offset += chunks * sizeof(uint32_t);
+    for (uint32_t i = 0; i < chunks; i++) {
+        int value = tileMapUniformChunk(&room->tiles, (int)i);
+        if (value == TILE_GROUND) {
+            table[i] = ROOMFILE_CHUNK_GROUND;
+        } else if (value == TILE_WALL) {
+            table[i] = ROOMFILE_CHUNK_WALL;
+        } else {
+            table[i] = offset;
+            offset += sizeof(Chunk);
+        }
+    }
+    header.enemyOffset = offset;  header.enemyCount = room->enemies.count;
+    offset += room->enemies.count * sizeof(RoomFileEntity);
+    header.keyOffset = offset;    header.keyCount = room->keys.count;
+    offset += room->keys.count * sizeof(RoomFileKey);
+    header.doorOffset = offset;   header.doorCount = room->doors.count;
+    offset += room->doors.count * sizeof(RoomFileEntity);
+    header.boxOffset = offset;    header.boxCount = room->boxes.count;
+    offset += room->boxes.count * sizeof(RoomFileEntity);
+    header.switchOffset = offset; header.switchCount = room->switches.count;
+    offset += room->switches.count * sizeof(RoomFileEntity);
+    header.linkOffset = offset;   header.linkCount = room->linkCount;
+    offset += room->linkCount * sizeof(RoomFileLink);
+    header.fileSize = offset;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        LOG_ERROR(LOG_ROOM, "Impossible d'écrire %s", path);
+        free(table);
+        return false;
+    }
+
+    // Les fseek des sections laissent des zéros dans les octets d'alignement
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(table, sizeof(uint32_t), chunks, file) == chunks;
+    for (uint32_t i = 0; i < chunks && ok; i++) {
+        if (table[i] == ROOMFILE_CHUNK_GROUND || table[i] == ROOMFILE_CHUNK_WALL) continue;
+        ok = fwrite(room->tiles.chunks[i], sizeof(Chunk), 1, file) == 1;
+    }
+    free(table);
+
+    ok = ok && writeEntities(file, header.enemyOffset, &room->enemies);
+
+    if (ok && fseek(file, header.keyOffset, SEEK_SET) == 0) {
+        for (int i = 0; i < room->keys.count && ok; i++) {
+            RoomFileKey record = {
+                (uint16_t)(room->keys.x[i] / TILE_SIZE), (uint16_t)(room->keys.y[i] / TILE_SIZE),
+                room->keys.target[i], 0
+            };
+            ok = fwrite(&record, sizeof(record), 1, file) == 1;
+        }
+    }
+
+    ok = ok && writeEntities(file, header.doorOffset, &room->doors) &&
+               writeEntities(file, header.boxOffset, &room->boxes) &&
+               writeEntities(file, header.switchOffset, &room->switches);
+
+    if (ok && fseek(file, header.linkOffset, SEEK_SET) == 0) {
+        for (int i = 0; i < room->linkCount && ok; i++) {
+            const Link* l = &room->links[i];
+            RoomFileLink record = { l->op, l->switchCount, l->doorCount, 0, { 0 }, { 0 } };
+            memcpy(record.switches, l->switches, sizeof(record.switches));
+            memcpy(record.doors, l->doors, sizeof(record.doors));
+            ok = fwrite(&record, sizeof(record), 1, file) == 1;
+        }
+    }
+
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        LOG_ERROR(LOG_ROOM, "Erreur d'écriture %s", path);
+        remove(path);
+    }
+    return ok;
+}
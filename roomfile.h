@@ -0,0 +1,84 @@
+#ifndef ROOMFILE_H
+#define ROOMFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+// Format binaire compilé des salles (.czr), produit hors ligne par mapc
+// à partir des fichiers texte world/*.txt. Toutes les valeurs sont en
+// petit-boutiste et de taille fixe : le fichier est projeté en mémoire
+// (mmap) une seule fois et ses tables sont copiées telles quelles, sans analyse.
+//
+//   RoomFileHeader
+//   tuiles   : table de tronçons (un uint32 par tronçon CHUNK_SIZE², ligne
+//              par ligne) puis les tronçons non uniformes, un Chunk chacun
+//   ennemis, clés, portes, caisses, interrupteurs : RoomFileEntity / RoomFileKey
+//   mécanismes : RoomFileLink (interrupteurs → portes, ET / OU)
+//
+// Chaque section commence sur un multiple de 4 octets. Les tronçons
+// uniformes (tout sol, tout mur) ne sont pas stockés : au chargement ils
+// pointent vers les tronçons partagés de la grille, seuls les autres sont
+// copiés.
+
+#define ROOMFILE_MAGIC "CZRM"
+#define ROOMFILE_VERSION 3
+#define ROOMFILE_EXTENSION ".czr"
+#define ROOMFILE_CACHE_SIZE 32   // salles gardées projetées en mémoire
+
+// Entrées de la table des tronçons ; toute autre valeur est la position
+// du Chunk dans le fichier
+#define ROOMFILE_CHUNK_GROUND 0
+#define ROOMFILE_CHUNK_WALL 1
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint16_t width, height;
+    int16_t playerStartX, playerStartY;   // en tuiles, -1 si absent
+    uint32_t fileSize;
+    uint32_t tilesOffset;                 // table des tronçons
+    uint32_t enemyOffset, enemyCount;
+    uint32_t keyOffset, keyCount;
+    uint32_t doorOffset, doorCount;
+    uint32_t boxOffset, boxCount;
+    uint32_t switchOffset, switchCount;
+    uint32_t linkOffset, linkCount;
+} RoomFileHeader;
+
+typedef struct {
+    uint16_t x, y;          // en tuiles
+} RoomFileEntity;
+
+typedef struct {
+    uint16_t x, y;
+    int16_t doorIndex;      // -1 : n'ouvre aucune porte
+    uint16_t reserved;
+} RoomFileKey;
+
+typedef struct {
+    uint8_t op;             // LinkOp
+    uint8_t switchCount;
+    uint8_t doorCount;
+    uint8_t reserved;
+    uint8_t switches[MAX_LINK_INPUTS];
+    uint8_t doors[MAX_LINK_OUTPUTS];
+} RoomFileLink;
+
+// Chemin .czr correspondant à un fichier texte (world/map_1_1.txt → world/map_1_1.czr)
+bool roomBinaryPath(const char* textPath, char* out, size_t size);
+// Vrai si la version compilée existe et n'est pas plus ancienne que le texte
+bool roomBinaryIsFresh(const char* textPath, const char* binaryPath);
+
+// Lit une salle compilée (utilisable depuis n'importe quel thread)
+bool readRoomBinary(const char* path, Room* room);
+// Lit la version compilée d'une salle texte si elle existe et est à jour
+bool readRoomCompiled(const char* textPath, Room* room);
+// Libère les projections (après recompilation des salles par exemple)
+void roomFileCacheClear(void);
+// Écrit une salle au format compilé
+bool writeRoomBinary(const char* path, const Room* room);
+
+#endif
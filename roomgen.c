@@ -0,0 +1,516 @@
+#include "roomgen.h"
+#include "jobs.h"
+#include "roomfile.h"
+#include "trigger.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PLACEMENT_TRIES 64          // tirages par entité avant d'abandonner
+#define WORLD_GRAIN 16              // salles par tâche
+#define LINK_LINE_MAX 96
+
+// Générateur pseudo-aléatoire (splitmix64) : un par salle, aucun état partagé
+typedef struct {
+    uint64_t state;
+} GenRandom;
+
+// Salle en cours de génération : glyphes de la grammaire texte
+typedef struct {
+    uint8_t* cells;
+    int width, height;
+    GenRandom random;
+    char links[MAX_LINKS][LINK_LINE_MAX];
+    int linkCount;
+} Grid;
+
+static const int stepX[4] = { 0, -1, 0, 1 };   // haut, gauche, bas, droite
+static const int stepY[4] = { -1, 0, 1, 0 };
+
+
+static uint64_t nextRandom(GenRandom* random) {
+    uint64_t z = (random->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Entier dans [0, n)
+static uint32_t randomBelow(GenRandom* random, uint32_t n) {
+    return (uint32_t)(((nextRandom(random) >> 32) * n) >> 32);
+}
+
+static uint8_t* cellAt(Grid* grid, int x, int y) {
+    return &grid->cells[(size_t)y * grid->width + x];
+}
+
+// Labyrinthe parfait par parcours en profondeur, sans pile : chaque case
+// visitée garde le sens du retour vers sa parente ('a' + direction, 'o'
+// pour la première), remplacé par du sol à la fin
+static void carveMaze(Grid* grid) {
+    int cellsX = (grid->width - 1) / 2, cellsY = (grid->height - 1) / 2;
+    int cx = (int)randomBelow(&grid->random, cellsX);
+    int cy = (int)randomBelow(&grid->random, cellsY);
+    *cellAt(grid, 2 * cx + 1, 2 * cy + 1) = 'o';
+
+    for (;;) {
+        int options[4], count = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + stepX[d], ny = cy + stepY[d];
+            if (nx >= 0 && ny >= 0 && nx < cellsX && ny < cellsY && *cellAt(grid, 2 * nx + 1, 2 * ny + 1) == '#')
+                options[count++] = d;
+        }
+
+        if (count > 0) {
+            int d = options[randomBelow(&grid->random, count)];
+            *cellAt(grid, 2 * cx + 1 + stepX[d], 2 * cy + 1 + stepY[d]) = '.';
+            cx += stepX[d];
+            cy += stepY[d];
+            *cellAt(grid, 2 * cx + 1, 2 * cy + 1) = (uint8_t)('a' + ((d + 2) & 3));
+        } else {
+            uint8_t back = *cellAt(grid, 2 * cx + 1, 2 * cy + 1);
+            if (back == 'o') break;
+            cx += stepX[back - 'a'];
+            cy += stepY[back - 'a'];
+        }
+    }
+
+    size_t total = (size_t)grid->width * grid->height;
+    for (size_t i = 0; i < total; i++) {
+        if (grid->cells[i] != '#') grid->cells[i] = '.';
+    }
+}
+
+// Murs entre deux cases percés au hasard : plusieurs chemins, des boucles
+static void openLoops(Grid* grid, int percent) {
+    if (percent <= 0) return;
+
+    for (int y = 1; y < grid->height - 1; y++) {
+        for (int x = 1 + (y & 1); x < grid->width - 1; x += 2) {
+            // Exactement une coordonnée paire : mur entre deux cases
+            if (*cellAt(grid, x, y) == '#' && (int)randomBelow(&grid->random, 100) < percent)
+                *cellAt(grid, x, y) = '.';
+        }
+    }
+}
+
+// Couloir : murs des deux côtés, passage dans l'autre sens (une porte y barre le chemin)
+static bool isCorridor(Grid* grid, int x, int y) {
+    if (x <= 0 || y <= 0 || x >= grid->width - 1 || y >= grid->height - 1) return false;
+
+    bool wallsX = *cellAt(grid, x - 1, y) == '#' && *cellAt(grid, x + 1, y) == '#';
+    bool wallsY = *cellAt(grid, x, y - 1) == '#' && *cellAt(grid, x, y + 1) == '#';
+    return wallsX != wallsY;
+}
+
+// Tuile de sol libre et permise au hasard, -1 s'il n'y en a pas
+static int pickAllowed(Grid* grid, const uint8_t* allowed) {
+    size_t total = (size_t)grid->width * grid->height;
+    uint32_t candidates = 0;
+    for (size_t i = 0; i < total; i++) candidates += grid->cells[i] == '.' && allowed[i];
+    if (candidates == 0) return -1;
+
+    uint32_t pick = randomBelow(&grid->random, candidates);
+    for (size_t i = 0; i < total; i++) {
+        if (grid->cells[i] == '.' && allowed[i] && pick-- == 0) return (int)i;
+    }
+    return -1;
+}
+
+// Pose jusqu'à count glyphes sur des tuiles de sol libres ; nombre posé.
+// allowed : tuiles permises (non nul), NULL pour toutes
+static int place(Grid* grid, uint8_t glyph, int count, bool corridors, const uint8_t* allowed) {
+    uint32_t total = (uint32_t)grid->width * grid->height;
+    int placed = 0;
+
+    for (; placed < count; placed++) {
+        bool done = false;
+        for (int attempt = 0; attempt < 2 * PLACEMENT_TRIES && !done; attempt++) {
+            uint32_t index = randomBelow(&grid->random, total);
+            int x = (int)(index % grid->width), y = (int)(index / grid->width);
+            // Pas de couloir trouvé : n'importe quelle tuile de sol
+            if (grid->cells[index] != '.' || (allowed && !allowed[index]) ||
+                (corridors && attempt < PLACEMENT_TRIES && !isCorridor(grid, x, y)))
+                continue;
+            grid->cells[index] = glyph;
+            done = true;
+        }
+        // Peu de tuiles permises : tirage parmi elles
+        if (!done && allowed) {
+            int index = pickAllowed(grid, allowed);
+            if (index >= 0) grid->cells[index] = glyph;
+            done = index >= 0;
+        }
+        if (!done) break;
+    }
+
+    if (placed < count) {
+        LOG_WARN(LOG_ROOM, "Salle générée : %d '%c' posés sur %d demandés (sol insuffisant)", placed, glyph, count);
+    }
+    return placed;
+}
+
+// "@link op s... > d..." : interrupteurs consécutifs, portes après celles des
+// clés. Un ET ne demande pas plus d'interrupteurs que de caisses ; linked
+// marque les interrupteurs reliés.
+static void addLinks(Grid* grid, int count, int switchCount, int doorCount, int keyCount, int boxCount,
+                     bool linked[256]) {
+    int switchLimit = switchCount < 256 ? switchCount : 256;
+    int doorLimit = doorCount < 256 ? doorCount : 256;
+    int firstDoor = keyCount < doorLimit ? keyCount : 0;
+    if (count > MAX_LINKS) count = MAX_LINKS;
+    if (switchLimit == 0 || doorLimit == 0) return;
+
+    for (int l = 0; l < count; l++) {
+        bool and = l % 2;
+        int maxInputs = switchLimit < MAX_LINK_INPUTS ? switchLimit : MAX_LINK_INPUTS;
+        if (and && boxCount < maxInputs) maxInputs = boxCount;
+        if (maxInputs == 0) continue;
+
+        int inputs = 1 + (int)randomBelow(&grid->random, maxInputs);
+        int doorRange = doorLimit - firstDoor;
+        int outputs = 1 + (int)randomBelow(&grid->random, doorRange < 2 ? doorRange : 2);
+        int firstSwitch = (int)randomBelow(&grid->random, switchLimit);
+        int door = firstDoor + (int)randomBelow(&grid->random, doorRange);
+
+        char* line = grid->links[grid->linkCount++];
+        int length = snprintf(line, LINK_LINE_MAX, "@link %s", and ? "and" : "or");
+        for (int i = 0; i < inputs; i++) {
+            linked[(firstSwitch + i) % switchLimit] = true;
+            length += snprintf(line + length, LINK_LINE_MAX - length, " %d", (firstSwitch + i) % switchLimit);
+        }
+        length += snprintf(line + length, LINK_LINE_MAX - length, " >");
+        for (int i = 0; i < outputs; i++) {
+            length += snprintf(line + length, LINK_LINE_MAX - length, " %d", firstDoor + (door - firstDoor + i) % doorRange);
+        }
+    }
+}
+
+// Tuiles d'où une caisse peut encore être poussée jusqu'à un interrupteur
+// relié, murs seuls (comme les cases mortes de puzzle.c) : parcours à
+// rebours, une caisse arrive en q depuis p, le joueur derrière elle
+static uint8_t* liveCells(Grid* grid, const bool linked[256]) {
+    size_t total = (size_t)grid->width * grid->height;
+    uint8_t* live = calloc(total, 1);
+    int* queue = malloc(total * sizeof(int));
+    if (!live || !queue) {
+        free(live);
+        free(queue);
+        return NULL;
+    }
+
+    int head = 0, tail = 0, sw = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (grid->cells[i] != 'S') continue;
+        if (sw < 256 && linked[sw]) {
+            live[i] = 1;
+            queue[tail++] = (int)i;
+        }
+        sw++;
+    }
+    while (head < tail) {
+        int q = queue[head++];
+        int qx = q % grid->width, qy = q / grid->width;
+        for (int d = 0; d < 4; d++) {
+            int px = qx - stepX[d], py = qy - stepY[d];
+            int bx = px - stepX[d], by = py - stepY[d];
+            // Hors de la salle (passages des bords) : mur
+            if (bx < 0 || by < 0 || bx >= grid->width || by >= grid->height) continue;
+            int p = py * grid->width + px;
+            if (live[p] || *cellAt(grid, px, py) == '#' || *cellAt(grid, bx, by) == '#') continue;
+            live[p] = 1;
+            queue[tail++] = p;
+        }
+    }
+    free(queue);
+    return live;
+}
+
+// Portes fermées (2) : toutes sauf les openDoors premières, dans l'ordre
+// de lecture comme la grammaire texte
+static void closeDoors(Grid* grid, int openDoors, uint8_t* mask) {
+    size_t total = (size_t)grid->width * grid->height;
+    int door = 0;
+    for (size_t i = 0; i < total; i++) {
+        mask[i] = grid->cells[i] == 'D' && door++ >= openDoors ? 2 : 0;
+    }
+}
+
+// Marque 1 les tuiles que le joueur atteint depuis start sans pousser de
+// caisse ni passer une tuile déjà marquée ; nombre de tuiles atteintes
+static int flood(Grid* grid, int start, uint8_t* mask, int* queue) {
+    int head = 0, tail = 0;
+    mask[start] = 1;
+    queue[tail++] = start;
+    while (head < tail) {
+        int cell = queue[head++];
+        int x = cell % grid->width, y = cell / grid->width;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + stepX[d], ny = y + stepY[d];
+            if (nx < 0 || ny < 0 || nx >= grid->width || ny >= grid->height) continue;
+            int next = ny * grid->width + nx;
+            if (mask[next] || grid->cells[next] == '#' || grid->cells[next] == 'C') continue;
+            mask[next] = 1;
+            queue[tail++] = next;
+        }
+    }
+    return tail;
+}
+
+// Tuiles (1) que le joueur atteint depuis P, les openDoors premières
+// portes ouvertes
+static void reachable(Grid* grid, int openDoors, uint8_t* mask, int* queue) {
+    closeDoors(grid, openDoors, mask);
+    uint8_t* player = memchr(grid->cells, 'P', (size_t)grid->width * grid->height);
+    if (player) flood(grid, (int)(player - grid->cells), mask, queue);
+}
+
+// Plus grande zone que les portes fermées délimitent
+static void largestZone(Grid* grid, uint8_t* mask, int* queue) {
+    size_t total = (size_t)grid->width * grid->height;
+    int best = -1, bestSize = 0;
+    closeDoors(grid, 0, mask);
+    for (size_t i = 0; i < total; i++) {
+        if (grid->cells[i] != '.' || mask[i]) continue;
+        int size = flood(grid, (int)i, mask, queue);
+        if (size > bestSize) {
+            best = (int)i;
+            bestSize = size;
+        }
+    }
+    closeDoors(grid, 0, mask);
+    if (best >= 0) flood(grid, best, mask, queue);
+}
+
+// Caisses posées là où le joueur arrive et, si switches, d'où elles
+// peuvent rejoindre un de ces interrupteurs ; false si la mémoire manque
+static bool placeBoxes(Grid* grid, const bool* switches, const uint8_t* reach, int count, int* placed) {
+    if (!switches) {
+        *placed += place(grid, 'C', count, false, reach);
+        return true;
+    }
+
+    uint8_t* live = liveCells(grid, switches);
+    if (!live) return false;
+    for (size_t i = 0; i < (size_t)grid->width * grid->height; i++) live[i] &= reach[i] == 1;
+    *placed += place(grid, 'C', count, false, live);
+    free(live);
+    return true;
+}
+
+// Une caisse peut y arriver : deux tuiles libres en ligne d'un côté au moins
+static bool pushTarget(Grid* grid, int x, int y) {
+    for (int d = 0; d < 4; d++) {
+        int bx = x - stepX[d], by = y - stepY[d], px = bx - stepX[d], py = by - stepY[d];
+        if (px < 0 || py < 0 || px >= grid->width || py >= grid->height) continue;
+        if (*cellAt(grid, bx, by) != '#' && *cellAt(grid, px, py) != '#') return true;
+    }
+    return false;
+}
+
+static bool buildGrid(const RoomGenParams* params, Grid* grid) {
+    // Labyrinthe sur les cases impaires : côtés impairs
+    int width = params->width > MAX_MAP_SIDE ? MAX_MAP_SIDE : params->width;
+    int height = params->height > MAX_MAP_SIDE ? MAX_MAP_SIDE : params->height;
+    width -= !(width & 1);
+    height -= !(height & 1);
+    if (width < ROOMGEN_MIN_SIDE || height < ROOMGEN_MIN_SIDE) {
+        LOG_ERROR(LOG_ROOM, "Salle générée trop petite : %d × %d", params->width, params->height);
+        return false;
+    }
+
+    memset(grid, 0, sizeof(*grid));
+    grid->cells = malloc((size_t)width * height);
+    if (!grid->cells) return false;
+    grid->width = width;
+    grid->height = height;
+    grid->random.state = params->seed;
+    memset(grid->cells, '#', (size_t)width * height);
+
+    carveMaze(grid);
+    openLoops(grid, params->loopPercent);
+
+    // Passages au milieu des bords, vers les salles voisines : mêmes
+    // lignes et colonnes d'une salle à l'autre pour une taille donnée
+    if (params->exits) {
+        int midX = (width / 2) | 1, midY = (height / 2) | 1;
+        *cellAt(grid, midX, 0) = '.';
+        *cellAt(grid, midX, height - 1) = '.';
+        *cellAt(grid, 0, midY) = '.';
+        *cellAt(grid, width - 1, midY) = '.';
+    }
+
+    size_t total = (size_t)width * height;
+    uint8_t* reach = malloc(total);
+    int* queue = malloc(total * sizeof(int));
+    if (!reach || !queue) {
+        free(reach);
+        free(queue);
+        free(grid->cells);
+        return false;
+    }
+
+    // Les portes coupent le labyrinthe : le joueur part de la plus grande
+    // zone, interrupteurs et caisses sont posés là où il arrive avec toutes
+    // les clés, puis la n-ième clé là où il arrive avec les précédentes
+    // sans déplacer de caisse
+    int doors = place(grid, 'D', params->doors, true, NULL);
+    largestZone(grid, reach, queue);
+    place(grid, 'P', 1, false, reach);
+    reachable(grid, params->keys, reach, queue);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (!pushTarget(grid, x, y)) reach[(size_t)y * width + x] = 0;
+        }
+    }
+    int switches = place(grid, 'S', params->switches, false, reach);
+    reachable(grid, params->keys, reach, queue);
+
+    // Mécanismes d'abord : une caisse par interrupteur relié, posée d'où
+    // elle peut le rejoindre, les autres d'où elles en rejoignent un
+    bool linked[256] = { false };
+    addLinks(grid, params->links, switches, doors, params->keys, params->boxes, linked);
+    int boxes = 0;
+    bool ok = true;
+    for (int sw = 0; sw < 256 && ok && boxes < params->boxes; sw++) {
+        if (!linked[sw]) continue;
+        bool only[256] = { false };
+        only[sw] = true;
+        ok = placeBoxes(grid, only, reach, 1, &boxes);
+    }
+    if (ok && boxes < params->boxes) {
+        ok = placeBoxes(grid, grid->linkCount > 0 ? linked : NULL, reach, params->boxes - boxes, &boxes);
+    }
+    for (int keys = 0; ok && keys < params->keys; keys++) {
+        reachable(grid, keys, reach, queue);
+        if (place(grid, 'K', 1, false, reach) == 0) break;
+    }
+    free(reach);
+    free(queue);
+    if (!ok) {
+        free(grid->cells);
+        return false;
+    }
+    place(grid, 'E', params->enemies, false, NULL);
+    return true;
+}
+
+
+void roomGenDefaults(RoomGenParams* params) {
+    *params = (RoomGenParams){
+        .seed = 1,
+        .width = 25, .height = 17,
+        .enemies = 4, .keys = 2, .doors = 4, .boxes = 4, .switches = 4,
+        .links = 2,
+        .loopPercent = 15,
+        .exits = false,
+    };
+}
+
+bool roomGenerate(const RoomGenParams* params, Room* room) {
+    Grid grid;
+    if (!buildGrid(params, &grid)) return false;
+
+    bool ok = readRoomGlyphs(grid.cells, grid.width, grid.height, room);
+    for (int l = 0; l < grid.linkCount && ok; l++) {
+        triggerParseLink(grid.links[l], room);
+    }
+    free(grid.cells);
+    return ok;
+}
+
+static bool writeGrid(const Grid* grid, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    bool ok = true;
+    for (int y = 0; y < grid->height && ok; y++) {
+        ok = fwrite(grid->cells + (size_t)y * grid->width, grid->width, 1, file) == 1 && fputc('\n', file) != EOF;
+    }
+    for (int l = 0; l < grid->linkCount && ok; l++) {
+        ok = fprintf(file, "%s\n", grid->links[l]) > 0;
+    }
+    return fclose(file) == 0 && ok;
+}
+
+bool roomGenerateFile(const RoomGenParams* params, const char* path, bool binary) {
+    bool ok;
+    if (binary) {
+        Room room;
+        memset(&room, 0, sizeof(room));
+        ok = roomGenerate(params, &room) && writeRoomBinary(path, &room);
+        roomFree(&room);
+    } else {
+        Grid grid;
+        if (!buildGrid(params, &grid)) return false;
+        ok = writeGrid(&grid, path);
+        free(grid.cells);
+    }
+
+    if (!ok) LOG_ERROR(LOG_ROOM, "Impossible d'écrire la salle générée %s", path);
+    return ok;
+}
+
+
+// Graine propre à chaque salle, tirée de celle du monde
+static uint32_t roomSeed(uint32_t seed, int x, int y) {
+    GenRandom random = { seed ^ (uint64_t)(uint32_t)x * 0xD6E8FEB86659FD93ull ^ (uint64_t)(uint32_t)y * 0xA0761D6478BD642Full };
+    return (uint32_t)nextRandom(&random);
+}
+
+typedef struct {
+    const WorldGenParams* params;
+    const char* directory;
+    atomic_int failures;
+} WorldJob;
+
+static void generateRoomRange(void* context, int begin, int end, int chunk) {
+    (void)chunk;
+    WorldJob* job = context;
+    const WorldGenParams* params = job->params;
+
+    for (int i = begin; i < end; i++) {
+        int x = i % params->width, y = i / params->width;
+        RoomGenParams room = params->room;
+        room.seed = roomSeed(params->room.seed, x, y);
+        room.exits = true;
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/room_%d_%d%s", job->directory, x, y,
+                 params->binary ? ROOMFILE_EXTENSION : ".txt");
+        if (!roomGenerateFile(&room, path, params->binary))
+            atomic_fetch_add(&job->failures, 1);
+    }
+}
+
+bool worldGenerate(const WorldGenParams* params, const char* directory) {
+    if (params->width <= 0 || params->height <= 0 || (int64_t)params->width * params->height > INT32_MAX) {
+        LOG_ERROR(LOG_WORLD, "Monde généré invalide : %d × %d salles", params->width, params->height);
+        return false;
+    }
+
+    WorldJob job = { params, directory, 0 };
+    jobsParallelFor(params->width * params->height, WORLD_GRAIN, generateRoomRange, &job);
+    if (atomic_load(&job.failures) > 0) return false;
+
+    // Le manifeste nomme les salles en .txt : seule la version compilée
+    // est livrée si binary (roomfile.h)
+    char path[512];
+    snprintf(path, sizeof(path), "%s/world.manifest", directory);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        LOG_ERROR(LOG_WORLD, "Impossible d'écrire %s", path);
+        return false;
+    }
+    bool ok = fprintf(file, "# Monde généré : graine %u, %d × %d salles de %d × %d\nstart 0 0\n",
+                      params->room.seed, params->width, params->height, params->room.width, params->room.height) > 0;
+    for (int y = 0; y < params->height && ok; y++) {
+        for (int x = 0; x < params->width && ok; x++) {
+            ok = fprintf(file, "%d %d room_%d_%d.txt\n", x, y, x, y) > 0;
+        }
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok) LOG_ERROR(LOG_WORLD, "Erreur d'écriture %s", path);
+    return ok;
+}
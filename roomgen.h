@@ -0,0 +1,61 @@
+#ifndef ROOMGEN_H
+#define ROOMGEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+// Générateur de salles et de mondes pour les tests de charge : même graine,
+// même contenu, quel que soit le nombre de threads.
+//
+// Une salle est un labyrinthe parfait (parcours en profondeur sur les cases
+// impaires, donc entièrement connexe) dont quelques murs intérieurs sont
+// ensuite percés pour créer des boucles. Les portes sont posées dans les
+// couloirs, les autres entités au hasard sur le sol, une par tuile. La
+// n-ième clé ouvre la n-ième porte (grammaire texte) ; les mécanismes
+// relient des interrupteurs aux portes suivantes.
+//
+// Le joueur part de la plus grande zone entre les portes ; chaque clé est
+// à sa portée avec les clés précédentes, interrupteurs et caisses avec
+// toutes. Chaque interrupteur relié a une caisse qui peut l'atteindre
+// (murs seuls) et un ET ne demande pas plus d'interrupteurs que de
+// caisses. Les poussées peuvent encore se gêner : environ deux salles par
+// défaut sur trois sont résolubles.
+//
+// Sortie dans la grammaire texte (#, ., P, E, K, D, C, S, @link), en .czr
+// (roomfile.h) ou directement dans une Room, sans passer par un fichier.
+
+#define ROOMGEN_MIN_SIDE 5
+
+typedef struct {
+    uint32_t seed;
+    int width, height;      // en tuiles, ramenées à des impairs
+    int enemies;
+    int keys;
+    int doors;
+    int boxes;
+    int switches;
+    int links;              // mécanismes, au plus MAX_LINKS
+    int loopPercent;        // murs intérieurs percés en plus (0 à 100)
+    bool exits;             // passage au milieu de chaque bord (salles d'un monde)
+} RoomGenParams;
+
+typedef struct {
+    RoomGenParams room;     // réglages de chaque salle ; room.seed : graine du monde
+    int width, height;      // en salles
+    bool binary;            // salles en .czr plutôt qu'en texte
+} WorldGenParams;
+
+// Réglages par défaut : une salle d'un écran, quelques entités de chaque type
+void roomGenDefaults(RoomGenParams* params);
+
+// Salle générée en mémoire ; false si la taille est invalide ou la mémoire manque
+bool roomGenerate(const RoomGenParams* params, Room* room);
+// Salle écrite dans path : .czr compilé si binary, sinon texte
+bool roomGenerateFile(const RoomGenParams* params, const char* path, bool binary);
+
+// Salles room_X_Y et manifeste world.manifest dans directory (existant),
+// générés en parallèle (jobs.h) ; départ en (0, 0)
+bool worldGenerate(const WorldGenParams* params, const char* directory);
+
+#endif
@@ -0,0 +1,648 @@
+#include "savestate.h"
+#include "roomcache.h"
+#include "world.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Salles de référence, copiées telles que lues dans leur fichier, avant
+// leur installation (roomLoadedHook) : ni F5 ni F9 ne relisent de
+// fichier. Celle de la salle de la dernière sauvegarde n'est pas recyclée.
+typedef struct {
+    Room room;
+    int x, y;
+    bool ready;
+    uint32_t hash;
+    unsigned lastUse;
+} Baseline;
+
+static Baseline baselines[SAVESTATE_BASELINES];
+static unsigned baselineClock = 0;
+static bool savedRoomKnown = false;
+static int savedX, savedY;
+
+// Référence absente (salle revisitée depuis le cache, sauvegarde d'une
+// autre session) : lue en arrière-plan, jamais pendant F5 ou F9
+static pthread_t reader;
+static bool reading = false;
+static atomic_bool readDone;
+static bool readOk;
+static Baseline* readTarget;
+static char readPath[256];
+
+// Salle de la sauvegarde rapide à préparer dès que le monde est chargé
+static char preloadPath[256];
+
+static Room scratch;                // état reconstruit avant d'être installé
+
+// Deux blocs : l'un est écrit en arrière-plan pendant que l'autre se compose
+static SaveBuffer buffers[2];
+static int nextBuffer = 0;
+static SaveBuffer readBuffer;
+static pthread_t writer;
+static bool writing = false;
+static const SaveBuffer* writeBuffer;
+static char writePath[256];
+
+
+static EntityPool* currentPool(int index) {
+    EntityPool* pools[SAVE_POOL_COUNT] = { &enemies, &keys, &doors, &boxes, &switches };
+    return pools[index];
+}
+
+static EntityPool* roomPool(Room* room, int index) {
+    EntityPool* pools[SAVE_POOL_COUNT] = { &room->enemies, &room->keys, &room->doors, &room->boxes, &room->switches };
+    return pools[index];
+}
+
+// FNV-1a sur les dimensions, les tuiles, les entités et les mécanismes de
+// la référence : une salle modifiée depuis la sauvegarde n'est pas
+// confondue avec l'ancienne
+static uint32_t hashWord(uint32_t hash, uint32_t value) {
+    return (hash ^ value) * 16777619u;
+}
+
+static uint32_t hashChunk(const Chunk* chunk) {
+    uint32_t hash = 2166136261u;
+    const uint8_t* bytes = &chunk->tiles[0][0];
+    for (size_t i = 0; i < sizeof(Chunk); i += 4) {
+        uint32_t word;
+        memcpy(&word, bytes + i, 4);
+        hash = hashWord(hash, word);
+    }
+    return hash;
+}
+
+static uint32_t hashRoom(Room* room) {
+    uint32_t hash = 2166136261u;
+    hash = hashWord(hash, (uint32_t)room->tiles.width);
+    hash = hashWord(hash, (uint32_t)room->tiles.height);
+
+    // Les tronçons uniformes partagés se suivent : leur empreinte est réutilisée
+    const Chunk* previous = NULL;
+    uint32_t chunkHash = 0;
+    int chunkTotal = room->tiles.chunksX * room->tiles.chunksY;
+    for (int i = 0; i < chunkTotal; i++) {
+        const Chunk* chunk = room->tiles.chunks[i];
+        if (chunk != previous) chunkHash = hashChunk(chunk);
+        previous = chunk;
+        hash = hashWord(hash, chunkHash);
+    }
+
+    for (int p = 0; p < SAVE_POOL_COUNT; p++) {
+        const EntityPool* pool = roomPool(room, p);
+        hash = hashWord(hash, (uint32_t)pool->count);
+        for (int i = 0; i < pool->count; i++) {
+            hash = hashWord(hash, (uint32_t)pool->x[i]);
+            hash = hashWord(hash, (uint32_t)pool->y[i]);
+            hash = hashWord(hash, (uint32_t)pool->flags[i] << 16 | (uint16_t)pool->target[i]);
+        }
+    }
+
+    hash = hashWord(hash, (uint32_t)room->linkCount);
+    for (int l = 0; l < room->linkCount; l++) {
+        const Link* link = &room->links[l];
+        hash = hashWord(hash, (uint32_t)link->op << 24 | (uint32_t)link->switchCount << 16 |
+                              (uint32_t)link->doorCount << 8 | link->satisfied);
+        for (int i = 0; i < link->switchCount; i++) hash = hashWord(hash, link->switches[i]);
+        for (int i = 0; i < link->doorCount; i++) hash = hashWord(hash, link->doors[i]);
+    }
+    return hash;
+}
+
+static void* readThread(void* arg) {
+    (void)arg;
+    readOk = readRoom(readPath, &readTarget->room);
+    if (readOk) readTarget->hash = hashRoom(&readTarget->room);
+    atomic_store_explicit(&readDone, true, memory_order_release);
+    return NULL;
+}
+
+// Lecture en arrière-plan terminée : sa référence devient utilisable
+static void pollReader(bool wait) {
+    if (!reading) return;
+    if (!wait && !atomic_load_explicit(&readDone, memory_order_acquire)) return;
+
+    pthread_join(reader, NULL);
+    reading = false;
+    readTarget->ready = readOk;
+    readTarget->lastUse = ++baselineClock;
+    if (!readOk) LOG_ERROR(LOG_GAME, "Salle de référence illisible : %s", readPath);
+}
+
+static Baseline* findBaseline(int x, int y) {
+    pollReader(false);
+    for (int i = 0; i < SAVESTATE_BASELINES; i++) {
+        Baseline* base = &baselines[i];
+        if (base->ready && base->x == x && base->y == y) {
+            base->lastUse = ++baselineClock;
+            return base;
+        }
+    }
+    return NULL;
+}
+
+// Emplacement pour (x, y) : le sien, sinon le moins récemment utilisé
+// hors de la salle sauvegardée et de la lecture en cours
+static Baseline* claimBaseline(int x, int y) {
+    Baseline* slot = NULL;
+    for (int i = 0; i < SAVESTATE_BASELINES; i++) {
+        Baseline* base = &baselines[i];
+        if (reading && base == readTarget) continue;
+        if (base->ready && base->x == x && base->y == y) {
+            slot = base;
+            break;
+        }
+        if (base->ready && savedRoomKnown && base->x == savedX && base->y == savedY) continue;
+        if (!slot || !base->ready || (slot->ready && base->lastUse < slot->lastUse)) slot = base;
+    }
+    if (slot) {
+        slot->ready = false;
+        slot->x = x;
+        slot->y = y;
+    }
+    return slot;
+}
+
+static void requestBaseline(int x, int y) {
+    pollReader(false);
+    if (reading || findBaseline(x, y)) return;
+
+    const WorldRoom* room = worldFind(x, y);
+    if (!room || strlen(room->filename) >= sizeof(readPath)) return;
+    Baseline* slot = claimBaseline(x, y);
+    if (!slot) return;
+
+    snprintf(readPath, sizeof(readPath), "%s", room->filename);
+    readTarget = slot;
+    atomic_store_explicit(&readDone, false, memory_order_relaxed);
+    if (pthread_create(&reader, NULL, readThread, NULL) == 0) reading = true;
+}
+
+// Salle de la sauvegarde rapide d'une session précédente
+static void preloadSavedRoom(void) {
+    FILE* file = fopen(preloadPath, "rb");
+    preloadPath[0] = '\0';
+    if (!file) return;
+
+    SaveHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, SAVESTATE_MAGIC, 4) == 0 && header.version == SAVESTATE_VERSION;
+    fclose(file);
+    if (ok && !(header.flags & SAVE_FLAG_FULL)) requestBaseline(header.mapX, header.mapY);
+}
+
+static bool copyRoom(Room* dst, const Room* src) {
+    dst->playerStartX = src->playerStartX;
+    dst->playerStartY = src->playerStartY;
+    dst->linkCount = src->linkCount;
+    memcpy(dst->links, src->links, src->linkCount * sizeof(Link));
+    return tileMapCopy(&dst->tiles, &src->tiles) &&
+           entityCopy(&dst->enemies, &src->enemies) &&
+           entityCopy(&dst->keys, &src->keys) &&
+           entityCopy(&dst->doors, &src->doors) &&
+           entityCopy(&dst->boxes, &src->boxes) &&
+           entityCopy(&dst->switches, &src->switches);
+}
+
+// La salle courante va être installée depuis son fichier : copie de la
+// salle lue, comme readThread
+static void roomLoaded(int x, int y, const Room* room) {
+    pollReader(false);
+    Baseline* slot = claimBaseline(x, y);
+    if (slot && copyRoom(&slot->room, room)) {
+        slot->hash = hashRoom(&slot->room);
+        slot->ready = true;
+        slot->lastUse = ++baselineClock;
+    }
+    if (preloadPath[0]) preloadSavedRoom();
+}
+
+void saveStateStart(const char* quickPath) {
+    roomLoadedHook = roomLoaded;
+    preloadPath[0] = '\0';
+    if (quickPath && strlen(quickPath) < sizeof(preloadPath))
+        snprintf(preloadPath, sizeof(preloadPath), "%s", quickPath);
+}
+
+
+static bool reserve(SaveBuffer* buffer, size_t size) {
+    if (size <= buffer->capacity) return true;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < size) capacity *= 2;
+    uint8_t* data = realloc(buffer->data, capacity);
+    if (!data) return false;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+// Ajoute size octets à la fin du bloc ; NULL si la mémoire manque
+static void* append(SaveBuffer* buffer, size_t size) {
+    if (!reserve(buffer, buffer->size + size)) return NULL;
+    void* record = buffer->data + buffer->size;
+    buffer->size += size;
+    return record;
+}
+
+static SaveEntity entityRecord(const EntityPool* pool, int i) {
+    SaveEntity record;
+    memset(&record, 0, sizeof(record));
+    record.index = (uint32_t)i;
+    record.x = pool->x[i];
+    record.y = pool->y[i];
+    record.prevX = pool->prevX[i];
+    record.prevY = pool->prevY[i];
+    record.dx = pool->dx[i];
+    record.dy = pool->dy[i];
+    record.target = pool->target[i];
+    record.occupants = pool->occupants[i];
+    record.links = pool->links[i];
+    record.flags = pool->flags[i];
+    return record;
+}
+
+static void setEntity(EntityPool* pool, int i, const SaveEntity* record) {
+    pool->x[i] = record->x;
+    pool->y[i] = record->y;
+    pool->prevX[i] = record->prevX;
+    pool->prevY[i] = record->prevY;
+    pool->dx[i] = record->dx;
+    pool->dy[i] = record->dy;
+    pool->target[i] = record->target;
+    pool->occupants[i] = record->occupants;
+    pool->links[i] = record->links;
+    pool->flags[i] = record->flags;
+}
+
+// Mêmes entités aux mêmes positions denses que la référence : seules les
+// modifiées sont gardées
+static bool sameComposition(const EntityPool* pool, const EntityPool* base) {
+    return pool->count == base->count &&
+           (pool->count == 0 || memcmp(pool->denseSlot, base->denseSlot, pool->count * sizeof(uint32_t)) == 0);
+}
+
+// base NULL : ensemble gardé en entier
+static bool encodePool(SaveBuffer* buffer, SavePool* section, const EntityPool* pool, const EntityPool* base) {
+    bool delta = base && sameComposition(pool, base);
+    section->mode = delta ? SAVE_POOL_DELTA : SAVE_POOL_FULL;
+    section->count = (uint32_t)pool->count;
+    section->recordOffset = (uint32_t)buffer->size;
+
+    // Au pire une entrée par entité : réservé d'un coup
+    if (!reserve(buffer, buffer->size + (size_t)pool->count * sizeof(SaveEntity))) return false;
+    for (int i = 0; i < pool->count; i++) {
+        SaveEntity record = entityRecord(pool, i);
+        if (delta) {
+            SaveEntity original = entityRecord(base, i);
+            if (memcmp(&record, &original, sizeof(record)) == 0) continue;
+        }
+        memcpy(append(buffer, sizeof(record)), &record, sizeof(record));
+        section->recordCount++;
+    }
+    return true;
+}
+
+bool saveStateEncode(const Player* player, SaveBuffer* buffer) {
+    if (!worldFind(currentMapX, currentMapY)) {
+        LOG_ERROR(LOG_GAME, "Sauvegarde impossible : salle (%d, %d) hors du monde", currentMapX, currentMapY);
+        return false;
+    }
+
+    // Sans référence en mémoire, la salle est gardée en entier ; la
+    // référence est lue en arrière-plan pour les sauvegardes suivantes
+    Baseline* baseline = findBaseline(currentMapX, currentMapY);
+    Room* base = baseline ? &baseline->room : NULL;
+    if (!base) requestBaseline(currentMapX, currentMapY);
+    if (base && (base->tiles.width != tileMap.width || base->tiles.height != tileMap.height)) {
+        LOG_ERROR(LOG_GAME, "Sauvegarde impossible : la salle (%d, %d) ne correspond plus à son fichier",
+                  currentMapX, currentMapY);
+        return false;
+    }
+
+    buffer->size = 0;
+    if (!append(buffer, sizeof(SaveHeader))) return false;
+
+    SaveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SAVESTATE_MAGIC, 4);
+    header.version = SAVESTATE_VERSION;
+    header.headerSize = sizeof(SaveHeader);
+    header.mapX = currentMapX;
+    header.mapY = currentMapY;
+    header.baselineHash = baseline ? baseline->hash : 0;
+    header.flags = base ? 0 : SAVE_FLAG_FULL;
+    header.width = tileMap.width;
+    header.height = tileMap.height;
+    header.keysCollected = keysCollected;
+    header.player = (SavePlayer){
+        player->x, player->y, player->prevX, player->prevY,
+        player->frame, player->frameTimer, (int32_t)player->dir, player->contacts
+    };
+
+    // Tronçons : un tronçon partagé des deux côtés est identique sans comparaison
+    header.chunkOffset = (uint32_t)buffer->size;
+    int chunkTotal = tileMap.chunksX * tileMap.chunksY;
+    for (int i = 0; i < chunkTotal; i++) {
+        const Chunk* chunk = tileMap.chunks[i];
+        const Chunk* original = base ? base->tiles.chunks[i] : NULL;
+        if (chunk == original || (original && memcmp(chunk, original, sizeof(Chunk)) == 0)) continue;
+
+        SaveChunk* record = append(buffer, sizeof(SaveChunk));
+        if (!record) return false;
+        record->index = (uint32_t)i;
+        memcpy(&record->chunk, chunk, sizeof(Chunk));
+        header.chunkCount++;
+    }
+
+    for (int p = 0; p < SAVE_POOL_COUNT; p++) {
+        if (!encodePool(buffer, &header.pools[p], currentPool(p), base ? roomPool(base, p) : NULL)) return false;
+    }
+
+    header.linkOffset = (uint32_t)buffer->size;
+    header.linkCount = (uint32_t)linkCount;
+    for (int i = 0; i < linkCount; i++) {
+        SaveLink* record = append(buffer, sizeof(SaveLink));
+        if (!record) return false;
+        *record = (SaveLink){ links[i].op, links[i].switchCount, links[i].doorCount, links[i].satisfied, { 0 }, { 0 } };
+        memcpy(record->switches, links[i].switches, sizeof(record->switches));
+        memcpy(record->doors, links[i].doors, sizeof(record->doors));
+    }
+
+    header.fileSize = (uint32_t)buffer->size;
+    memcpy(buffer->data, &header, sizeof(header));
+
+    // Sa référence reste en mémoire pour F9
+    savedRoomKnown = true;
+    savedX = currentMapX;
+    savedY = currentMapY;
+    return true;
+}
+
+
+static bool sectionFits(const SaveHeader* header, uint32_t offset, uint32_t count, size_t recordSize) {
+    return offset >= header->headerSize && offset <= header->fileSize &&
+           count <= (header->fileSize - offset) / recordSize;
+}
+
+static bool poolOnGrid(const EntityPool* pool, const TileMap* tiles) {
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->x[i] < 0 || pool->y[i] < 0 ||
+            pool->x[i] / TILE_SIZE >= tiles->width || pool->y[i] / TILE_SIZE >= tiles->height)
+            return false;
+    }
+    return true;
+}
+
+// Indices et positions d'une salle reconstruite : triggerRebuild,
+// evaluateLink et puzzleBoxPushed s'en servent sans vérification
+static bool referencesValid(const Room* room) {
+    const EntityPool* pools[SAVE_POOL_COUNT] = { &room->enemies, &room->keys, &room->doors, &room->boxes, &room->switches };
+    for (int p = 0; p < SAVE_POOL_COUNT; p++) {
+        if (!poolOnGrid(pools[p], &room->tiles)) return false;
+    }
+
+    for (int l = 0; l < room->linkCount; l++) {
+        const Link* link = &room->links[l];
+        if (link->op > LINK_AND || link->switchCount > MAX_LINK_INPUTS || link->doorCount > MAX_LINK_OUTPUTS)
+            return false;
+        for (int i = 0; i < link->switchCount; i++) {
+            if (link->switches[i] >= room->switches.count) return false;
+        }
+        for (int i = 0; i < link->doorCount; i++) {
+            if (link->doors[i] >= room->doors.count) return false;
+        }
+    }
+
+    // Clé : porte ouverte ou -1 ; la n-ième clé d'une salle sans n-ième
+    // porte n'ouvre rien (cible bornée à l'usage, comme à la lecture de la
+    // salle). Interrupteur : masque des mécanismes
+    for (int i = 0; i < room->keys.count; i++) {
+        if (room->keys.target[i] < -1) return false;
+    }
+    for (int i = 0; i < room->switches.count; i++) {
+        if (room->switches.links[i] >> room->linkCount) return false;
+    }
+    return true;
+}
+
+bool saveStateDecode(const void* data, size_t size, Player* player) {
+    SaveHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+
+    bool valid = memcmp(header.magic, SAVESTATE_MAGIC, 4) == 0 &&
+                 header.version == SAVESTATE_VERSION && header.headerSize == sizeof(SaveHeader) &&
+                 header.fileSize <= size && header.fileSize >= sizeof(SaveHeader) &&
+                 sectionFits(&header, header.chunkOffset, header.chunkCount, sizeof(SaveChunk)) &&
+                 sectionFits(&header, header.linkOffset, header.linkCount, sizeof(SaveLink)) &&
+                 header.linkCount <= MAX_LINKS && header.flags <= SAVE_FLAG_FULL &&
+                 header.width > 0 && header.height > 0 &&
+                 header.width <= MAX_MAP_SIDE && header.height <= MAX_MAP_SIDE;
+    bool full = header.flags & SAVE_FLAG_FULL;
+    for (int p = 0; p < SAVE_POOL_COUNT && valid; p++) {
+        const SavePool* section = &header.pools[p];
+        valid = section->mode <= SAVE_POOL_FULL && section->count <= ENTITY_MAX_COUNT &&
+                (!full || section->mode == SAVE_POOL_FULL) &&
+                sectionFits(&header, section->recordOffset, section->recordCount, sizeof(SaveEntity)) &&
+                (section->mode == SAVE_POOL_DELTA || section->recordCount == section->count);
+    }
+    if (!valid) {
+        LOG_ERROR(LOG_GAME, "Sauvegarde invalide");
+        return false;
+    }
+
+    if (!worldFind(header.mapX, header.mapY)) {
+        LOG_ERROR(LOG_GAME, "Sauvegarde inutilisable : salle (%d, %d) hors du monde", header.mapX, header.mapY);
+        return false;
+    }
+
+    // Différences : la référence doit être en mémoire, sinon elle est lue
+    // en arrière-plan et le chargement sera possible un peu plus tard
+    Room* base = NULL;
+    if (!full) {
+        Baseline* baseline = findBaseline(header.mapX, header.mapY);
+        if (!baseline) {
+            requestBaseline(header.mapX, header.mapY);
+            LOG_WARN(LOG_GAME, "Salle (%d, %d) de la sauvegarde en cours de lecture, réessayez",
+                     header.mapX, header.mapY);
+            return false;
+        }
+        base = &baseline->room;
+        if (baseline->hash != header.baselineHash ||
+            base->tiles.width != header.width || base->tiles.height != header.height) {
+            LOG_ERROR(LOG_GAME, "Sauvegarde inutilisable : la salle (%d, %d) a changé depuis",
+                      header.mapX, header.mapY);
+            return false;
+        }
+    }
+
+    // Reconstruction à part : la partie n'est touchée que si tout est valide
+    const uint8_t* bytes = data;
+    bool ok = base ? tileMapCopy(&scratch.tiles, &base->tiles) : tileMapInit(&scratch.tiles, header.width, header.height);
+    // Le point de départ ne sert qu'au lancement de la partie (captureRoom)
+    scratch.playerStartX = -1;
+    scratch.playerStartY = -1;
+
+    int chunkTotal = scratch.tiles.chunksX * scratch.tiles.chunksY;
+    for (uint32_t i = 0; i < header.chunkCount && ok; i++) {
+        const SaveChunk* record = (const SaveChunk*)(bytes + header.chunkOffset) + i;
+        ok = record->index < (uint32_t)chunkTotal &&
+             tileMapSetChunk(&scratch.tiles, (int)record->index, &record->chunk);
+    }
+
+    for (int p = 0; p < SAVE_POOL_COUNT && ok; p++) {
+        const SavePool* section = &header.pools[p];
+        const SaveEntity* records = (const SaveEntity*)(bytes + section->recordOffset);
+        EntityPool* pool = roomPool(&scratch, p);
+
+        if (section->mode == SAVE_POOL_DELTA) {
+            const EntityPool* original = roomPool(base, p);
+            ok = section->count == (uint32_t)original->count && entityCopy(pool, original);
+        } else {
+            entityClear(pool);
+            ok = entityReserve(pool, (int)section->count);
+            for (uint32_t i = 0; i < section->count && ok; i++) {
+                ok = entityAdd(pool, 0, 0, 0) >= 0;
+            }
+        }
+        for (uint32_t i = 0; i < section->recordCount && ok; i++) {
+            SaveEntity record;
+            memcpy(&record, &records[i], sizeof(record));
+            ok = record.index < section->count;
+            if (ok) setEntity(pool, (int)record.index, &record);
+        }
+    }
+
+    scratch.linkCount = (int)header.linkCount;
+    for (uint32_t i = 0; i < header.linkCount && ok; i++) {
+        const SaveLink* record = (const SaveLink*)(bytes + header.linkOffset) + i;
+        Link* link = &scratch.links[i];
+        link->op = record->op;
+        link->switchCount = record->switchCount;
+        link->doorCount = record->doorCount;
+        link->satisfied = record->satisfied != 0;
+        memcpy(link->switches, record->switches, sizeof(link->switches));
+        memcpy(link->doors, record->doors, sizeof(link->doors));
+    }
+
+    ok = ok && referencesValid(&scratch);
+    if (!ok) {
+        LOG_ERROR(LOG_GAME, "Sauvegarde invalide ou mémoire insuffisante");
+        return false;
+    }
+
+    savedRoomKnown = true;
+    savedX = header.mapX;
+    savedY = header.mapY;
+
+    // Les autres salles repartent de leur fichier
+    roomCacheClear();
+    restoreRoom(header.mapX, header.mapY, &scratch);
+    keysCollected = header.keysCollected;
+    player->x = header.player.x;
+    player->y = header.player.y;
+    player->prevX = header.player.prevX;
+    player->prevY = header.player.prevY;
+    player->frame = header.player.frame;
+    player->frameTimer = header.player.frameTimer;
+    player->dir = (Direction)(header.player.dir & 3);
+    player->contacts = header.player.contacts;
+    return true;
+}
+
+void saveBufferFree(SaveBuffer* buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+
+// Fichier temporaire puis renommage : une sauvegarde interrompue ne
+// remplace jamais la précédente
+static void* writeThread(void* arg) {
+    (void)arg;
+
+    char tempPath[sizeof(writePath) + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", writePath);
+    FILE* file = fopen(tempPath, "wb");
+    bool ok = file && fwrite(writeBuffer->data, writeBuffer->size, 1, file) == 1;
+    if (file) ok = fclose(file) == 0 && ok;
+    ok = ok && rename(tempPath, writePath) == 0;
+
+    if (ok) {
+        LOG_INFO(LOG_GAME, "Partie sauvegardée : %s (%zu octets)", writePath, writeBuffer->size);
+    } else {
+        LOG_ERROR(LOG_GAME, "Impossible d'écrire la sauvegarde : %s", writePath);
+        remove(tempPath);
+    }
+    return NULL;
+}
+
+static void waitForWriter(void) {
+    if (!writing) return;
+    pthread_join(writer, NULL);
+    writing = false;
+}
+
+bool saveStateWrite(const char* path, const Player* player) {
+    if (strlen(path) >= sizeof(writePath)) return false;
+
+    SaveBuffer* buffer = &buffers[nextBuffer];
+    if (!saveStateEncode(player, buffer)) return false;
+
+    // L'autre bloc est peut-être encore en cours d'écriture
+    waitForWriter();
+    nextBuffer ^= 1;
+    writeBuffer = buffer;
+    snprintf(writePath, sizeof(writePath), "%s", path);
+    if (pthread_create(&writer, NULL, writeThread, NULL) == 0) {
+        writing = true;
+    } else {
+        writeThread(NULL);
+    }
+    return true;
+}
+
+bool saveStateRead(const char* path, Player* player) {
+    waitForWriter();
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        LOG_WARN(LOG_GAME, "Aucune sauvegarde : %s", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    bool ok = size > 0 && reserve(&readBuffer, (size_t)size) &&
+              fread(readBuffer.data, (size_t)size, 1, file) == 1;
+    fclose(file);
+    if (!ok) {
+        LOG_ERROR(LOG_GAME, "Impossible de lire la sauvegarde : %s", path);
+        return false;
+    }
+    readBuffer.size = (size_t)size;
+
+    ok = saveStateDecode(readBuffer.data, readBuffer.size, player);
+    if (ok) LOG_INFO(LOG_GAME, "Partie chargée : %s", path);
+    return ok;
+}
+
+void saveStateShutdown(void) {
+    waitForWriter();
+    saveBufferFree(&buffers[0]);
+    saveBufferFree(&buffers[1]);
+    saveBufferFree(&readBuffer);
+    pollReader(true);
+    for (int i = 0; i < SAVESTATE_BASELINES; i++) {
+        roomFree(&baselines[i].room);
+        baselines[i].ready = false;
+    }
+    roomFree(&scratch);
+    savedRoomKnown = false;
+    roomLoadedHook = NULL;
+}
@@ -0,0 +1,140 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+// Sauvegarde de la partie (.czs) : joueur, salle courante et son état.
+//
+// Seules les différences avec la salle telle que décrite par son fichier
+// (la référence) sont gardées : tronçons de grille modifiés, entités
+// déplacées ou changées. Une sauvegarde rapide ne coûte donc presque rien
+// tant que la salle a peu changé. Un ensemble d'entités dont la
+// composition a changé (clé ramassée, zombies ajoutés) est gardé en entier.
+//
+// La référence est copiée telle que lue, juste avant que la salle soit
+// installée depuis son fichier (roomLoadedHook) : F5 et F9 ne lisent
+// aucune salle. Une salle revenue du cache sans référence en mémoire est
+// sauvegardée en entier (SAVE_FLAG_FULL) pendant que sa référence est lue
+// en arrière-plan ; de même, charger des différences sans leur référence
+// la fait lire et demande de réessayer.
+//
+// Les salles visitées ailleurs (roomcache.h) ne font pas partie de la
+// sauvegarde : au chargement, elles repartent de leur fichier.
+//
+// Enregistrements de taille fixe, en petit-boutiste, dans un seul bloc :
+//
+//   SaveHeader
+//   SaveChunk × chunkCount           tronçons différents de la référence
+//   SaveEntity × recordCount         pour chacun des SAVE_POOL_COUNT ensembles
+//   SaveLink × linkCount             mécanismes, toujours en entier
+//
+// Chaque section commence sur un multiple de 4 octets.
+
+#define SAVESTATE_MAGIC "CZSS"
+#define SAVESTATE_VERSION 1
+#define SAVESTATE_QUICK_PATH "quicksave.czs"
+#define SAVESTATE_BASELINES 3           // salles de référence gardées en mémoire
+#define SAVE_FLAG_FULL 1                // sans référence : tout est dans la sauvegarde
+
+enum {
+    SAVE_POOL_ENEMIES,
+    SAVE_POOL_KEYS,
+    SAVE_POOL_DOORS,
+    SAVE_POOL_BOXES,
+    SAVE_POOL_SWITCHES,
+    SAVE_POOL_COUNT
+};
+
+enum {
+    SAVE_POOL_DELTA = 0,        // entités de la référence modifiées (index dense)
+    SAVE_POOL_FULL = 1,         // toutes les entités, dans l'ordre dense
+};
+
+typedef struct {
+    int32_t x, y;
+    int32_t prevX, prevY;
+    int32_t frame, frameTimer;
+    int32_t dir;
+    int32_t contacts;
+} SavePlayer;
+
+typedef struct {
+    uint8_t mode;               // SAVE_POOL_DELTA ou SAVE_POOL_FULL
+    uint8_t reserved[3];
+    uint32_t count;             // entités dans l'ensemble
+    uint32_t recordOffset;
+    uint32_t recordCount;
+} SavePool;
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t fileSize;
+    int32_t mapX, mapY;
+    uint32_t baselineHash;      // salle de référence à l'enregistrement
+    uint32_t flags;             // SAVE_FLAG_FULL
+    int32_t width, height;      // en tuiles
+    int32_t keysCollected;
+    SavePlayer player;
+    uint32_t chunkOffset, chunkCount;
+    SavePool pools[SAVE_POOL_COUNT];
+    uint32_t linkOffset, linkCount;
+} SaveHeader;
+
+typedef struct {
+    uint32_t index;             // tronçon, ligne par ligne (tilemap.h)
+    Chunk chunk;
+} SaveChunk;
+
+typedef struct {
+    uint32_t index;             // position dense
+    int32_t x, y;
+    int32_t prevX, prevY;
+    int16_t dx, dy;
+    int16_t target;
+    uint16_t occupants;
+    uint16_t links;
+    uint8_t flags;
+    uint8_t reserved;
+} SaveEntity;
+
+typedef struct {
+    uint8_t op;
+    uint8_t switchCount;
+    uint8_t doorCount;
+    uint8_t satisfied;
+    uint8_t switches[MAX_LINK_INPUTS];
+    uint8_t doors[MAX_LINK_OUTPUTS];
+} SaveLink;
+
+// Bloc de sauvegarde ; un SaveBuffer mis à zéro est vide et valide
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} SaveBuffer;
+
+// Installe roomLoadedHook ; quickPath (ou NULL) : sauvegarde rapide d'une
+// session précédente dont la référence est lue dès le lancement
+void saveStateStart(const char* quickPath);
+
+// Compose la sauvegarde de l'état courant ; false si la salle n'est pas
+// une salle du monde ou si la mémoire manque
+bool saveStateEncode(const Player* player, SaveBuffer* buffer);
+// Installe l'état sauvegardé ; false (partie inchangée) si le bloc est
+// invalide, si la salle de référence a changé depuis ou si elle est encore
+// en cours de lecture
+bool saveStateDecode(const void* data, size_t size, Player* player);
+void saveBufferFree(SaveBuffer* buffer);
+
+// Sauvegarde composée tout de suite, écrite sur disque en arrière-plan
+bool saveStateWrite(const char* path, const Player* player);
+bool saveStateRead(const char* path, Player* player);
+// Attend la fin de l'écriture en cours et libère les blocs
+void saveStateShutdown(void);
+
+#endif
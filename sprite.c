@@ -0,0 +1,222 @@
+#include "sprite.h"
+#include "asset.h"
+
+#define ATLAS_PADDING 1
+#define ATLAS_MIN_WIDTH 256
+
+typedef struct {
+    int asset;            // AssetId, -1 : pas d'image
+    SDL_Color fallback;   // couleur utilisée si l'image est absente
+} SpriteDef;
+
+static const SpriteDef spriteDefs[SPRITE_COUNT] = {
+    [SPRITE_WHITE]      = { -1,                 { 255, 255, 255, 255 } },
+    [SPRITE_WALL]       = { ASSET_WALL,         { 100, 100, 100, 255 } },
+    [SPRITE_GROUND]     = { ASSET_GROUND,       { 20, 150, 20, 255 } },
+    [SPRITE_DOOR]       = { ASSET_DOOR,         { 0, 0, 200, 255 } },
+    [SPRITE_BOX]        = { ASSET_BOX,          { 150, 100, 50, 255 } },
+    [SPRITE_SWITCH_OFF] = { ASSET_SWITCH_OFF,   { 255, 0, 0, 255 } },   // rouge = inactif
+    [SPRITE_SWITCH_ON]  = { ASSET_SWITCH_ON,    { 0, 255, 0, 255 } },   // vert = activé
+    [SPRITE_PLAYER]     = { ASSET_PLAYER,       { 255, 255, 255, 255 } },
+};
+
+static SDL_Texture* atlasTexture = NULL;
+static int atlasW = 0, atlasH = 0;
+static SDL_Rect spriteRects[SPRITE_COUNT];   // w == 0 : sprite absent
+static bool spriteOk[SPRITE_COUNT];
+
+static SDL_Vertex* vertices = NULL;
+static int* indices = NULL;
+static int quadCount = 0;
+static int quadCapacity = 0;
+
+
+// Rangement par étagères, sprites triés du plus haut au plus bas
+static bool packSprites(SDL_Surface** surfaces, const int* order, int width, int maxHeight) {
+    int penX = 0, penY = 0, shelfH = 0;
+
+    for (int k = 0; k < SPRITE_COUNT; k++) {
+        int id = order[k];
+        if (!surfaces[id]) {
+            spriteRects[id] = (SDL_Rect){ 0, 0, 0, 0 };
+            continue;
+        }
+
+        int w = surfaces[id]->w, h = surfaces[id]->h;
+        if (w > width) return false;
+
+        if (penX + w > width) {
+            penX = 0;
+            penY += shelfH + ATLAS_PADDING;
+            shelfH = 0;
+        }
+        spriteRects[id] = (SDL_Rect){ penX, penY, w, h };
+        penX += w + ATLAS_PADDING;
+        if (h > shelfH) shelfH = h;
+    }
+
+    atlasW = width;
+    atlasH = penY + shelfH;
+    return atlasH <= maxHeight;
+}
+
+bool spriteAtlasBuild(SDL_Renderer* renderer) {
+    SDL_Surface* surfaces[SPRITE_COUNT] = { 0 };
+
+    // Pixels déjà décodés en RGBA (asset.h) : surfaces posées dessus, sans copie
+    for (int id = 0; id < SPRITE_COUNT; id++) {
+        if (spriteDefs[id].asset >= 0) {
+            const AssetImage* image = assetImage((AssetId)spriteDefs[id].asset);
+            if (!image->pixels) continue;
+            surfaces[id] = SDL_CreateRGBSurfaceWithFormatFrom((void*)image->pixels, image->width, image->height,
+                                                              32, image->width * 4, SDL_PIXELFORMAT_RGBA32);
+        } else {
+            surfaces[id] = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32);
+            if (surfaces[id]) SDL_FillRect(surfaces[id], NULL, 0xFFFFFFFF);
+        }
+    }
+
+    int order[SPRITE_COUNT];
+    for (int i = 0; i < SPRITE_COUNT; i++) order[i] = i;
+    for (int i = 1; i < SPRITE_COUNT; i++) {
+        for (int j = i; j > 0; j--) {
+            int ha = surfaces[order[j - 1]] ? surfaces[order[j - 1]]->h : 0;
+            int hb = surfaces[order[j]] ? surfaces[order[j]]->h : 0;
+            if (ha >= hb) break;
+            int t = order[j]; order[j] = order[j - 1]; order[j - 1] = t;
+        }
+    }
+
+    SDL_RendererInfo info;
+    int maxSize = 4096;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0) {
+        maxSize = info.max_texture_width < info.max_texture_height ? info.max_texture_width : info.max_texture_height;
+    }
+
+    bool packed = false;
+    for (int width = ATLAS_MIN_WIDTH; width <= maxSize && !packed; width *= 2) {
+        packed = packSprites(surfaces, order, width, maxSize);
+    }
+
+    SDL_Surface* sheet = NULL;
+    if (packed) {
+        sheet = SDL_CreateRGBSurfaceWithFormat(0, atlasW, atlasH > 0 ? atlasH : 1, 32, SDL_PIXELFORMAT_RGBA32);
+    } else {
+        SDL_Log("Les sprites ne tiennent pas dans une texture %dx%d", maxSize, maxSize);
+    }
+
+    if (sheet) {
+        SDL_FillRect(sheet, NULL, 0);
+        for (int id = 0; id < SPRITE_COUNT; id++) {
+            if (!surfaces[id]) continue;
+            SDL_SetSurfaceBlendMode(surfaces[id], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[id], NULL, sheet, &spriteRects[id]);
+        }
+
+        atlasTexture = SDL_CreateTextureFromSurface(renderer, sheet);
+        if (!atlasTexture) {
+            SDL_Log("Erreur création atlas : %s", SDL_GetError());
+        } else {
+            SDL_SetTextureBlendMode(atlasTexture, SDL_BLENDMODE_BLEND);
+        }
+        SDL_FreeSurface(sheet);
+    }
+
+    for (int id = 0; id < SPRITE_COUNT; id++) {
+        spriteOk[id] = atlasTexture && surfaces[id];
+        if (surfaces[id]) SDL_FreeSurface(surfaces[id]);
+    }
+
+    return atlasTexture != NULL;
+}
+
+void spriteAtlasDestroy(void) {
+    if (atlasTexture) SDL_DestroyTexture(atlasTexture);
+    atlasTexture = NULL;
+
+    SDL_free(vertices);
+    SDL_free(indices);
+    vertices = NULL;
+    indices = NULL;
+    quadCount = quadCapacity = 0;
+}
+
+bool spriteLoaded(SpriteId id) {
+    return spriteOk[id];
+}
+
+
+static SDL_Vertex* pushQuad(void) {
+    if (quadCount == quadCapacity) {
+        int capacity = quadCapacity ? quadCapacity * 2 : 1024;
+        SDL_Vertex* v = SDL_realloc(vertices, sizeof(SDL_Vertex) * 4 * capacity);
+        int* idx = SDL_realloc(indices, sizeof(int) * 6 * capacity);
+        if (v) vertices = v;
+        if (idx) indices = idx;
+        if (!v || !idx) return NULL;
+
+        for (int i = quadCapacity; i < capacity; i++) {
+            indices[i * 6 + 0] = i * 4 + 0;
+            indices[i * 6 + 1] = i * 4 + 1;
+            indices[i * 6 + 2] = i * 4 + 2;
+            indices[i * 6 + 3] = i * 4 + 2;
+            indices[i * 6 + 4] = i * 4 + 3;
+            indices[i * 6 + 5] = i * 4 + 0;
+        }
+        quadCapacity = capacity;
+    }
+    return &vertices[4 * quadCount++];
+}
+
+static void pushTexturedQuad(const SDL_Rect* dst, float u0, float v0, float u1, float v1, SDL_Color color) {
+    SDL_Vertex* v = pushQuad();
+    if (!v) return;
+
+    float x0 = (float)dst->x, y0 = (float)dst->y;
+    float x1 = x0 + dst->w, y1 = y0 + dst->h;
+
+    v[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+    v[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+    v[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+    v[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+}
+
+void spriteFill(const SDL_Rect* dst, SDL_Color color) {
+    // Échantillonne le centre du pixel blanc pour ne pas déborder sur ses voisins
+    const SDL_Rect* r = &spriteRects[SPRITE_WHITE];
+    float u = 0.0f, v = 0.0f;
+    if (atlasW > 0 && atlasH > 0) {
+        u = (r->x + 0.5f) / atlasW;
+        v = (r->y + 0.5f) / atlasH;
+    }
+    pushTexturedQuad(dst, u, v, u, v, color);
+}
+
+void spriteDraw(SpriteId id, const SDL_Rect* src, const SDL_Rect* dst) {
+    spriteDrawTinted(id, src, dst, (SDL_Color){ 255, 255, 255, 255 });
+}
+
+void spriteDrawTinted(SpriteId id, const SDL_Rect* src, const SDL_Rect* dst, SDL_Color tint) {
+    if (!spriteOk[id]) {
+        SDL_Color fallback = spriteDefs[id].fallback;
+        spriteFill(dst, (SDL_Color){ fallback.r * tint.r / 255, fallback.g * tint.g / 255,
+                                     fallback.b * tint.b / 255, fallback.a * tint.a / 255 });
+        return;
+    }
+
+    const SDL_Rect* r = &spriteRects[id];
+    SDL_Rect area = src ? (SDL_Rect){ r->x + src->x, r->y + src->y, src->w, src->h } : *r;
+
+    pushTexturedQuad(dst,
+                     (float)area.x / atlasW, (float)area.y / atlasH,
+                     (float)(area.x + area.w) / atlasW, (float)(area.y + area.h) / atlasH,
+                     tint);
+}
+
+void spriteFlush(SDL_Renderer* renderer) {
+    if (quadCount == 0) return;
+
+    // Sans atlas, seules les couleurs de secours sont utilisées : texture NULL
+    SDL_RenderGeometry(renderer, atlasTexture, vertices, quadCount * 4, indices, quadCount * 6);
+    quadCount = 0;
+}
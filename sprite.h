@@ -0,0 +1,37 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Atlas unique regroupant toutes les tuiles et sprites du jeu, et batch de
+// quads envoyé en un seul SDL_RenderGeometry (un seul changement de texture).
+
+typedef enum {
+    SPRITE_WHITE = 0,   // pixel blanc, pour les rectangles colorés
+    SPRITE_WALL,
+    SPRITE_GROUND,
+    SPRITE_DOOR,
+    SPRITE_BOX,
+    SPRITE_SWITCH_OFF,
+    SPRITE_SWITCH_ON,
+    SPRITE_PLAYER,
+    SPRITE_COUNT
+} SpriteId;
+
+// Range les images déjà chargées (assetLoadWait) dans une seule texture
+bool spriteAtlasBuild(SDL_Renderer* renderer);
+void spriteAtlasDestroy(void);
+bool spriteLoaded(SpriteId id);
+
+// Ajoute un quad au batch ; src relatif au sprite (NULL = sprite entier).
+// Si l'image n'a pas pu être chargée, un rectangle de couleur de secours est dessiné.
+void spriteDraw(SpriteId id, const SDL_Rect* src, const SDL_Rect* dst);
+// Idem, couleurs multipliées par tint (tuiles assombries du brouillard)
+void spriteDrawTinted(SpriteId id, const SDL_Rect* src, const SDL_Rect* dst, SDL_Color tint);
+void spriteFill(const SDL_Rect* dst, SDL_Color color);
+
+// Envoie tous les quads accumulés puis vide le batch
+void spriteFlush(SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,326 @@
+#include "text.h"
+
+#define TEXT_FIRST_GLYPH 32
+#define TEXT_LAST_GLYPH 255
+#define TEXT_GLYPH_COUNT (TEXT_LAST_GLYPH - TEXT_FIRST_GLYPH + 1)
+#define TEXT_ATLAS_WIDTH 512
+#define TEXT_BATCH_GLYPHS 256
+
+typedef struct {
+    SDL_Rect src;       // zone dans l'atlas (w == 0 : glyphe absent)
+    int advance;
+} Glyph;
+
+typedef struct {
+    int size, style;
+    TTF_Font* font;
+    SDL_Texture* texture;   // glyphes en blanc, teintés par la couleur des sommets
+    int lineHeight;
+    Glyph glyphs[TEXT_GLYPH_COUNT];
+} GlyphAtlas;
+
+typedef struct {
+    Uint32 hash;
+    char text[TEXT_CACHE_MAX_LEN];
+    SDL_Color color;
+    int size, style;
+    SDL_Texture* texture;
+    int w, h;
+    Uint32 lastUse;
+} CachedText;
+
+static char fontPath[256];
+static const void* fontData = NULL;     // police déjà en mémoire (textSetFontData)
+static size_t fontDataSize = 0;
+static GlyphAtlas atlases[TEXT_MAX_ATLASES];
+static int atlasCount = 0;
+
+static CachedText cache[TEXT_CACHE_SIZE];
+static Uint32 cacheClock = 0;
+
+static SDL_Vertex batchVertices[TEXT_BATCH_GLYPHS * 4];
+static int batchIndices[TEXT_BATCH_GLYPHS * 6];
+
+
+void textSetFontData(const void* data, size_t size) {
+    fontData = data;
+    fontDataSize = size;
+}
+
+void textInit(const char* path) {
+    SDL_strlcpy(fontPath, path, sizeof(fontPath));
+
+    // Le motif d'indices des quads ne change jamais
+    for (int i = 0; i < TEXT_BATCH_GLYPHS; i++) {
+        batchIndices[i * 6 + 0] = i * 4 + 0;
+        batchIndices[i * 6 + 1] = i * 4 + 1;
+        batchIndices[i * 6 + 2] = i * 4 + 2;
+        batchIndices[i * 6 + 3] = i * 4 + 2;
+        batchIndices[i * 6 + 4] = i * 4 + 3;
+        batchIndices[i * 6 + 5] = i * 4 + 0;
+    }
+}
+
+void textShutdown(void) {
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        if (cache[i].texture) SDL_DestroyTexture(cache[i].texture);
+    }
+    memset(cache, 0, sizeof(cache));
+
+    for (int i = 0; i < atlasCount; i++) {
+        if (atlases[i].texture) SDL_DestroyTexture(atlases[i].texture);
+        if (atlases[i].font) TTF_CloseFont(atlases[i].font);
+    }
+    memset(atlases, 0, sizeof(atlases));
+    atlasCount = 0;
+}
+
+
+static GlyphAtlas* findAtlas(int size, int style) {
+    for (int i = 0; i < atlasCount; i++) {
+        if (atlases[i].size == size && atlases[i].style == style)
+            return &atlases[i];
+    }
+
+    if (atlasCount >= TEXT_MAX_ATLASES) {
+        SDL_Log("Trop de tailles de police (max %d)", TEXT_MAX_ATLASES);
+        return NULL;
+    }
+
+    // Une ouverture par taille : depuis la mémoire si possible, sans relire le fichier
+    TTF_Font* font = fontData ? TTF_OpenFontRW(SDL_RWFromConstMem(fontData, (int)fontDataSize), 1, size)
+                              : TTF_OpenFont(fontPath, size);
+    if (!font) {
+        SDL_Log("Erreur chargement police %s (%d) : %s", fontPath, size, TTF_GetError());
+        return NULL;
+    }
+    TTF_SetFontStyle(font, style);
+
+    GlyphAtlas* atlas = &atlases[atlasCount++];
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->size = size;
+    atlas->style = style;
+    atlas->font = font;
+    atlas->lineHeight = TTF_FontHeight(font);
+
+    // Métriques disponibles sans renderer (mesure de texte)
+    for (int c = TEXT_FIRST_GLYPH; c <= TEXT_LAST_GLYPH; c++) {
+        Glyph* g = &atlas->glyphs[c - TEXT_FIRST_GLYPH];
+        int advance = 0;
+        if (TTF_GlyphIsProvided(font, (Uint16)c) &&
+            TTF_GlyphMetrics(font, (Uint16)c, NULL, NULL, NULL, NULL, &advance) == 0) {
+            g->advance = advance;
+        }
+    }
+
+    return atlas;
+}
+
+// Rastérise tous les glyphes une seule fois et les range par étagères
+static bool buildAtlasTexture(SDL_Renderer* renderer, GlyphAtlas* atlas) {
+    SDL_Surface* rendered[TEXT_GLYPH_COUNT] = { 0 };
+    SDL_Color white = { 255, 255, 255, 255 };
+
+    int penX = 0, penY = 0, shelfH = 0;
+    for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+        Uint16 c = (Uint16)(TEXT_FIRST_GLYPH + i);
+        if (c == ' ' || atlas->glyphs[i].advance == 0)
+            continue;
+
+        rendered[i] = TTF_RenderGlyph_Blended(atlas->font, c, white);
+        if (!rendered[i])
+            continue;
+
+        int w = rendered[i]->w, h = rendered[i]->h;
+        if (penX + w > TEXT_ATLAS_WIDTH) {
+            penX = 0;
+            penY += shelfH + 1;
+            shelfH = 0;
+        }
+        atlas->glyphs[i].src = (SDL_Rect){ penX, penY, w, h };
+        penX += w + 1;
+        if (h > shelfH) shelfH = h;
+    }
+
+    int atlasH = penY + shelfH;
+    if (atlasH <= 0) atlasH = 1;
+
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, TEXT_ATLAS_WIDTH, atlasH, 32, SDL_PIXELFORMAT_RGBA32);
+    bool ok = sheet != NULL;
+    if (ok) {
+        SDL_FillRect(sheet, NULL, 0);
+        for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+            if (!rendered[i]) continue;
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], NULL, sheet, &atlas->glyphs[i].src);
+        }
+
+        atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        ok = atlas->texture != NULL;
+        if (ok) SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+        SDL_FreeSurface(sheet);
+    }
+
+    for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+        if (rendered[i]) SDL_FreeSurface(rendered[i]);
+    }
+
+    if (!ok) {
+        SDL_Log("Erreur création atlas de glyphes : %s", SDL_GetError());
+    }
+    return ok;
+}
+
+TTF_Font* textFont(int size, int style) {
+    GlyphAtlas* atlas = findAtlas(size, style);
+    return atlas ? atlas->font : NULL;
+}
+
+
+// Décode un caractère UTF-8 ; hors Latin-1 on affiche '?'
+static int nextGlyph(const char** text) {
+    const unsigned char* s = (const unsigned char*)*text;
+    int c;
+
+    if (s[0] < 0x80) {
+        c = s[0];
+        s++;
+    } else if ((s[0] & 0xE0) == 0xC0 && (s[1] & 0xC0) == 0x80) {
+        c = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+        s += 2;
+    } else {
+        c = '?';
+        s++;
+        while ((*s & 0xC0) == 0x80) s++;
+    }
+
+    *text = (const char*)s;
+    if (c < TEXT_FIRST_GLYPH || c > TEXT_LAST_GLYPH) c = '?';
+    return c;
+}
+
+void textMeasure(int size, int style, const char* text, int* w, int* h) {
+    GlyphAtlas* atlas = findAtlas(size, style);
+    int width = 0;
+
+    if (atlas) {
+        while (*text) {
+            width += atlas->glyphs[nextGlyph(&text) - TEXT_FIRST_GLYPH].advance;
+        }
+    }
+
+    if (w) *w = width;
+    if (h) *h = atlas ? atlas->lineHeight : 0;
+}
+
+void textDraw(SDL_Renderer* renderer, int size, int style, const char* text, int x, int y, SDL_Color color) {
+    GlyphAtlas* atlas = findAtlas(size, style);
+    if (!atlas) return;
+    if (!atlas->texture && !buildAtlasTexture(renderer, atlas)) return;
+
+    int texW, texH;
+    SDL_QueryTexture(atlas->texture, NULL, NULL, &texW, &texH);
+    float invW = 1.0f / texW, invH = 1.0f / texH;
+
+    int quads = 0;
+    int penX = x;
+    while (*text) {
+        Glyph* g = &atlas->glyphs[nextGlyph(&text) - TEXT_FIRST_GLYPH];
+
+        if (g->src.w > 0) {
+            SDL_Vertex* v = &batchVertices[quads * 4];
+            float x0 = (float)penX, y0 = (float)y;
+            float x1 = x0 + g->src.w, y1 = y0 + g->src.h;
+            float u0 = g->src.x * invW, v0 = g->src.y * invH;
+            float u1 = (g->src.x + g->src.w) * invW, v1 = (g->src.y + g->src.h) * invH;
+
+            v[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+            v[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+            v[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+            v[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+
+            if (++quads == TEXT_BATCH_GLYPHS) {
+                SDL_RenderGeometry(renderer, atlas->texture, batchVertices, quads * 4, batchIndices, quads * 6);
+                quads = 0;
+            }
+        }
+        penX += g->advance;
+    }
+
+    if (quads > 0) {
+        SDL_RenderGeometry(renderer, atlas->texture, batchVertices, quads * 4, batchIndices, quads * 6);
+    }
+}
+
+
+static Uint32 hashText(const char* text, SDL_Color color, int size, int style) {
+    Uint32 h = 2166136261u; // FNV-1a
+    for (const unsigned char* s = (const unsigned char*)text; *s; s++) {
+        h = (h ^ *s) * 16777619u;
+    }
+    Uint32 extra[3] = { (Uint32)color.r << 24 | color.g << 16 | color.b << 8 | color.a, (Uint32)size, (Uint32)style };
+    for (int i = 0; i < 3; i++) {
+        h = (h ^ extra[i]) * 16777619u;
+    }
+    return h;
+}
+
+SDL_Texture* textCached(SDL_Renderer* renderer, int size, int style, const char* text, SDL_Color color, int* w, int* h) {
+    Uint32 hash = hashText(text, color, size, style);
+    CachedText* slot = NULL;
+
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        CachedText* e = &cache[i];
+        if (e->texture && e->hash == hash && e->size == size && e->style == style &&
+            e->color.r == color.r && e->color.g == color.g && e->color.b == color.b && e->color.a == color.a &&
+            strcmp(e->text, text) == 0) {
+            e->lastUse = ++cacheClock;
+            if (w) *w = e->w;
+            if (h) *h = e->h;
+            return e->texture;
+        }
+
+        // Candidat au remplacement : entrée libre, sinon la moins récente
+        if (!slot || (slot->texture && (!e->texture || e->lastUse < slot->lastUse))) slot = e;
+    }
+
+    if (strlen(text) >= TEXT_CACHE_MAX_LEN) {
+        SDL_Log("Texte trop long pour le cache : %s", text);
+        return NULL;
+    }
+
+    TTF_Font* font = textFont(size, style);
+    if (!font) return NULL;
+
+    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text, color);
+    if (!surface) return NULL;
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    int surfaceW = surface->w, surfaceH = surface->h;
+    SDL_FreeSurface(surface);
+    if (!texture) return NULL;
+
+    if (slot->texture) SDL_DestroyTexture(slot->texture);
+    slot->hash = hash;
+    SDL_strlcpy(slot->text, text, sizeof(slot->text));
+    slot->color = color;
+    slot->size = size;
+    slot->style = style;
+    slot->texture = texture;
+    slot->w = surfaceW;
+    slot->h = surfaceH;
+    slot->lastUse = ++cacheClock;
+
+    if (w) *w = surfaceW;
+    if (h) *h = surfaceH;
+    return texture;
+}
+
+void textDrawCached(SDL_Renderer* renderer, int size, int style, const char* text, int x, int y, SDL_Color color) {
+    int w, h;
+    SDL_Texture* texture = textCached(renderer, size, style, text, color, &w, &h);
+    if (!texture) return;
+
+    SDL_Rect dest = { x, y, w, h };
+    SDL_RenderCopy(renderer, texture, NULL, &dest);
+}
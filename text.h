@@ -0,0 +1,36 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <SDL2/SDL_ttf.h>
+
+// Sous-système texte :
+//  - un atlas de glyphes (Latin-1) construit une seule fois par taille/style,
+//    les chaînes dynamiques sont dessinées en un seul SDL_RenderGeometry ;
+//  - un cache de textures pré-rendues pour les chaînes statiques
+//    (entrées de menu...), indexé par texte, couleur, taille et style.
+// Aucun appel FreeType ni envoi GPU une fois l'atlas et le cache remplis.
+
+#define TEXT_MAX_ATLASES 8
+#define TEXT_CACHE_SIZE 64
+#define TEXT_CACHE_MAX_LEN 64
+
+void textInit(const char* fontPath);
+// Contenu du fichier de police déjà chargé (asset.h), gardé valide jusqu'à textShutdown ;
+// NULL : lecture de fontPath
+void textSetFontData(const void* data, size_t size);
+void textShutdown(void);
+
+// Police brute pour une taille/style donnés (ouverte une seule fois)
+TTF_Font* textFont(int size, int style);
+
+// Chaînes dynamiques : quads batchés depuis l'atlas
+void textDraw(SDL_Renderer* renderer, int size, int style, const char* text, int x, int y, SDL_Color color);
+void textMeasure(int size, int style, const char* text, int* w, int* h);
+
+// Chaînes statiques : texture pré-construite, créée au premier usage
+SDL_Texture* textCached(SDL_Renderer* renderer, int size, int style, const char* text, SDL_Color color, int* w, int* h);
+void textDrawCached(SDL_Renderer* renderer, int size, int style, const char* text, int x, int y, SDL_Color color);
+
+#endif
@@ -0,0 +1,197 @@
+#include "tilemap.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Tronçons partagés : tout sol, tout mur
+static Chunk sharedGround;
+static Chunk sharedWall;
+static bool sharedReady = false;
+
+static void initShared(void) {
+    if (sharedReady) return;
+    memset(sharedGround.tiles, TILE_GROUND, sizeof(sharedGround.tiles));
+    memset(sharedWall.tiles, TILE_WALL, sizeof(sharedWall.tiles));
+    sharedReady = true;
+}
+
+static bool isShared(const Chunk* chunk) {
+    return chunk == &sharedGround || chunk == &sharedWall;
+}
+
+// Valeur commune de la partie w × h d'un tronçon, -1 s'il n'est pas uniforme
+static int uniformValue(const Chunk* chunk, int w, int h) {
+    uint8_t first = chunk->tiles[0][0];
+    if (first != TILE_GROUND && first != TILE_WALL) return -1;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            if (chunk->tiles[y][x] != first) return -1;
+        }
+    }
+    return first;
+}
+
+// Un tronçon propre et uniforme (sur sa partie w × h dans la grille) est
+// remplacé par le tronçon partagé
+static Chunk* shareIfUniform(Chunk* chunk, int w, int h) {
+    int value = uniformValue(chunk, w, h);
+    if (value < 0) return chunk;
+
+    free(chunk);
+    return value == TILE_WALL ? &sharedWall : &sharedGround;
+}
+
+bool tileMapInit(TileMap* map, int width, int height) {
+    initShared();
+    tileMapFree(map);
+
+    if (width <= 0 || height <= 0 || width > MAX_MAP_SIDE || height > MAX_MAP_SIDE)
+        return false;
+
+    int chunksX = (width + CHUNK_MASK) >> CHUNK_SHIFT;
+    int chunksY = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+    Chunk** chunks = malloc((size_t)chunksX * chunksY * sizeof(Chunk*));
+    if (!chunks) return false;
+
+    for (int i = 0; i < chunksX * chunksY; i++) {
+        chunks[i] = &sharedGround;
+    }
+
+    *map = (TileMap){ width, height, chunksX, chunksY, chunks };
+    return true;
+}
+
+void tileMapFree(TileMap* map) {
+    if (map->chunks) {
+        for (int i = 0; i < map->chunksX * map->chunksY; i++) {
+            if (!isShared(map->chunks[i])) free(map->chunks[i]);
+        }
+        free(map->chunks);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+bool tileMapCopy(TileMap* dst, const TileMap* src) {
+    if (dst == src) return true;
+
+    int count = src->chunksX * src->chunksY;
+    if (dst->chunksX * dst->chunksY != count || !dst->chunks) {
+        if (!tileMapInit(dst, src->width, src->height)) return false;
+    }
+    dst->width = src->width;
+    dst->height = src->height;
+    dst->chunksX = src->chunksX;
+    dst->chunksY = src->chunksY;
+
+    for (int i = 0; i < count; i++) {
+        Chunk* from = src->chunks[i];
+        Chunk* to = dst->chunks[i];
+
+        if (isShared(from)) {
+            if (!isShared(to)) free(to);
+            dst->chunks[i] = from;
+            continue;
+        }
+
+        if (isShared(to)) {
+            to = malloc(sizeof(Chunk));
+            if (!to) {
+                tileMapFree(dst);
+                return false;
+            }
+            dst->chunks[i] = to;
+        }
+        memcpy(to, from, sizeof(Chunk));
+    }
+    return true;
+}
+
+bool tileMapLoadRows(TileMap* map, const uint8_t* rows, int width, int height) {
+    if (!tileMapInit(map, width, height)) return false;
+
+    for (int cy = 0; cy < map->chunksY; cy++) {
+        for (int cx = 0; cx < map->chunksX; cx++) {
+            Chunk* chunk = malloc(sizeof(Chunk));
+            if (!chunk) {
+                tileMapFree(map);
+                return false;
+            }
+
+            // Les bords qui dépassent de la grille ne sont jamais lus
+            memset(chunk->tiles, TILE_WALL, sizeof(chunk->tiles));
+            int x0 = cx << CHUNK_SHIFT, y0 = cy << CHUNK_SHIFT;
+            int w = width - x0 < CHUNK_SIZE ? width - x0 : CHUNK_SIZE;
+            int h = height - y0 < CHUNK_SIZE ? height - y0 : CHUNK_SIZE;
+            for (int y = 0; y < h; y++) {
+                memcpy(chunk->tiles[y], rows + (size_t)(y0 + y) * width + x0, w);
+            }
+
+            map->chunks[cy * map->chunksX + cx] = shareIfUniform(chunk, w, h);
+        }
+    }
+    return true;
+}
+
+void tileMapReadRow(const TileMap* map, int y, uint8_t* out) {
+    Chunk* const* row = &map->chunks[(y >> CHUNK_SHIFT) * map->chunksX];
+    for (int cx = 0; cx < map->chunksX; cx++) {
+        int x0 = cx << CHUNK_SHIFT;
+        int w = map->width - x0 < CHUNK_SIZE ? map->width - x0 : CHUNK_SIZE;
+        memcpy(out + x0, row[cx]->tiles[y & CHUNK_MASK], w);
+    }
+}
+
+size_t tileMapBytes(const TileMap* map) {
+    size_t bytes = (size_t)map->chunksX * map->chunksY * sizeof(Chunk*);
+    for (int i = 0; i < map->chunksX * map->chunksY; i++) {
+        if (!isShared(map->chunks[i])) bytes += sizeof(Chunk);
+    }
+    return bytes;
+}
+
+void tileMapSet(TileMap* map, int x, int y, uint8_t value) {
+    if ((unsigned)x >= (unsigned)map->width || (unsigned)y >= (unsigned)map->height)
+        return;
+
+    Chunk** slot = &map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+    if ((*slot)->tiles[y & CHUNK_MASK][x & CHUNK_MASK] == value)
+        return;
+
+    // Copie à l'écriture d'un tronçon partagé
+    if (isShared(*slot)) {
+        Chunk* chunk = malloc(sizeof(Chunk));
+        if (!chunk) return;
+        memcpy(chunk, *slot, sizeof(Chunk));
+        *slot = chunk;
+    }
+    (*slot)->tiles[y & CHUNK_MASK][x & CHUNK_MASK] = value;
+}
+
+bool tileMapSetChunk(TileMap* map, int index, const Chunk* chunk) {
+    Chunk** slot = &map->chunks[index];
+    if (isShared(*slot)) {
+        if (memcmp(*slot, chunk, sizeof(Chunk)) == 0) return true;
+        Chunk* copy = malloc(sizeof(Chunk));
+        if (!copy) return false;
+        *slot = copy;
+    }
+    memcpy(*slot, chunk, sizeof(Chunk));
+    return true;
+}
+
+void tileMapShareChunk(TileMap* map, int index, uint8_t value) {
+    Chunk** slot = &map->chunks[index];
+    if (!isShared(*slot)) free(*slot);
+    *slot = value == TILE_WALL ? &sharedWall : &sharedGround;
+}
+
+int tileMapUniformChunk(const TileMap* map, int index) {
+    const Chunk* chunk = map->chunks[index];
+    if (chunk == &sharedGround) return TILE_GROUND;
+    if (chunk == &sharedWall) return TILE_WALL;
+
+    int x0 = (index % map->chunksX) << CHUNK_SHIFT, y0 = (index / map->chunksX) << CHUNK_SHIFT;
+    int w = map->width - x0 < CHUNK_SIZE ? map->width - x0 : CHUNK_SIZE;
+    int h = map->height - y0 < CHUNK_SIZE ? map->height - y0 : CHUNK_SIZE;
+    return uniformValue(chunk, w, h);
+}
@@ -0,0 +1,63 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Grille de tuiles de taille quelconque, découpée en tronçons de
+// CHUNK_SIZE × CHUNK_SIZE. Les tronçons uniformes (tout sol, tout mur),
+// majoritaires dans les grandes salles extérieures, pointent vers un
+// tronçon partagé en lecture seule : ils ne coûtent qu'un pointeur.
+// Ils ne sont dupliqués qu'à la première modification (setTile).
+
+#define CHUNK_SHIFT 5
+#define CHUNK_SIZE (1 << CHUNK_SHIFT)      // 32 tuiles
+#define CHUNK_MASK (CHUNK_SIZE - 1)
+#define MAX_MAP_SIDE 16384                 // en tuiles
+
+#define TILE_GROUND 0
+#define TILE_WALL 1
+
+typedef struct {
+    uint8_t tiles[CHUNK_SIZE][CHUNK_SIZE];
+} Chunk;
+
+typedef struct {
+    int width, height;          // en tuiles
+    int chunksX, chunksY;
+    Chunk** chunks;             // chunksX * chunksY, ligne par ligne
+} TileMap;
+
+// Grille entièrement au sol ; false si la taille est invalide ou la mémoire manque
+bool tileMapInit(TileMap* map, int width, int height);
+void tileMapFree(TileMap* map);
+// Copie profonde : les tronçons propres de dst sont réutilisés si possible
+bool tileMapCopy(TileMap* dst, const TileMap* src);
+// Remplit depuis un tableau ligne par ligne (width * height octets)
+bool tileMapLoadRows(TileMap* map, const uint8_t* rows, int width, int height);
+// Recopie la ligne y (width octets)
+void tileMapReadRow(const TileMap* map, int y, uint8_t* out);
+
+// Octets alloués en propre (hors tronçons partagés)
+size_t tileMapBytes(const TileMap* map);
+
+void tileMapSet(TileMap* map, int x, int y, uint8_t value);
+// Remplace tout le tronçon index (ligne par ligne) ; false si la mémoire manque
+bool tileMapSetChunk(TileMap* map, int index, const Chunk* chunk);
+// Fait pointer le tronçon index vers le tronçon partagé de valeur value
+void tileMapShareChunk(TileMap* map, int index, uint8_t value);
+// TILE_GROUND ou TILE_WALL si la partie du tronçon dans la grille est
+// uniforme, -1 sinon
+int tileMapUniformChunk(const TileMap* map, int index);
+
+// Hors de la grille : mur
+static inline uint8_t tileMapGet(const TileMap* map, int x, int y) {
+    if ((unsigned)x >= (unsigned)map->width || (unsigned)y >= (unsigned)map->height)
+        return TILE_WALL;
+
+    const Chunk* chunk = map->chunks[(y >> CHUNK_SHIFT) * map->chunksX + (x >> CHUNK_SHIFT)];
+    return chunk->tiles[y & CHUNK_MASK][x & CHUNK_MASK];
+}
+
+#endif
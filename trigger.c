@@ -0,0 +1,154 @@
+#include "trigger.h"
+#include "flow.h"
+#include "fov.h"
+#include "occupancy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Link links[MAX_LINKS];
+int linkCount = 0;
+
+
+static bool linkSatisfied(const Link* link) {
+    if (link->switchCount == 0) return false;
+
+    for (int i = 0; i < link->switchCount; i++) {
+        bool triggered = switches.flags[link->switches[i]] & ENTITY_TRIGGERED;
+        if (link->op == LINK_OR && triggered) return true;
+        if (link->op == LINK_AND && !triggered) return false;
+    }
+    return link->op == LINK_AND;
+}
+
+static void evaluateLink(int index) {
+    Link* link = &links[index];
+    bool satisfied = linkSatisfied(link);
+    if (satisfied == link->satisfied) return;
+
+    link->satisfied = satisfied;
+    if (!satisfied) return;
+
+    for (int i = 0; i < link->doorCount; i++) {
+        int d = link->doors[i];
+        if (!(doors.flags[d] & ENTITY_OPEN)) {
+            doors.flags[d] |= ENTITY_OPEN;
+            flowDoorOpened(doors.x[d], doors.y[d]);
+            fovInvalidate();
+            stateRevision++;
+            LOG_INFO(LOG_GAME, "Porte %d ouverte par le mécanisme %d", d, index);
+        }
+    }
+}
+
+static void evaluateLinks(uint16_t mask) {
+    while (mask) {
+        int index = __builtin_ctz(mask);
+        mask &= mask - 1;
+        evaluateLink(index);
+    }
+}
+
+static void setOccupants(int index, int occupants) {
+    switches.occupants[index] = (uint16_t)occupants;
+
+    bool triggered = occupants > 0;
+    if (triggered == ((switches.flags[index] & ENTITY_TRIGGERED) != 0)) return;
+
+    switches.flags[index] ^= ENTITY_TRIGGERED;
+    stateRevision++;
+    evaluateLinks(switches.links[index]);
+}
+
+void triggerRebuild(void) {
+    for (int i = 0; i < switches.count; i++) {
+        switches.links[i] = 0;
+    }
+    for (int l = 0; l < linkCount; l++) {
+        for (int i = 0; i < links[l].switchCount; i++) {
+            switches.links[links[l].switches[i]] |= (uint16_t)(1u << l);
+        }
+    }
+
+    int hits[OCCUPANCY_MAX_HITS];
+    for (int i = 0; i < switches.count; i++) {
+        int occupants = occupancyQuery(OCC_BOX, switches.x[i], switches.y[i], hits);
+        switches.occupants[i] = (uint16_t)occupants;
+        if (occupants > 0) switches.flags[i] |= ENTITY_TRIGGERED;
+        else switches.flags[i] &= ~ENTITY_TRIGGERED;
+    }
+
+    // Une salle peut commencer avec des caisses déjà en place. L'état des
+    // mécanismes d'une salle restaurée (cache, sauvegarde) est gardé : seul
+    // un mécanisme qui vient d'être satisfait ouvre ses portes
+    for (int l = 0; l < linkCount; l++) {
+        evaluateLink(l);
+    }
+}
+
+void triggerBoxMoved(int oldX, int oldY, int newX, int newY) {
+    int before[OCCUPANCY_MAX_HITS], after[OCCUPANCY_MAX_HITS];
+    int beforeCount = occupancyQuery(OCC_SWITCH, oldX, oldY, before);
+    int afterCount = occupancyQuery(OCC_SWITCH, newX, newY, after);
+
+    // Sortie : interrupteurs recouverts avant et plus après
+    for (int i = 0; i < beforeCount; i++) {
+        bool stays = false;
+        for (int j = 0; j < afterCount; j++) stays |= after[j] == before[i];
+        if (!stays) setOccupants(before[i], switches.occupants[before[i]] - 1);
+    }
+
+    // Entrée
+    for (int j = 0; j < afterCount; j++) {
+        bool stayed = false;
+        for (int i = 0; i < beforeCount; i++) stayed |= before[i] == after[j];
+        if (!stayed) setOccupants(after[j], switches.occupants[after[j]] + 1);
+    }
+}
+
+
+// Liste d'indices "a b c" ; chaque indice doit être < limit
+static int parseIndices(char** cursor, const char* stop, uint8_t* out, int capacity, int limit) {
+    int count = 0;
+    char* token;
+
+    while ((token = strtok_r(NULL, " \t\r\n", cursor)) != NULL) {
+        if (stop && strcmp(token, stop) == 0) return count;
+
+        char* end;
+        long value = strtol(token, &end, 10);
+        if (*end != '\0' || value < 0 || value >= limit || count >= capacity) return -1;
+        out[count++] = (uint8_t)value;
+    }
+    return stop ? -1 : count;
+}
+
+bool triggerParseLink(const char* line, Room* room) {
+    if (room->linkCount >= MAX_LINKS) return false;
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", line);
+
+    char* cursor;
+    char* keyword = strtok_r(buffer, " \t\r\n", &cursor);
+    char* op = strtok_r(NULL, " \t\r\n", &cursor);
+    if (!keyword || strcmp(keyword, "@link") != 0 || !op) return false;
+
+    Link link;
+    memset(&link, 0, sizeof(link));
+    if (strcmp(op, "or") == 0) link.op = LINK_OR;
+    else if (strcmp(op, "and") == 0) link.op = LINK_AND;
+    else return false;
+
+    // Indices sur un octet : seules les 256 premières entités sont reliables
+    int switchLimit = room->switches.count < 256 ? room->switches.count : 256;
+    int doorLimit = room->doors.count < 256 ? room->doors.count : 256;
+    int inputs = parseIndices(&cursor, ">", link.switches, MAX_LINK_INPUTS, switchLimit);
+    int outputs = parseIndices(&cursor, NULL, link.doors, MAX_LINK_OUTPUTS, doorLimit);
+    if (inputs <= 0 || outputs <= 0) return false;
+
+    link.switchCount = (uint8_t)inputs;
+    link.doorCount = (uint8_t)outputs;
+    room->links[room->linkCount++] = link;
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdbool.h>
+#include "game.h"
+
+// Interrupteurs et mécanismes pilotés par événements : une caisse qui entre
+// sur un interrupteur ou le quitte met à jour son compteur, et seuls les
+// mécanismes qui en dépendent (masque Switch.links) sont réévalués.
+//
+// Les mécanismes viennent des métadonnées de la salle, après la grille :
+//
+//   @link or 0 > 0          l'interrupteur 0 ouvre la porte 0
+//   @link and 1 2 > 1 3     les interrupteurs 1 et 2 ensemble ouvrent les portes 1 et 3
+
+// Recalcule compteurs, masques et mécanismes (changement de salle)
+void triggerRebuild(void);
+// Une caisse s'est déplacée de (oldX, oldY) à (newX, newY)
+void triggerBoxMoved(int oldX, int oldY, int newX, int newY);
+
+// Lit une ligne "@link ..." ; false si elle est mal formée
+bool triggerParseLink(const char* line, Room* room);
+
+#endif
@@ -0,0 +1,186 @@
+#include "world.h"
+#include "game.h"
+#include "roomfile.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef struct {
+    WorldRoom room;
+    uint32_t nameOffset;              // room.filename est fixé en fin de chargement
+    bool used;
+} WorldSlot;
+
+static WorldSlot* slots = NULL;
+static uint32_t slotCapacity = 0;     // puissance de 2
+static int roomCount = 0;
+
+static char* names = NULL;            // chemins, bout à bout
+static size_t namesSize = 0, namesCapacity = 0;
+
+static int startX = 0, startY = 0;
+static bool startSet = false;
+
+
+static uint32_t hashCoords(int x, int y) {
+    uint64_t h = ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+static WorldSlot* probe(WorldSlot* table, uint32_t capacity, int x, int y) {
+    uint32_t i = hashCoords(x, y) & (capacity - 1);
+    while (table[i].used && (table[i].room.x != x || table[i].room.y != y)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &table[i];
+}
+
+// Taux de remplissage maximal 1/2 : les sondages restent courts
+static bool reserve(int count) {
+    if ((uint32_t)count * 2 <= slotCapacity) return true;
+
+    uint32_t capacity = slotCapacity ? slotCapacity * 2 : 64;
+    while ((uint32_t)count * 2 > capacity) capacity *= 2;
+
+    WorldSlot* table = calloc(capacity, sizeof(WorldSlot));
+    if (!table) return false;
+
+    for (uint32_t i = 0; i < slotCapacity; i++) {
+        if (slots[i].used) *probe(table, capacity, slots[i].room.x, slots[i].room.y) = slots[i];
+    }
+    free(slots);
+    slots = table;
+    slotCapacity = capacity;
+    return true;
+}
+
+static bool addName(const char* path, uint32_t* offset) {
+    size_t length = strlen(path) + 1;
+    if (namesSize + length > namesCapacity) {
+        size_t capacity = namesCapacity ? namesCapacity * 2 : 4096;
+        while (namesSize + length > capacity) capacity *= 2;
+        char* grown = realloc(names, capacity);
+        if (!grown) return false;
+        names = grown;
+        namesCapacity = capacity;
+    }
+
+    memcpy(names + namesSize, path, length);
+    *offset = (uint32_t)namesSize;
+    namesSize += length;
+    return true;
+}
+
+// Le fichier texte ou sa version compilée doit exister
+static bool roomFileExists(const char* path) {
+    struct stat info;
+    if (stat(path, &info) == 0) return true;
+
+    char binaryPath[256];
+    return roomBinaryPath(path, binaryPath, sizeof(binaryPath)) && stat(binaryPath, &info) == 0;
+}
+
+void worldClear(void) {
+    free(slots);
+    free(names);
+    slots = NULL;
+    names = NULL;
+    slotCapacity = 0;
+    namesSize = namesCapacity = 0;
+    roomCount = 0;
+    startSet = false;
+}
+
+bool worldLoad(const char* manifestPath) {
+    worldClear();
+
+    FILE* file = fopen(manifestPath, "r");
+    if (!file) {
+        LOG_ERROR(LOG_WORLD, "Impossible d'ouvrir le manifeste %s", manifestPath);
+        return false;
+    }
+
+    // Les chemins des salles sont relatifs au dossier du manifeste
+    const char* slash = strrchr(manifestPath, '/');
+    int dirLength = slash ? (int)(slash - manifestPath + 1) : 0;
+
+    char line[512];
+    int missing = 0;
+    for (int lineNumber = 1; fgets(line, sizeof(line), file); lineNumber++) {
+        char name[256];
+        int x, y;
+
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+
+        if (sscanf(line, "start %d %d", &x, &y) == 2) {
+            startX = x;
+            startY = y;
+            startSet = true;
+            continue;
+        }
+
+        if (sscanf(line, "%d %d %255s", &x, &y, name) != 3) {
+            LOG_WARN(LOG_WORLD, "%s:%d : ligne invalide", manifestPath, lineNumber);
+            continue;
+        }
+
+        char path[512];
+        snprintf(path, sizeof(path), "%.*s%s", dirLength, manifestPath, name);
+        if (!roomFileExists(path)) {
+            LOG_WARN(LOG_WORLD, "%s:%d : salle (%d, %d) introuvable : %s", manifestPath, lineNumber, x, y, path);
+            missing++;
+            continue;
+        }
+
+        if (!reserve(roomCount + 1)) break;
+
+        WorldSlot* slot = probe(slots, slotCapacity, x, y);
+        if (slot->used) {
+            LOG_WARN(LOG_WORLD, "%s:%d : salle (%d, %d) déjà définie", manifestPath, lineNumber, x, y);
+            continue;
+        }
+        if (!addName(path, &slot->nameOffset)) break;
+
+        slot->room.x = x;
+        slot->room.y = y;
+        slot->used = true;
+        if (roomCount++ == 0 && !startSet) {
+            startX = x;
+            startY = y;
+        }
+    }
+    fclose(file);
+
+    // Le tableau des chemins ne bouge plus
+    for (uint32_t i = 0; i < slotCapacity; i++) {
+        if (slots[i].used) slots[i].room.filename = names + slots[i].nameOffset;
+    }
+
+    LOG_INFO(LOG_WORLD, "Monde : %d salles, %d introuvables", roomCount, missing);
+    if (startSet && !worldFind(startX, startY)) {
+        LOG_ERROR(LOG_WORLD, "Salle de départ (%d, %d) absente du monde", startX, startY);
+        return false;
+    }
+    return roomCount > 0;
+}
+
+const WorldRoom* worldFind(int x, int y) {
+    if (roomCount == 0) return NULL;
+
+    const WorldSlot* slot = probe(slots, slotCapacity, x, y);
+    return slot->used ? &slot->room : NULL;
+}
+
+int worldRoomCount(void) {
+    return roomCount;
+}
+
+void worldStart(int* x, int* y) {
+    *x = startX;
+    *y = startY;
+}
@@ -0,0 +1,37 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <stdbool.h>
+
+// Graphe du monde : les salles présentes, indexées par coordonnées dans une
+// table de hachage (adressage ouvert). La mémoire suit le nombre de salles,
+// pas la taille du rectangle qui les contient.
+//
+// Le manifeste liste une salle par ligne, chemins relatifs au manifeste :
+//
+//   # x y fichier
+//   start 1 1
+//   1 1 map_1_1.txt
+//   2 1 map_1_2.txt
+//
+// Les salles dont le fichier est introuvable sont signalées au chargement
+// et écartées : aucune transition ne peut mener vers elles.
+
+#define WORLD_MANIFEST "world/world.manifest"
+
+typedef struct {
+    int x, y;
+    const char* filename;
+} WorldRoom;
+
+// Remplace le monde courant ; false si le manifeste est illisible ou vide
+bool worldLoad(const char* manifestPath);
+void worldClear(void);
+
+// Salle en (x, y), ou NULL
+const WorldRoom* worldFind(int x, int y);
+int worldRoomCount(void);
+// Salle de départ déclarée par "start" (sinon la première listée)
+void worldStart(int* x, int* y);
+
+#endif